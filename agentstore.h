@@ -0,0 +1,775 @@
+#pragma once
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include "product.h"
+#include "cow.h"
+
+// demand curve: p = c - mQ
+struct demandLine
+{
+    double m;
+    double c;
+};
+
+// supply curve: p = c + mQ
+struct supplyLine
+{
+    double m;
+    double c;
+};
+
+// Aggregate slope below which a curve counts as empty. A horizontal sum of N
+// lines has slope 1/sum(1/m), which shrinks like 1/N, so the cut-off sits far
+// below any real population's slope (5M agents at m = 2 give 4e-7).
+constexpr double EMPTY_CURVE_SLOPE = 1e-12;
+
+// Copyable relaxed atomic flag for the block caches below: concurrent agent
+// updates may mark the same block, aggregation runs after they are joined
+struct dirtyFlag
+{
+    std::atomic<bool> v{true};
+    dirtyFlag() = default;
+    dirtyFlag(const dirtyFlag &o) : v(o.v.load(std::memory_order_relaxed)) {}
+    dirtyFlag &operator=(const dirtyFlag &o)
+    {
+        v.store(o.v.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        return *this;
+    }
+    bool test() const { return v.load(std::memory_order_relaxed); }
+    void mark() { v.store(true, std::memory_order_relaxed); }
+    void clear() { v.store(false, std::memory_order_relaxed); }
+};
+
+// Product-id-indexed columns of linear curves, one row per agent.
+//
+// Market clearing needs sum(1/m) and sum(c/m) per product. Rows are grouped in
+// blocks of BLOCK_ROWS; each block caches its partial sums and every write that
+// changes a curve marks its block dirty. aggregate() recomputes only dirty
+// blocks, so clearing cost follows the number of changed curves rather than the
+// population. Partials are recomputed from the rows (never patched with +/-
+// deltas) and combined in block order, so sums do not drift and do not depend
+// on which thread wrote which row.
+//
+// Columns are copy-on-write: copying a table (world::fork) shares every column
+// until one side writes to it.
+template <class Line>
+class lineTable
+{
+public:
+    static constexpr int BLOCK_ROWS = 256;
+
+    // ── COLUMNS (one per product id) ──────────────────────────────────────
+    // Column index == product id from the productRegistry.
+    int addColumn(const product *prod)
+    {
+        if (!prod || prod->id < 0)
+            return -1;
+        while ((int)slope.size() <= prod->id)
+        {
+            slope.emplace_back(rowCount, 0.0);
+            intercept.emplace_back(rowCount, 0.0);
+            blockInvM.emplace_back(blocks(), 0.0);
+            blockCByM.emplace_back(blocks(), 0.0);
+            blockDirty.emplace_back(blocks());
+            columnDirty.emplace_back();
+            totalInvM.push_back(0.0);
+            totalCByM.push_back(0.0);
+        }
+        return prod->id;
+    }
+
+    // Column for a product (or any copy of it), -1 if not registered
+    int column(const product *prod) const
+    {
+        return (prod && prod->id >= 0 && prod->id < columns()) ? prod->id : -1;
+    }
+
+    int columns() const { return (int)slope.size(); }
+
+    // ── ROWS (one per agent) ──────────────────────────────────────────────
+    int addRow()
+    {
+        if (!freeRows.empty())
+        {
+            int row = freeRows.back();
+            freeRows.pop_back();
+            return row;
+        }
+        int row = rowCount++;
+        for (size_t col = 0; col < slope.size(); col++)
+        {
+            slope[col].write().push_back(0.0);
+            intercept[col].write().push_back(0.0);
+            if ((int)blockDirty[col].size() < blocks())
+            {
+                blockInvM[col].push_back(0.0);
+                blockCByM[col].push_back(0.0);
+                blockDirty[col].emplace_back();
+            }
+        }
+        return row;
+    }
+
+    // n new zero rows at the end in one resize per column (free rows are not
+    // reused); returns the first
+    int addRows(int n)
+    {
+        int first = rowCount;
+        rowCount += n;
+        for (size_t col = 0; col < slope.size(); col++)
+        {
+            slope[col].write().resize(rowCount, 0.0);
+            intercept[col].write().resize(rowCount, 0.0);
+            blockInvM[col].resize(blocks(), 0.0);
+            blockCByM[col].resize(blocks(), 0.0);
+            blockDirty[col].resize(blocks());
+        }
+        return first;
+    }
+
+    // Zero a row so it no longer contributes to any market
+    void clearRow(int row)
+    {
+        for (int col = 0; col < columns(); col++)
+            set(col, row, {0.0, 0.0});
+    }
+
+    void releaseRow(int row)
+    {
+        clearRow(row);
+        freeRows.push_back(row);
+    }
+
+    int rows() const { return rowCount; }
+
+    // ── CELL ACCESS ───────────────────────────────────────────────────────
+    bool has(int col, int row) const
+    {
+        return col >= 0 && col < columns() && row >= 0 && slope[col][row] > 0.0;
+    }
+
+    Line line(int col, int row) const { return {slope[col][row], intercept[col][row]}; }
+
+    void set(int col, int row, Line l)
+    {
+        if (slope[col][row] == l.m && intercept[col][row] == l.c)
+            return;
+        slope[col].mut(row) = l.m;
+        intercept[col].mut(row) = l.c;
+        markDirty(col, row);
+    }
+
+    void setIntercept(int col, int row, double c)
+    {
+        if (intercept[col][row] == c)
+            return;
+        intercept[col].mut(row) = c;
+        markDirty(col, row);
+    }
+
+    // ── AGGREGATION ───────────────────────────────────────────────────────
+    // Horizontal sum of every row's curve for one product:
+    // sum(1/m) and sum(c/m), skipping flat (m ~ 0) rows
+    void aggregate(int col, double &invM, double &cByM) const
+    {
+        invM = 0.0;
+        cByM = 0.0;
+        if (col < 0 || col >= columns())
+            return;
+
+        if (columnDirty[col].test())
+        {
+            int nb = (int)blockDirty[col].size();
+            double sumInvM = 0.0, sumCByM = 0.0;
+            for (int b = 0; b < nb; b++)
+            {
+                if (blockDirty[col][b].test())
+                    refreshBlock(col, b);
+                sumInvM += blockInvM[col][b];
+                sumCByM += blockCByM[col][b];
+            }
+            totalInvM[col] = sumInvM;
+            totalCByM[col] = sumCByM;
+            columnDirty[col].clear();
+        }
+        invM = totalInvM[col];
+        cByM = totalCByM[col];
+    }
+
+    // Give every column a private buffer before writing from several threads
+    void detach()
+    {
+        for (int col = 0; col < columns(); col++)
+        {
+            slope[col].detach();
+            intercept[col].detach();
+        }
+    }
+
+    // Columns still sharing a buffer with another copy of this table
+    int sharedColumns() const
+    {
+        int n = 0;
+        for (int col = 0; col < columns(); col++)
+            n += slope[col].shared() + intercept[col].shared();
+        return n;
+    }
+
+    // ── RAW ACCESS (snapshots) ────────────────────────────────────────────
+    const double *slopeData(int col) const { return slope[col].read().data(); }
+    const double *interceptData(int col) const { return intercept[col].read().data(); }
+    const std::vector<int> &freeList() const { return freeRows; }
+
+    // Replace the whole table from column-major arrays of cols * rows values.
+    // Every block starts dirty, so the next aggregate() recomputes from rows.
+    void restore(int cols, int rows, const double *m, const double *c,
+                 const int *free, size_t freeCount)
+    {
+        rowCount = rows;
+        slope.assign(cols, {});
+        intercept.assign(cols, {});
+        for (int col = 0; col < cols; col++)
+        {
+            slope[col].write().assign(m + (size_t)col * rows, m + (size_t)(col + 1) * rows);
+            intercept[col].write().assign(c + (size_t)col * rows, c + (size_t)(col + 1) * rows);
+        }
+        blockInvM.assign(cols, std::vector<double>(blocks(), 0.0));
+        blockCByM.assign(cols, std::vector<double>(blocks(), 0.0));
+        blockDirty.assign(cols, std::vector<dirtyFlag>(blocks()));
+        columnDirty.assign(cols, dirtyFlag());
+        for (auto &f : blockDirty)
+            for (auto &b : f)
+                b.mark();
+        for (auto &f : columnDirty)
+            f.mark();
+        totalInvM.assign(cols, 0.0);
+        totalCByM.assign(cols, 0.0);
+        freeRows.assign(free, free + freeCount);
+    }
+
+private:
+    int blocks() const { return (rowCount + BLOCK_ROWS - 1) / BLOCK_ROWS; }
+
+    void markDirty(int col, int row)
+    {
+        blockDirty[col][row / BLOCK_ROWS].mark();
+        columnDirty[col].mark();
+    }
+
+    void refreshBlock(int col, int b) const
+    {
+        const double *m = slope[col].read().data();
+        const double *c = intercept[col].read().data();
+        int begin = b * BLOCK_ROWS;
+        int end = std::min(rowCount, begin + BLOCK_ROWS);
+        double invM = 0.0, cByM = 0.0;
+        for (int i = begin; i < end; i++)
+        {
+            if (m[i] <= 0.000001)
+                continue;
+            invM += 1.0 / m[i];
+            cByM += c[i] / m[i];
+        }
+        blockInvM[col][b] = invM;
+        blockCByM[col][b] = cByM;
+        blockDirty[col][b].clear();
+    }
+
+    std::vector<cowVector<double>> slope;
+    std::vector<cowVector<double>> intercept;
+
+    // Aggregation cache, refreshed lazily by aggregate()
+    mutable std::vector<std::vector<double>> blockInvM;
+    mutable std::vector<std::vector<double>> blockCByM;
+    mutable std::vector<std::vector<dirtyFlag>> blockDirty;
+    mutable std::vector<dirtyFlag> columnDirty;
+    mutable std::vector<double> totalInvM;
+    mutable std::vector<double> totalCByM;
+
+    std::vector<int> freeRows;
+    int rowCount = 0;
+};
+
+// Farmer supply curves: one row per farmer, one column per crop id
+using supplyStore = lineTable<supplyLine>;
+
+// One agent's demand for one product: a cell of the demand store
+struct demandCell
+{
+    int row;                 // the agent's demand row
+    double m = 0.0, c = 0.0; // p = c - mQ; m == 0: the row does not demand it
+    double consumed = 0.0;   // units held, decaying daily
+    double sub = 0.0;        // substitution ratio against rice
+    double filled = 0.0;     // units bought at today's clearing (order matching)
+
+    bool blank() const { return m == 0.0 && c == 0.0 && consumed == 0.0 && sub == 0.0 && filled == 0.0; }
+};
+
+// One entry of an agent's need list: a product id and where the agent's cell
+// for it sat in the demand column when last found (re-checked on every use,
+// see demandStore::locate)
+struct needRef
+{
+    int id;
+    int at = -1;
+};
+
+// Product-id-indexed sparse demand storage shared by every agent in a world.
+//
+// Each product owns a column holding one packed cell (curve, consumed,
+// substitution ratio, fill) per agent row that demands it, sorted by row, so
+// the column doubles as that market's index of participating agents. An agent
+// that buys three of a few hundred products has three cells, and aggregation
+// or a demand shock walks only a product's participants.
+//
+// Columns are split into blocks of BLOCK_ROWS rows: start[b] is the first
+// cell of block b, and a row's cell is found inside its block (directly when
+// every row of the block participates, else by binary search). As in
+// lineTable, each block caches its partial sums, every curve write marks its
+// block dirty and aggregate() recomputes only dirty blocks. Cells are summed
+// in row order, so the sums match what dense columns gave.
+//
+// Adding a cell moves the later cells of its column, so cells are only added
+// from serial code; parallel passes write cells that exist (reserveColumn()
+// gives every row a placeholder first, prune() drops what stayed blank).
+// With order matching on (world::matchOrders) `filled` holds the units each
+// row bought at today's clearing and agents consume exactly that. Columns are
+// copy-on-write: copying a store (world::fork) shares every column until one
+// side writes to it.
+class demandStore
+{
+public:
+    static constexpr int BLOCK_ROWS = 256;
+
+    // ── COLUMNS (one per product id) ──────────────────────────────────────
+    // Column index == product id from the productRegistry.
+    int addColumn(const product *prod)
+    {
+        if (!prod || prod->id < 0)
+            return -1;
+        while ((int)cells.size() <= prod->id)
+        {
+            cells.emplace_back();
+            start.emplace_back(blocks() + 1, 0);
+            blockInvM.emplace_back(blocks(), 0.0);
+            blockCByM.emplace_back(blocks(), 0.0);
+            blockDirty.emplace_back(blocks());
+            columnDirty.emplace_back();
+            totalInvM.push_back(0.0);
+            totalCByM.push_back(0.0);
+        }
+        return prod->id;
+    }
+
+    // Column for a product (or any copy of it), -1 if not registered
+    int column(const product *prod) const
+    {
+        return (prod && prod->id >= 0 && prod->id < columns()) ? prod->id : -1;
+    }
+
+    int columns() const { return (int)cells.size(); }
+
+    // Participating agents' cells, in row order
+    const std::vector<demandCell> &participants(int col) const { return cells[col].read(); }
+
+    // A cell for every row in one pass (blank until written), so a parallel
+    // pass can then write any row of this column
+    void reserveColumn(int col)
+    {
+        if (col < 0 || col >= columns() || (int)cells[col].size() == rowCount)
+            return;
+        std::vector<demandCell> &have = cells[col].write();
+        std::vector<demandCell> all;
+        all.reserve(rowCount);
+        size_t k = 0;
+        for (int row = 0; row < rowCount; row++)
+            all.push_back(k < have.size() && have[k].row == row ? have[k++] : demandCell{row});
+        have.swap(all);
+        rebuildStarts(col);
+    }
+
+    // Drop every blank cell (placeholders never written, rows cleared
+    // since). Cells move, so positions found before are no longer valid.
+    void prune()
+    {
+        for (int col = 0; col < columns(); col++)
+        {
+            const std::vector<demandCell> &v = cells[col].read();
+            if (std::none_of(v.begin(), v.end(), [](const demandCell &x)
+                             { return x.blank(); }))
+                continue; // leaves a shared column shared
+            std::vector<demandCell> &w = cells[col].write();
+            w.erase(std::remove_if(w.begin(), w.end(), [](const demandCell &x)
+                                   { return x.blank(); }),
+                    w.end());
+            rebuildStarts(col); // blank cells add nothing, so the partials stand
+        }
+    }
+
+    // ── ROWS (one per agent) ──────────────────────────────────────────────
+    int addRow()
+    {
+        if (!freeRows.empty())
+        {
+            int row = freeRows.back();
+            freeRows.pop_back();
+            return row;
+        }
+        return addRows(1);
+    }
+
+    // n new rows at the end (free rows are not reused); returns the first.
+    // New rows have no cells, so only the block tables grow.
+    int addRows(int n)
+    {
+        int first = rowCount;
+        rowCount += n;
+        for (int col = 0; col < columns(); col++)
+        {
+            start[col].resize(blocks() + 1, (int)cells[col].size());
+            blockInvM[col].resize(blocks(), 0.0);
+            blockCByM[col].resize(blocks(), 0.0);
+            blockDirty[col].resize(blocks());
+        }
+        return first;
+    }
+
+    // Blank a row's cells so it no longer contributes to any market
+    void clearRow(int row)
+    {
+        for (int col = 0; col < columns(); col++)
+        {
+            int k = find(col, row);
+            if (k < 0 || cells[col][k].blank())
+                continue;
+            demandCell &x = cells[col].mut(k);
+            if (x.m != 0.0 || x.c != 0.0)
+                markDirty(col, row);
+            x = demandCell{row};
+        }
+    }
+
+    void releaseRow(int row)
+    {
+        clearRow(row);
+        freeRows.push_back(row);
+    }
+
+    int rows() const { return rowCount; }
+
+    // ── CELL ACCESS ───────────────────────────────────────────────────────
+    // Position of a row's cell in its column, -1 if it has none. Valid
+    // until a cell is added to or pruned from the column.
+    int find(int col, int row) const
+    {
+        if (col < 0 || col >= columns() || row < 0 || row >= rowCount)
+            return -1;
+        const std::vector<demandCell> &v = cells[col].read();
+        int b = row / BLOCK_ROWS;
+        int lo = start[col][b], hi = start[col][b + 1];
+        int guess = lo + (row - b * BLOCK_ROWS); // every row of the block present
+        if (guess < hi && v[guess].row == row)
+            return guess;
+        auto it = std::lower_bound(v.begin() + lo, v.begin() + hi, row, [](const demandCell &x, int r)
+                                   { return x.row < r; });
+        return it != v.begin() + hi && it->row == row ? (int)(it - v.begin()) : -1;
+    }
+
+    // find() through an agent's cached position, refreshing it when the cell
+    // has moved (a position holding the same row is always the right cell)
+    int locate(int col, int row, int &at) const
+    {
+        if (col >= 0 && col < columns() && at >= 0 && at < (int)cells[col].size() && cells[col][at].row == row)
+            return at;
+        return at = find(col, row);
+    }
+
+    // Cell k of a column, for its agent's own bookkeeping (consumed, sub).
+    // Curves change only through setLine / setIntercept, which mark blocks.
+    demandCell &cellAt(int col, int k) { return cells[col].mut(k); }
+
+    bool demands(int col, int row) const
+    {
+        int k = find(col, row);
+        return k >= 0 && cells[col][k].m > 0.0;
+    }
+
+    demandLine line(int col, int row) const
+    {
+        int k = find(col, row);
+        return k < 0 ? demandLine{0.0, 0.0} : demandLine{cells[col][k].m, cells[col][k].c};
+    }
+
+    void setLine(int col, int row, demandLine l)
+    {
+        int k = find(col, row);
+        if (k < 0 && l.m == 0.0 && l.c == 0.0)
+            return;
+        if (k < 0)
+            k = insert(col, row);
+        const demandCell &x = cells[col][k];
+        if (x.m == l.m && x.c == l.c)
+            return;
+        demandCell &y = cells[col].mut(k);
+        y.m = l.m;
+        y.c = l.c;
+        markDirty(col, row);
+    }
+
+    void setIntercept(int col, int row, double c)
+    {
+        int k = find(col, row);
+        if (k < 0 && c == 0.0)
+            return;
+        if (k < 0)
+            k = insert(col, row);
+        if (cells[col][k].c == c)
+            return;
+        cells[col].mut(k).c = c;
+        markDirty(col, row);
+    }
+
+    // setIntercept for the cell at position k of a column
+    void setInterceptAt(int col, int k, double c)
+    {
+        if (cells[col][k].c == c)
+            return;
+        demandCell &x = cells[col].mut(k);
+        x.c = c;
+        markDirty(col, x.row);
+    }
+
+    // Writable references add the row's cell if it has none (serial code only)
+    double &consumed(int col, int row) { return cells[col].mut(reach(col, row)).consumed; }
+    double consumed(int col, int row) const
+    {
+        int k = find(col, row);
+        return k < 0 ? 0.0 : cells[col][k].consumed;
+    }
+
+    double &substitution(int col, int row) { return cells[col].mut(reach(col, row)).sub; }
+    double substitution(int col, int row) const
+    {
+        int k = find(col, row);
+        return k < 0 ? 0.0 : cells[col][k].sub;
+    }
+
+    // Rewrite every participant's curve of one column: l = fn(l)
+    template <class Fn>
+    void updateLines(int col, Fn fn)
+    {
+        if (col < 0 || col >= columns())
+            return;
+        std::vector<demandCell> &v = cells[col].write();
+        for (demandCell &x : v)
+        {
+            if (x.m <= 0.0)
+                continue;
+            demandLine l = fn(demandLine{x.m, x.c});
+            if (l.m == x.m && l.c == x.c)
+                continue;
+            x.m = l.m;
+            x.c = l.c;
+            markDirty(col, x.row);
+        }
+    }
+
+    // ── ORDER FILLS ───────────────────────────────────────────────────────
+    bool matching() const { return matched; }
+    void setMatching(bool on) { matched = on; }
+
+    double filled(int col, int row) const
+    {
+        int k = find(col, row);
+        return k < 0 ? 0.0 : cells[col][k].filled;
+    }
+
+    // Fills by cell position in participants(col)
+    void clearFills(int col)
+    {
+        for (demandCell &x : cells[col].write())
+            x.filled = 0.0;
+    }
+    void setFill(int col, int k, double units) { cells[col].mut(k).filled = units; }
+
+    // ── AGGREGATION ───────────────────────────────────────────────────────
+    // Q = sum(c/m) - sum(1/m) * p, skipping flat (m ~ 0) cells
+    void aggregate(int col, double &invM, double &cByM) const
+    {
+        invM = 0.0;
+        cByM = 0.0;
+        if (col < 0 || col >= columns())
+            return;
+
+        if (columnDirty[col].test())
+        {
+            int nb = (int)blockDirty[col].size();
+            double sumInvM = 0.0, sumCByM = 0.0;
+            for (int b = 0; b < nb; b++)
+            {
+                if (blockDirty[col][b].test())
+                    refreshBlock(col, b);
+                sumInvM += blockInvM[col][b];
+                sumCByM += blockCByM[col][b];
+            }
+            totalInvM[col] = sumInvM;
+            totalCByM[col] = sumCByM;
+            columnDirty[col].clear();
+        }
+        invM = totalInvM[col];
+        cByM = totalCByM[col];
+    }
+
+    // Give every column a private buffer before writing from several threads
+    void detach()
+    {
+        for (auto &col : cells)
+            col.detach();
+    }
+
+    // Columns still sharing a buffer with another copy of this store
+    int sharedColumns() const
+    {
+        int n = 0;
+        for (auto &col : cells)
+            n += col.shared();
+        return n;
+    }
+
+    // ── RAW ACCESS (snapshots) ────────────────────────────────────────────
+    const std::vector<int> &freeList() const { return freeRows; }
+
+    // Append every column densely, column-major, 0 where a row has no cell
+    void exportColumns(std::vector<double> &m, std::vector<double> &c,
+                       std::vector<double> &consumed, std::vector<double> &sub) const
+    {
+        for (int col = 0; col < columns(); col++)
+        {
+            size_t base = m.size();
+            m.resize(base + rowCount, 0.0);
+            c.resize(base + rowCount, 0.0);
+            consumed.resize(base + rowCount, 0.0);
+            sub.resize(base + rowCount, 0.0);
+            for (const demandCell &x : cells[col].read())
+            {
+                m[base + x.row] = x.m;
+                c[base + x.row] = x.c;
+                consumed[base + x.row] = x.consumed;
+                sub[base + x.row] = x.sub;
+            }
+        }
+    }
+
+    // Replace the whole store from column-major arrays of cols * rows
+    // values, as exportColumns() writes them; all-zero entries get no cell.
+    // Every block starts dirty, so the next aggregate() recomputes.
+    void restore(int cols, int rows, const double *m, const double *c,
+                 const double *consumed, const double *sub,
+                 const int *free, size_t freeCount)
+    {
+        rowCount = rows;
+        cells.assign(cols, {});
+        start.assign(cols, {});
+        for (int col = 0; col < cols; col++)
+        {
+            std::vector<demandCell> &v = cells[col].write();
+            for (int row = 0; row < rows; row++)
+            {
+                size_t i = (size_t)col * rows + row;
+                demandCell x{row, m[i], c[i], consumed[i], sub[i], 0.0}; // fills are rebuilt by the next clearing
+                if (!x.blank())
+                    v.push_back(x);
+            }
+            rebuildStarts(col);
+        }
+        blockInvM.assign(cols, std::vector<double>(blocks(), 0.0));
+        blockCByM.assign(cols, std::vector<double>(blocks(), 0.0));
+        blockDirty.assign(cols, std::vector<dirtyFlag>(blocks()));
+        columnDirty.assign(cols, dirtyFlag());
+        for (auto &f : blockDirty)
+            for (auto &b : f)
+                b.mark();
+        for (auto &f : columnDirty)
+            f.mark();
+        totalInvM.assign(cols, 0.0);
+        totalCByM.assign(cols, 0.0);
+        freeRows.assign(free, free + freeCount);
+    }
+
+private:
+    int blocks() const { return (rowCount + BLOCK_ROWS - 1) / BLOCK_ROWS; }
+
+    // The row's cell position, adding a blank cell if it has none
+    int reach(int col, int row)
+    {
+        int k = find(col, row);
+        return k >= 0 ? k : insert(col, row);
+    }
+
+    // Add a blank cell for a row in range that has none; returns its position
+    int insert(int col, int row)
+    {
+        std::vector<demandCell> &v = cells[col].write();
+        int b = row / BLOCK_ROWS;
+        auto it = std::lower_bound(v.begin() + start[col][b], v.begin() + start[col][b + 1], row,
+                                   [](const demandCell &x, int r)
+                                   { return x.row < r; });
+        int k = (int)(it - v.begin());
+        v.insert(it, demandCell{row});
+        for (size_t later = b + 1; later < start[col].size(); later++)
+            start[col][later]++;
+        return k;
+    }
+
+    // start[b] = first cell whose row is in block b or later
+    void rebuildStarts(int col)
+    {
+        const std::vector<demandCell> &v = cells[col].read();
+        start[col].assign(blocks() + 1, 0);
+        size_t k = 0;
+        for (int b = 0; b <= blocks(); b++)
+        {
+            while (k < v.size() && v[k].row < b * BLOCK_ROWS)
+                k++;
+            start[col][b] = (int)k;
+        }
+    }
+
+    void markDirty(int col, int row)
+    {
+        blockDirty[col][row / BLOCK_ROWS].mark();
+        columnDirty[col].mark();
+    }
+
+    void refreshBlock(int col, int b) const
+    {
+        const demandCell *v = cells[col].read().data();
+        double invM = 0.0, cByM = 0.0;
+        for (int k = start[col][b]; k < start[col][b + 1]; k++)
+        {
+            if (v[k].m <= 0.000001)
+                continue;
+            invM += 1.0 / v[k].m;
+            cByM += v[k].c / v[k].m;
+        }
+        blockInvM[col][b] = invM;
+        blockCByM[col][b] = cByM;
+        blockDirty[col][b].clear();
+    }
+
+    std::vector<cowVector<demandCell>> cells; // per column, sorted by row
+    std::vector<std::vector<int>> start;      // per column, blocks() + 1 offsets
+
+    // Aggregation cache, refreshed lazily by aggregate()
+    mutable std::vector<std::vector<double>> blockInvM;
+    mutable std::vector<std::vector<double>> blockCByM;
+    mutable std::vector<std::vector<dirtyFlag>> blockDirty;
+    mutable std::vector<dirtyFlag> columnDirty;
+    mutable std::vector<double> totalInvM;
+    mutable std::vector<double> totalCByM;
+
+    std::vector<int> freeRows;
+    int rowCount = 0;
+    bool matched = false;
+};
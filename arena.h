@@ -0,0 +1,337 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <type_traits>
+#include <cstdint>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+
+// Slab storage for one kind of agent, with stable addresses and handles.
+//
+// Agents live in fixed-size pages, so adding one never moves the others.
+// Removing one only marks its slot free (O(1), nothing shifts); the next add
+// reuses the most recently freed slot. Loops over the slots skip dead ones
+// (alive(slot)); range-for visits live agents only, in slot order.
+//
+// A handle names one agent for its whole life: it stays valid across adds,
+// removals and compaction, and stops resolving once the agent is removed (a
+// generation counter per handle tells a recycled handle from the old one).
+// compact() closes the holes left by removals, keeping slot order; it moves
+// agents, so raw pointers must be re-resolved from handles afterwards (see
+// world::compactAgents).
+template <class T>
+class agentArena
+{
+public:
+    static constexpr size_t PAGE = 1024; // agents per page
+
+    struct handle
+    {
+        uint32_t index = UINT32_MAX;
+        uint32_t generation = 0;
+
+        bool valid() const { return index != UINT32_MAX; }
+        bool operator==(const handle &o) const { return index == o.index && generation == o.generation; }
+        bool operator!=(const handle &o) const { return !(*this == o); }
+    };
+
+    agentArena() = default;
+    agentArena(agentArena &&) noexcept = default;
+    agentArena &operator=(agentArena &&) noexcept = default;
+    agentArena(const agentArena &o) { copyFrom(o); }
+    agentArena &operator=(const agentArena &o)
+    {
+        if (this != &o)
+            copyFrom(o);
+        return *this;
+    }
+
+    // ── SIZE ──────────────────────────────────────────────────────────────
+    size_t size() const { return live; }        // live agents
+    size_t slots() const { return slotLive.size(); } // live + free slots, the bound for slot loops
+    size_t holes() const { return freeSlots.size(); }
+    bool empty() const { return live == 0; }
+    bool alive(size_t slot) const { return slotLive[slot] != 0; }
+
+    // Room for n slots without allocating pages mid-run
+    void reserve(size_t n)
+    {
+        slotLive.reserve(n);
+        slotHandle.reserve(n);
+        handleSlot.reserve(n);
+        handleGeneration.reserve(n);
+        pages.reserve((n + PAGE - 1) / PAGE);
+        while (pages.size() * PAGE < n)
+            addPage();
+    }
+
+    void clear()
+    {
+        pages.clear();
+        slotLive.clear();
+        slotHandle.clear();
+        handleSlot.clear();
+        handleGeneration.clear();
+        freeSlots.clear();
+        freeHandles.clear();
+        live = 0;
+        used = 0;
+    }
+
+    // ── ACCESS BY SLOT ────────────────────────────────────────────────────
+    T &operator[](size_t slot) { return (*pages[slot / PAGE])[slot % PAGE]; }
+    const T &operator[](size_t slot) const { return (*pages[slot / PAGE])[slot % PAGE]; }
+
+    // Slot holding p, or -1 if p is not one of this arena's agents. O(pages),
+    // so nothing on a command or day path converts pointers back to slots.
+    long long slotOf(const T *p) const
+    {
+        if (!p)
+            return -1;
+        for (size_t pg = 0; pg < pages.size(); pg++)
+        {
+            const std::vector<T> &page = *pages[pg];
+            if (!page.empty() && p >= page.data() && p < page.data() + page.size())
+                return (long long)(pg * PAGE + (size_t)(p - page.data()));
+        }
+        return -1;
+    }
+
+    // Handle of the first live agent in slot order, invalid if none
+    handle first() const
+    {
+        for (size_t s = 0; s < slots(); s++)
+            if (alive(s))
+                return handleAt(s);
+        return {};
+    }
+
+    // ── LIFECYCLE ─────────────────────────────────────────────────────────
+    T &add(T agent)
+    {
+        size_t slot = claimSlot();
+        if (slot < used)
+            (*this)[slot] = std::move(agent);
+        else
+        {
+            pageFor(slot).push_back(std::move(agent));
+            used++;
+        }
+        return (*this)[slot];
+    }
+
+    template <class... Args>
+    T &emplace(Args &&...args) { return add(T(std::forward<Args>(args)...)); }
+
+    // Frees the agent's slot for reuse in O(1): the slot comes straight from
+    // the handle table. false if the handle no longer names a live agent.
+    bool erase(handle h)
+    {
+        if (!resolves(h))
+            return false;
+        size_t slot = handleSlot[h.index];
+        handleGeneration[h.index]++;
+        handleSlot[h.index] = UINT32_MAX;
+        freeHandles.push_back(h.index);
+        slotLive[slot] = 0;
+        freeSlots.push_back(slot);
+        live--;
+        return true;
+    }
+
+    // ── HANDLES ───────────────────────────────────────────────────────────
+    // Handle of the agent in a live slot, O(1)
+    handle handleAt(size_t slot) const
+    {
+        if (slot >= slots() || !alive(slot))
+            return {};
+        uint32_t h = slotHandle[slot];
+        return {h, handleGeneration[h]};
+    }
+
+    // Handle of the agent at p. This scans the pages (see slotOf), so hot
+    // paths keep handles or slots instead of converting pointers.
+    handle handleOf(const T *p) const
+    {
+        long long slot = slotOf(p);
+        if (slot < 0 || !alive((size_t)slot))
+            return {};
+        uint32_t h = slotHandle[slot];
+        return {h, handleGeneration[h]};
+    }
+
+    // The agent a handle names, nullptr once it has been removed
+    T *get(handle h) { return resolves(h) ? &(*this)[handleSlot[h.index]] : nullptr; }
+    const T *get(handle h) const { return resolves(h) ? &(*this)[handleSlot[h.index]] : nullptr; }
+
+    bool resolves(handle h) const
+    {
+        return h.index < handleSlot.size() && handleGeneration[h.index] == h.generation &&
+               handleSlot[h.index] != UINT32_MAX;
+    }
+
+    // ── COMPACTION ────────────────────────────────────────────────────────
+    // Worth compacting once a quarter of the slots (and at least a page's
+    // worth) are holes; below that, adds refill holes for free
+    bool fragmented() const { return holes() >= PAGE / 4 && holes() * 4 >= slots(); }
+
+    // Slide live agents down over the holes, keeping their order, and drop
+    // the emptied tail. Handles follow their agents; returns agents moved.
+    size_t compact()
+    {
+        if (freeSlots.empty())
+            return 0;
+        size_t to = 0, moved = 0;
+        for (size_t from = 0; from < slots(); from++)
+        {
+            if (!alive(from))
+                continue;
+            if (to != from)
+            {
+                (*this)[to] = std::move((*this)[from]);
+                slotHandle[to] = slotHandle[from];
+                handleSlot[slotHandle[to]] = (uint32_t)to;
+                slotLive[to] = 1;
+                moved++;
+            }
+            to++;
+        }
+        for (size_t pg = 0; pg < pages.size(); pg++)
+        {
+            size_t keep = to > pg * PAGE ? std::min(PAGE, to - pg * PAGE) : 0;
+            std::vector<T> &page = *pages[pg];
+            if (page.size() > keep)
+                page.erase(page.begin() + keep, page.end());
+        }
+        slotLive.resize(to);
+        slotHandle.resize(to);
+        freeSlots.clear();
+        used = to;
+        return moved;
+    }
+
+    // ── ITERATION (live agents, slot order) ───────────────────────────────
+    template <class Arena, class Ref>
+    class liveIterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::remove_reference_t<Ref> *;
+        using reference = Ref;
+
+        liveIterator(Arena *a, size_t s) : a(a), s(s) { skip(); }
+        reference operator*() const { return (*a)[s]; }
+        pointer operator->() const { return &(*a)[s]; }
+        liveIterator &operator++()
+        {
+            s++;
+            skip();
+            return *this;
+        }
+        liveIterator operator++(int)
+        {
+            liveIterator t = *this;
+            ++*this;
+            return t;
+        }
+        bool operator==(const liveIterator &o) const { return s == o.s; }
+        bool operator!=(const liveIterator &o) const { return s != o.s; }
+
+    private:
+        void skip()
+        {
+            while (s < a->slots() && !a->alive(s))
+                s++;
+        }
+        Arena *a;
+        size_t s;
+    };
+
+    using iterator = liveIterator<agentArena, T &>;
+    using const_iterator = liveIterator<const agentArena, const T &>;
+
+    iterator begin() { return {this, 0}; }
+    iterator end() { return {this, slots()}; }
+    const_iterator begin() const { return {this, 0}; }
+    const_iterator end() const { return {this, slots()}; }
+
+private:
+    size_t claimSlot()
+    {
+        size_t slot;
+        if (!freeSlots.empty())
+        {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+        }
+        else
+        {
+            slot = slotLive.size();
+            slotLive.push_back(0);
+            slotHandle.push_back(0);
+        }
+
+        uint32_t h;
+        if (!freeHandles.empty())
+        {
+            h = freeHandles.back();
+            freeHandles.pop_back();
+        }
+        else
+        {
+            h = (uint32_t)handleSlot.size();
+            handleSlot.push_back(0);
+            handleGeneration.push_back(0);
+        }
+        handleSlot[h] = (uint32_t)slot;
+        slotHandle[slot] = h;
+        slotLive[slot] = 1;
+        live++;
+        return slot;
+    }
+
+    void addPage()
+    {
+        pages.push_back(std::make_unique<std::vector<T>>());
+        pages.back()->reserve(PAGE); // never grows past PAGE, so never reallocates
+    }
+
+    std::vector<T> &pageFor(size_t slot)
+    {
+        while (pages.size() <= slot / PAGE)
+            addPage();
+        return *pages[slot / PAGE];
+    }
+
+    void copyFrom(const agentArena &o)
+    {
+        pages.clear();
+        for (auto &p : o.pages)
+        {
+            addPage();
+            pages.back()->assign(p->begin(), p->end());
+        }
+        slotLive = o.slotLive;
+        slotHandle = o.slotHandle;
+        handleSlot = o.handleSlot;
+        handleGeneration = o.handleGeneration;
+        freeSlots = o.freeSlots;
+        freeHandles = o.freeHandles;
+        live = o.live;
+        used = o.used;
+    }
+
+    std::vector<std::unique_ptr<std::vector<T>>> pages;
+    std::vector<uint8_t> slotLive;          // slot -> 1 if it holds a live agent
+    std::vector<uint32_t> slotHandle;       // slot -> handle index
+    std::vector<uint32_t> handleSlot;       // handle index -> slot, UINT32_MAX once freed
+    std::vector<uint32_t> handleGeneration; // bumped when the handle's agent is removed
+    std::vector<size_t> freeSlots;
+    std::vector<uint32_t> freeHandles;
+    size_t live = 0;
+    size_t used = 0; // slots with a constructed agent (live or dead)
+};
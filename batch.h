@@ -0,0 +1,615 @@
+#pragma once
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include "world.h"
+#include "snapshot.h"
+#include "recorder.h"
+#include "regions.h"
+#include "fastforward.h"
+#include "population.h"
+#include "cluster.h"
+
+// Headless batch driver: runs world::pass_day back to back with no sleeps,
+// no styled output and no day cap, writing plain CSV rows to `out`.
+//
+//   ./cppConomy --batch 3650 --every 30 --threads 0 --seed 7 --profile prof.json
+//   ./cppConomy --batch 365 --load year10.snap --save year11.snap
+//   ./cppConomy --batch 36500 --record-bin century.series
+//   ./cppConomy --batch 365 --regions 4 --threads 0
+//   ./cppConomy --batch 365 --regions 4 --population 20000000 --save year1   (year1.1 .. year1.4)
+//   ./cppConomy --batch 36500 --every 365 --fast-forward 0.001
+//   ./cppConomy --batch 365 --every 30 --clearing orders
+//   ./cppConomy --batch 365 --every 30 --clearing ge --ge-tol 1e-8 --ge-iters 100
+//   ./cppConomy --batch 30 --population 5000000 --threads 0
+//   ./cppConomy --batch 365 --every 30 --cluster 4 --port 7070 --population 20000000
+//   ./cppConomy --batch 365 --cluster 4 --load year1                         (worker r loads year1.r)
+//   ./cppConomy --worker coordinator-host:7070 --threads 0       (on each of 4 nodes)
+class batchRunner
+{
+public:
+    struct options
+    {
+        long long days = 365;
+        long long every = 0; // report every N days; 0 = final row only
+        int threads = 1;     // 0 = all cores
+        uint64_t seed = 42;
+        std::string profilePath; // pass_day phase timings as JSON, if set
+        std::string loadPath;    // start from this snapshot instead of innitialize() (see regionFile)
+        std::string savePath;    // snapshot the world after the last day (see regionFile)
+        std::string recordPath;  // every day's series (see recorder.h), if set
+        bool recordBinary = false;
+        int regions = 1; // > 1: shard into trading regions, rows are their totals
+        double fastForward = -1.0; // >= 0: approximate calm days at this tolerance
+        bool orderMatching = false; // --clearing orders: per-agent order books
+        bool jointClearing = false; // --clearing ge: general-equilibrium solver
+        double geTolerance = 1e-6;  // --ge-tol: its largest relative excess demand
+        int geIterations = 50;      // --ge-iters: its iteration budget per clearing
+        bool clearingGiven = false; // --clearing set: overrides a loaded snapshot's mode
+        bool geGiven = false;       // --ge-tol / --ge-iters set: override the snapshot's
+        long long population = 0;   // > 0: generate this many agents instead of innitialize()
+        int cluster = 0;            // > 0: coordinate this many worker processes, one region each
+        int port = 7070;            // --port: where the coordinator listens
+        std::string worker;         // --worker host:port: run one region for that coordinator
+    };
+
+    batchRunner(world &w, options opt, std::ostream &out = std::cout)
+        : simulation(w), opt(opt), out(out) {}
+
+    // false (with a message on stderr) if a snapshot cannot be loaded or saved
+    bool run()
+    {
+        if (opt.cluster > 0)
+            return runCluster();
+        if (!opt.worker.empty())
+            return serve();
+
+        if (opt.regions > 1)
+            return runRegions();
+
+        simulation.setThreads(opt.threads);
+        std::string err;
+        if (!prepare(simulation, opt))
+            return false;
+
+        seriesRecorder recorder;
+        if (!opt.recordPath.empty() &&
+            !recorder.open(opt.recordPath, opt.recordBinary ? seriesRecorder::format::Binary : seriesRecorder::format::Csv,
+                           simulation, err))
+        {
+            std::cerr << err << "\n";
+            return false;
+        }
+
+        out.precision(10);
+        writeHeader();
+        auto start = std::chrono::steady_clock::now();
+        long long first = simulation.dayCount;
+        fastForwarder ff(simulation, std::max(0.0, opt.fastForward));
+        for (long long d = 1; d <= opt.days; d++)
+        {
+            if (opt.fastForward >= 0.0)
+                ff.step();
+            else
+                simulation.pass_day();
+            recorder.record(simulation);
+            if (opt.every > 0 && (first + d) % opt.every == 0 && d != opt.days)
+                writeRow();
+        }
+        recorder.close();
+        auto end = std::chrono::steady_clock::now();
+        writeRow();
+
+        double ms = std::chrono::duration<double, std::milli>(end - start).count();
+        std::cerr << "simulated " << opt.days << " days in " << ms << " ms ("
+                  << simulation.threads() << " threads)\n";
+        if (opt.fastForward >= 0.0)
+            std::cerr << ff.stats().full << " full days, " << ff.stats().approximated
+                      << " approximated (longest quiet run " << ff.stats().longestRun << ")\n";
+        if (opt.jointClearing)
+        {
+            const equilibriumSolver &g = simulation.solver;
+            std::cerr << g.solves << " joint clearings, " << (double)g.iterations / std::max(1LL, g.solves)
+                      << " iterations and " << (double)g.evaluations / std::max(1LL, g.solves)
+                      << " demand passes each, " << g.unconverged << " not converged\n";
+        }
+
+        if (!opt.profilePath.empty())
+        {
+            std::ofstream prof(opt.profilePath);
+            if (prof)
+                prof << simulation.phaseTimes.toJson() << "\n";
+            else
+                std::cerr << "cannot write " << opt.profilePath << "\n";
+        }
+
+        if (!opt.savePath.empty() && !snapshot::save(simulation, opt.savePath, err))
+        {
+            std::cerr << "cannot save " << opt.savePath << ": " << err << "\n";
+            return false;
+        }
+        return true;
+    }
+
+    // Parses --batch N [--every K] [--threads T] [--seed S] [--profile F]
+    // [--load F] [--save F] [--record F | --record-bin F] [--regions R]
+    // [--fast-forward TOL] [--clearing curves|orders|ge] [--ge-tol TOL] [--ge-iters N]
+    // [--population N] [--cluster W [--port P]] | --worker HOST:PORT [--threads T];
+    // false (with a message on stderr) when an argument is missing or malformed
+    static bool parseArgs(int argc, char **argv, options &opt)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            if (i + 1 >= argc)
+            {
+                std::cerr << "missing value for " << arg << "\n";
+                return false;
+            }
+            std::string val = argv[++i];
+            try
+            {
+                if (arg == "--batch")
+                    opt.days = std::stoll(val);
+                else if (arg == "--every")
+                    opt.every = std::stoll(val);
+                else if (arg == "--threads")
+                    opt.threads = std::stoi(val);
+                else if (arg == "--seed")
+                    opt.seed = std::stoull(val);
+                else if (arg == "--profile")
+                    opt.profilePath = val;
+                else if (arg == "--load")
+                    opt.loadPath = val;
+                else if (arg == "--save")
+                    opt.savePath = val;
+                else if (arg == "--fast-forward")
+                    opt.fastForward = std::stod(val);
+                else if (arg == "--clearing" && (val == "orders" || val == "curves" || val == "ge"))
+                {
+                    opt.orderMatching = val == "orders";
+                    opt.jointClearing = val == "ge";
+                    opt.clearingGiven = true;
+                }
+                else if (arg == "--ge-tol")
+                {
+                    opt.geTolerance = std::stod(val);
+                    opt.geGiven = true;
+                }
+                else if (arg == "--ge-iters")
+                {
+                    opt.geIterations = std::stoi(val);
+                    opt.geGiven = true;
+                }
+                else if (arg == "--regions")
+                    opt.regions = std::stoi(val);
+                else if (arg == "--population")
+                    opt.population = std::stoll(val);
+                else if (arg == "--cluster")
+                    opt.cluster = std::stoi(val);
+                else if (arg == "--port")
+                    opt.port = std::stoi(val);
+                else if (arg == "--worker")
+                    opt.worker = val;
+                else if (arg == "--record" || arg == "--record-bin")
+                {
+                    opt.recordPath = val;
+                    opt.recordBinary = arg == "--record-bin";
+                }
+                else
+                {
+                    std::cerr << "unknown option " << arg << "\n";
+                    return false;
+                }
+            }
+            catch (const std::exception &)
+            {
+                std::cerr << "bad value for " << arg << ": " << val << "\n";
+                return false;
+            }
+        }
+        if (!(opt.geTolerance >= 0.0) || opt.geIterations < 1)
+        {
+            std::cerr << "--ge-tol must be >= 0 and --ge-iters >= 1\n";
+            return false;
+        }
+        if (opt.days < 0 || opt.every < 0 || opt.population < 0)
+        {
+            std::cerr << "day and agent counts cannot be negative\n";
+            return false;
+        }
+        if (opt.regions > 1 && opt.fastForward >= 0.0)
+        {
+            std::cerr << "--regions cannot be combined with --fast-forward\n";
+            return false;
+        }
+        if (opt.regions > 1 && (!opt.recordPath.empty() || !opt.profilePath.empty()))
+        {
+            std::cerr << "--regions cannot be combined with --record or --profile\n";
+            return false;
+        }
+        if (opt.cluster < 0 || opt.port < 1 || opt.port > 65535)
+        {
+            std::cerr << "--cluster needs a worker count and --port a TCP port\n";
+            return false;
+        }
+        if (opt.cluster > 0 && (opt.regions > 1 || opt.fastForward >= 0.0 || !opt.savePath.empty() ||
+                                !opt.recordPath.empty() || !opt.profilePath.empty()))
+        {
+            std::cerr << "--cluster cannot be combined with --regions, --fast-forward, --save, --record or --profile\n";
+            return false;
+        }
+        if (opt.cluster > 0 && opt.population == 0 && opt.loadPath.empty())
+        {
+            std::cerr << "--cluster needs --population N or per-region snapshots (--load, written by --regions --save)\n";
+            return false;
+        }
+        if (!opt.worker.empty() && opt.cluster > 0)
+        {
+            std::cerr << "--worker and --cluster are different processes\n";
+            return false;
+        }
+        return true;
+    }
+
+    // --batch, or --worker (a worker's days are set by its coordinator)
+    static bool wantsBatch(int argc, char **argv)
+    {
+        for (int i = 1; i < argc; i++)
+            if (std::string(argv[i]) == "--batch" || std::string(argv[i]) == "--worker")
+                return true;
+        return false;
+    }
+
+    // The starting world the options describe: a snapshot, a generated
+    // population or innitialize()'s cast, with the clearing settings applied.
+    // A snapshot brings its own clearing mode and solver settings; options
+    // given on the command line replace them.
+    static bool prepare(world &w, const options &opt)
+    {
+        std::string err;
+        if (opt.loadPath.empty())
+        {
+            w.seed = opt.seed;
+            if (opt.population > 0)
+            {
+                auto t0 = std::chrono::steady_clock::now();
+                populationBuilder({}).build(w, opt.population);
+                std::cerr << "generated " << w.getPopulation() << " agents and " << w.firms.size()
+                          << " firms in " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count()
+                          << " ms\n";
+            }
+            else
+                w.innitialize();
+        }
+        else if (!snapshot::load(w, opt.loadPath, err)) // seed comes from the file
+        {
+            std::cerr << "cannot load " << opt.loadPath << ": " << err << "\n";
+            return false;
+        }
+        applyClearing(w, opt);
+        return true;
+    }
+
+    // Region `rank` of `ranks` of the starting world, built on its own so no
+    // process holds the whole population: either that region of the
+    // generated population (see populationBuilder::build), seeded like
+    // regionSet::shard seeds it, or the region's own snapshot. Needs
+    // --population or --load.
+    static bool prepareRegion(world &w, const options &opt, int rank, int ranks)
+    {
+        std::string err;
+        if (opt.loadPath.empty())
+        {
+            w.seed = opt.seed;
+            populationBuilder({}).build(w, opt.population, rank, ranks);
+            w.seed += (uint64_t)rank; // region 1 keeps the whole population's draws
+            w.calculateStats();
+        }
+        else if (!snapshot::load(w, regionFile(opt.loadPath, rank), err))
+        {
+            std::cerr << "cannot load " << regionFile(opt.loadPath, rank) << ": " << err << "\n";
+            return false;
+        }
+        applyClearing(w, opt);
+        return true;
+    }
+
+    // Region r's snapshot: base.1 .. base.N
+    static std::string regionFile(const std::string &base, int rank)
+    {
+        return base + "." + std::to_string(rank + 1);
+    }
+
+private:
+    // The options' clearing settings; a loaded world keeps its own unless
+    // they were given on the command line
+    static void applyClearing(world &w, const options &opt)
+    {
+        bool loaded = !opt.loadPath.empty();
+        if (!loaded || opt.clearingGiven)
+        {
+            w.orderMatching = opt.orderMatching;
+            w.jointClearing = opt.jointClearing;
+        }
+        if (!loaded || opt.geGiven)
+        {
+            w.solver.tolerance = opt.geTolerance;
+            w.solver.maxIterations = opt.geIterations;
+        }
+        w.solver.resetTotals();
+    }
+
+    // The starting world in regions; the pool steps regions side by side and
+    // each region runs single-threaded. A generated population is built
+    // region by region; a loaded or initialised world is sharded. --save
+    // writes one snapshot per region (see regionFile), the files a cluster's
+    // workers --load.
+    bool runRegions()
+    {
+        regionSet set;
+        set.setThreads(opt.threads);
+        if (opt.population > 0 && opt.loadPath.empty())
+        {
+            set.open(opt.regions);
+            for (int r = 0; r < opt.regions; r++)
+            {
+                world &w = set.regions[r].economy;
+                w.setThreads(opt.threads);
+                if (!prepareRegion(w, opt, r, opt.regions))
+                    return false;
+                w.setThreads(1);
+            }
+        }
+        else
+        {
+            simulation.setThreads(opt.threads);
+            if (!prepare(simulation, opt))
+                return false;
+            set.split(simulation, opt.regions);
+        }
+
+        out.precision(10);
+        writeHeader(regionSet::quotes(set.regions.front().economy));
+        auto start = std::chrono::steady_clock::now();
+        long long first = set.dayCount();
+        for (long long d = 1; d <= opt.days; d++)
+        {
+            set.pass_day();
+            if (opt.every > 0 && (first + d) % opt.every == 0 && d != opt.days)
+                writeRow(set);
+        }
+        auto end = std::chrono::steady_clock::now();
+        writeRow(set);
+
+        double ms = std::chrono::duration<double, std::milli>(end - start).count();
+        std::cerr << "simulated " << opt.days << " days in " << ms << " ms ("
+                  << set.size() << " regions, " << set.threads() << " threads)\n";
+
+        std::string err;
+        for (size_t r = 0; r < set.size() && !opt.savePath.empty(); r++)
+            if (!snapshot::save(set.regions[r].economy, regionFile(opt.savePath, (int)r), err))
+            {
+                std::cerr << "cannot save " << regionFile(opt.savePath, (int)r) << ": " << err << "\n";
+                return false;
+            }
+        return true;
+    }
+
+    // ── CLUSTER ───────────────────────────────────────────────────────────
+    // Coordinator: waits for opt.cluster workers, hands worker r region r of
+    // the world the options describe, then runs the days. Each day every
+    // worker gets its imports and steps its region; the reports come back in
+    // rank order and are cleared together exactly as regionSet does, so a
+    // cluster of W workers prints what --regions W prints. The coordinator
+    // holds no world, only each region's quotes and summary.
+    bool runCluster()
+    {
+        std::string err;
+        cluster::listener listening;
+        if (!listening.open(opt.port, err))
+            return fail(err);
+        std::cerr << "waiting for " << opt.cluster << " workers on port " << opt.port << "\n";
+
+        std::vector<cluster::connection> workers(opt.cluster);
+        cluster::message m;
+        for (int r = 0; r < opt.cluster; r++)
+        {
+            uint32_t magic = 0, version = 0;
+            if (!listening.accept(workers[r], err) || !workers[r].expect(cluster::Hello, m, err) ||
+                !m.get(magic) || !m.get(version))
+                return fail("worker " + std::to_string(r + 1) + ": " + (err.empty() ? "bad hello" : err));
+            if (magic != cluster::MAGIC || version != cluster::VERSION)
+                return fail("worker " + std::to_string(r + 1) + " speaks another protocol version");
+
+            m.clear();
+            m.put((int32_t)r);
+            m.put((int32_t)opt.cluster);
+            m.put(opt.seed);
+            m.put(opt.population);
+            m.put(opt.orderMatching);
+            m.put(opt.jointClearing);
+            m.put(opt.geTolerance);
+            m.put((int32_t)opt.geIterations);
+            m.put(opt.clearingGiven);
+            m.put(opt.geGiven);
+            m.put(opt.loadPath);
+            if (!workers[r].send(cluster::Setup, m, err))
+                return fail("worker " + std::to_string(r + 1) + ": " + err);
+        }
+
+        std::vector<std::vector<tradeQuote>> quotes(opt.cluster);
+        std::vector<regionSummary> summaries(opt.cluster);
+        int day = 0;
+        auto gather = [&]()
+        {
+            for (int r = 0; r < opt.cluster; r++)
+                if (!workers[r].expect(cluster::Report, m, err) || !m.get(day) ||
+                    !m.get(summaries[r]) || !m.get(quotes[r]))
+                    return fail("worker " + std::to_string(r + 1) + ": " + (err.empty() ? "bad report" : err));
+            return true;
+        };
+        if (!gather()) // the shards as built
+            return false;
+
+        out.precision(10);
+        writeHeader(quotes.front());
+        auto start = std::chrono::steady_clock::now();
+        long long first = day;
+        std::vector<double> pooled;
+        std::vector<std::vector<double>> imports(opt.cluster);
+        for (long long d = 1; d <= opt.days; d++)
+        {
+            for (int r = 0; r < opt.cluster; r++)
+            {
+                m.clear();
+                m.put(imports[r]);
+                if (!workers[r].send(cluster::Step, m, err))
+                    return fail("worker " + std::to_string(r + 1) + ": " + err);
+            }
+            if (!gather())
+                return false;
+            if (opt.cluster > 1)
+                regionSet::clearTrade(quotes, regionSet::TRADE_SHARE, pooled, imports);
+            if (opt.every > 0 && (first + d) % opt.every == 0 && d != opt.days)
+                writeRow(day, regionSet::combine(summaries), quotes);
+        }
+        auto end = std::chrono::steady_clock::now();
+        writeRow(day, regionSet::combine(summaries), quotes);
+
+        uint64_t traffic = 0;
+        m.clear();
+        for (auto &w : workers)
+        {
+            w.send(cluster::Stop, m, err); // a worker that already left is not an error now
+            traffic += w.sent + w.received;
+        }
+        double ms = std::chrono::duration<double, std::milli>(end - start).count();
+        std::cerr << "simulated " << opt.days << " days in " << ms << " ms (" << opt.cluster << " workers, "
+                  << traffic / std::max<long long>(1, opt.days * opt.cluster) << " bytes per worker-day)\n";
+        return true;
+    }
+
+    // Worker: connect, take a rank and the world options from the
+    // coordinator, build that region alone (prepareRegion: generated by rank,
+    // or the region's own snapshot) and step it on this process's threads
+    bool serve()
+    {
+        std::string err;
+        cluster::connection link;
+        cluster::message m;
+        m.put(cluster::MAGIC);
+        m.put(cluster::VERSION);
+        if (!cluster::connect(opt.worker, link, err) || !link.send(cluster::Hello, m, err))
+            return fail(err);
+
+        int32_t rank = 0, regions = 0, iterations = 0;
+        options from = opt;
+        if (!link.expect(cluster::Setup, m, err) || !m.get(rank) || !m.get(regions) ||
+            !m.get(from.seed) || !m.get(from.population) || !m.get(from.orderMatching) ||
+            !m.get(from.jointClearing) || !m.get(from.geTolerance) || !m.get(iterations) ||
+            !m.get(from.clearingGiven) || !m.get(from.geGiven) || !m.get(from.loadPath))
+            return fail(err.empty() ? "bad setup from coordinator" : err);
+        from.geIterations = iterations;
+
+        world economy;
+        economy.setThreads(opt.threads);
+        if (!prepareRegion(economy, from, rank, regions))
+            return false;
+        std::cerr << "region " << rank + 1 << " of " << regions << ": " << economy.getPopulation()
+                  << " agents, " << economy.firms.size() << " firms\n";
+
+        auto report = [&]()
+        {
+            m.clear();
+            m.put((int32_t)economy.dayCount);
+            m.put(regionSet::summarize(economy));
+            m.put(regionSet::quotes(economy));
+            return link.send(cluster::Report, m, err);
+        };
+        if (!report())
+            return fail(err);
+
+        std::vector<double> imports;
+        for (;;)
+        {
+            cluster::kind k;
+            if (!link.receive(k, m, err))
+                return fail(err);
+            if (k == cluster::Stop)
+                return true;
+            if (k != cluster::Step || !m.get(imports))
+                return fail("unexpected message from coordinator");
+            if (!imports.empty()) // none before the first exchange
+                economy.imports = imports;
+            economy.pass_day();
+            if (!report())
+                return fail(err);
+        }
+    }
+
+    static bool fail(const std::string &err)
+    {
+        std::cerr << err << "\n";
+        return false;
+    }
+
+    // One cluster row: totals as writeRow(regionSet &) forms them
+    void writeRow(int day, const world::stats &s, const std::vector<std::vector<tradeQuote>> &quotes)
+    {
+        out << day << ',' << s.gdp << ','
+            << s.gdp / std::max(1, s.population) << ','
+            << s.unemployment << ',' << s.employed << ',' << s.population << ','
+            << s.moneySupply;
+        for (auto &q : quotes.front())
+            out << ',' << regionSet::meanPrice(quotes, q.productId);
+        out << "\n";
+    }
+
+    void writeHeader(const std::vector<tradeQuote> &markets)
+    {
+        out << "day,gdp,gdp_per_capita,unemployment,employed,population,money_supply";
+        for (auto &q : markets)
+            out << ",price_" << catalogue().get(q.productId)->name;
+        out << "\n";
+    }
+
+    // Totals over regions; prices are the mean over regions with the market
+    void writeRow(regionSet &set)
+    {
+        world::stats s = set.totals();
+        out << set.dayCount() << ',' << s.gdp << ','
+            << s.gdp / std::max(1, s.population) << ','
+            << s.unemployment << ',' << s.employed << ',' << s.population << ','
+            << s.moneySupply;
+        for (auto &m : set.regions.front().economy.markets)
+            out << ',' << set.meanPrice(m.prod->id);
+        out << "\n";
+    }
+
+    void writeHeader()
+    {
+        out << "day,gdp,gdp_per_capita,unemployment,employed,population,money_supply";
+        for (auto &m : simulation.markets)
+            out << ",price_" << m.prod->name;
+        out << "\n";
+    }
+
+    void writeRow()
+    {
+        world::stats s = simulation.getStats();
+        out << simulation.dayCount << ',' << s.gdp << ','
+            << s.gdp / std::max(1, s.population) << ','
+            << s.unemployment << ',' << s.employed << ',' << s.population << ','
+            << s.moneySupply;
+        for (auto &m : simulation.markets)
+            out << ',' << m.price;
+        out << "\n";
+    }
+
+    world &simulation;
+    options opt;
+    std::ostream &out;
+};
@@ -0,0 +1,239 @@
+// Benchmark for the simulation core on synthetic worlds.
+//
+//   g++ -O2 -pthread -o bench bench.cpp
+//   ./bench                          # 1e3, 1e4, 1e5 agents
+//   ./bench 1000000 --days 5 --threads 0
+//
+// For each world size it times pass_day and, separately, updateAllMarkets,
+// firmOptimize, calculateStats and the order-book clearing (matchOrders, not
+// part of the default pass_day), and reports ns per agent per day and heap
+// allocations per day (counted by the global operator new below). Once warmed
+// up, pass_day and matchOrders must not allocate at all: any allocation in
+// their measured days is reported and makes the exit status non-zero.
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "world.h"
+
+// ── ALLOCATION COUNTER ────────────────────────────────────────────────────
+// malloc/free behind a counting operator new; GCC cannot see they pair up
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+static std::atomic<unsigned long long> allocations{0};
+
+void *operator new(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+void *operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+
+// ── SYNTHETIC WORLD ───────────────────────────────────────────────────────
+// The hand-built world from innitialize() plus `agents` generated agents:
+// 70% consumers, 20% laborers, 10% farmers, and one firm per 200 laborers.
+static void buildSyntheticWorld(world &w, long long agents, uint64_t seed)
+{
+    w.seed = seed;
+    w.innitialize();
+
+    long long nFarmers = agents / 10;
+    long long nLaborers = agents / 5;
+    long long nConsumers = agents - nFarmers - nLaborers;
+    w.consumers.reserve(w.consumers.size() + nConsumers);
+    w.laborers.reserve(w.laborers.size() + nLaborers);
+    w.farmers.reserve(w.farmers.size() + nFarmers);
+
+    int id = 1000;
+    for (long long i = 0; i < nConsumers; i++, id++)
+    {
+        rng::generator g(seed, rng::stream::Synthetic, 0, id);
+        double income = g.uniform(250.0, 1000.0);
+        w.addConsumerFull(id, "c" + std::to_string(id), 18 + g.below(50),
+                          income * g.uniform(5.0, 90.0), income);
+    }
+    for (long long i = 0; i < nLaborers; i++, id++)
+    {
+        rng::generator g(seed, rng::stream::Synthetic, 0, id);
+        double skill = g.uniform(0.3, 0.9);
+        double minWage = 250.0 + skill * 300.0;
+        w.addLaborerFull(id, "l" + std::to_string(id), 18 + g.below(40), skill, minWage,
+                         minWage * g.uniform(5.0, 30.0), minWage * 1.1);
+    }
+
+    product *cropPool[] = {&rice, &potato, &banana, &corn, &jute};
+    for (long long i = 0; i < nFarmers; i++, id++)
+    {
+        rng::generator g(seed, rng::stream::Synthetic, 0, id);
+        double land = farmer::getRealisticLandSize(g);
+        farmer f(id, "f" + std::to_string(id), 20 + g.below(45), land, g.uniform(0.2, 0.9));
+        f.savings = g.uniform(4000.0, 40000.0);
+        f.incomePerDay = 200.0 + land * 60.0;
+        f.tax = 0.05;
+        f.weather = 0.70;
+        int first = g.below(5);
+        f.addCrop(cropPool[first], {0.25, 35.0}, 40.0 + land * 8.0, 2.5, 60.0 + land * 20.0);
+        if (land > 1.0)
+            f.addCrop(cropPool[(first + 1) % 5], {0.20, 30.0}, 35.0 + land * 6.0, 3.0, 50.0 + land * 15.0);
+        w.farmers.add(f);
+    }
+
+    product *firmGoods[] = {&cloth, &computer, &phone, &rice};
+    long long nFirms = nLaborers / 200;
+    for (long long i = 0; i < nFirms; i++)
+    {
+        rng::generator g(seed, rng::stream::Synthetic, 1, i); // day slot 1 = firms
+        firm f(1000 + (int)i, g.uniform(3e5, 2e6), cobbDouglas(g.uniform(0.4, 0.7), 0.4, g.uniform(1.0, 1.5)));
+        f.productIds.push_back(firmGoods[i % 4]->id);
+        f.wage = g.uniform(380.0, 700.0);
+        f.fixed_overhead = g.uniform(1500.0, 9000.0);
+        f.addCapital(g.uniform(500.0, 2000.0), g.uniform(1.0, 2.0));
+        w.firms.push_back(f);
+    }
+
+    w.initializeDemandCurves();
+    w.initializeSupplyCurves();
+    w.rebuildEmployment();
+    for (auto &f : w.firms)
+    {
+        for (int k = 0; k < 3; k++)
+        {
+            int best = w.employment.bestCandidate(f.wage);
+            if (best >= 0)
+                w.hire(f, best);
+        }
+        f.calculateCosts();
+    }
+}
+
+// ── TIMING ────────────────────────────────────────────────────────────────
+struct phaseResult
+{
+    double nsPerAgentDay;
+    double allocsPerDay;
+    unsigned long long allocs;
+};
+
+// One unmeasured call first: a phase sizes its buffers on its first run
+template <class Fn>
+static phaseResult measure(world &w, int days, Fn &&fn)
+{
+    fn();
+    unsigned long long a0 = allocations.load();
+    auto t0 = std::chrono::steady_clock::now();
+    for (int d = 0; d < days; d++)
+        fn();
+    auto t1 = std::chrono::steady_clock::now();
+    unsigned long long a1 = allocations.load();
+
+    double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+    double agents = std::max(1, w.getPopulation());
+    return {ns / agents / days, (double)(a1 - a0) / days, a1 - a0};
+}
+
+static int usage(const std::string &bad)
+{
+    std::fprintf(stderr, "bench: %s\n"
+                         "usage: bench [AGENTS...] [--days N] [--threads T]\n"
+                         "  AGENTS       world sizes to run (default 1000 10000 100000)\n"
+                         "  --days N     measured days per size, >= 1 (default 20)\n"
+                         "  --threads T  agent update threads, 0 = all cores (default 1)\n",
+                 bad.c_str());
+    return 2;
+}
+
+// Whole-string integer, or false
+static bool parseCount(const char *text, long long &value)
+{
+    char *end = nullptr;
+    errno = 0;
+    value = std::strtoll(text, &end, 10);
+    return errno == 0 && end != text && *end == '\0';
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<long long> sizes;
+    int days = 20;
+    int threads = 1;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        long long value = 0;
+        if (arg == "--days" || arg == "--threads")
+        {
+            if (i + 1 >= argc || !parseCount(argv[i + 1], value) || value < (arg == "--days" ? 1 : 0) ||
+                value > 1000000)
+                return usage("bad value for " + arg);
+            i++;
+            if (arg == "--days")
+                days = (int)value;
+            else
+                threads = (int)value;
+        }
+        else if (parseCount(arg.c_str(), value) && value > 0)
+            sizes.push_back(value);
+        else
+            return usage("unknown argument " + arg);
+    }
+    if (sizes.empty())
+        sizes = {1000, 10000, 100000};
+
+    int failures = 0;
+    std::printf("%-10s %-18s %14s %14s\n", "agents", "phase", "ns/agent/day", "allocs/day");
+    for (long long n : sizes)
+    {
+        world w;
+        w.setThreads(threads);
+        buildSyntheticWorld(w, n, 42);
+
+        // Warm up so caches and dirty blocks reach steady state
+        for (int d = 0; d < 3; d++)
+            w.pass_day();
+
+        struct row
+        {
+            const char *name;
+            phaseResult r;
+        };
+        row rows[] = {
+            {"pass_day", measure(w, days, [&]
+                                 { w.pass_day(); })},
+            {"updateAllMarkets", measure(w, days, [&]
+                                         { w.updateAllMarkets(); })},
+            {"firmOptimize", measure(w, days, [&]
+                                     { w.firmOptimize(); })},
+            {"calculateStats", measure(w, days, [&]
+                                       { w.calculateStats(); })},
+            {"matchOrders", measure(w, days, [&]
+                                    { w.matchOrders(); })},
+        };
+        for (auto &r : rows)
+            std::printf("%-10d %-18s %14.2f %14.1f\n", w.getPopulation(), r.name,
+                        r.r.nsPerAgentDay, r.r.allocsPerDay);
+
+        // The steady-state day loop and order matching are allocation-free
+        for (const row *r : {&rows[0], &rows[4]})
+            if (r->r.allocs != 0)
+            {
+                std::fprintf(stderr, "FAIL: %s made %llu heap allocations over %d days at %d agents\n",
+                             r->name, r->r.allocs, days, w.getPopulation());
+                failures++;
+            }
+    }
+    return failures ? 1 : 0;
+}
@@ -1,4 +1,7 @@
 #pragma once
+#include <vector>
+#include <cstddef>
+#include <utility>
 
 class capital {
 public:
@@ -6,4 +9,76 @@ public:
     double efficiency; // how much output per unit of capital
 
     capital(double rentalRate, double efficiency) : rentalRate(rentalRate), efficiency(efficiency) {}
-};
\ No newline at end of file
+};
+
+// A firm's machines as running totals instead of one entry per machine.
+//
+// Production only needs the machine count and costs only the summed rental,
+// so both are kept up to date as machines are added and read in O(1) however
+// long the firm has been investing. The rental total is accumulated in the
+// order machines arrive, so it equals the per-machine sum bit for bit.
+//
+// Machines are also grouped into vintages, one per VINTAGE_DAYS of
+// simulation time, each with its own count, rental and efficiency-weighted
+// units. depreciate() wears the units down vintage by vintage; older
+// vintages can then be told apart from new ones without keeping every
+// machine.
+class capitalStock
+{
+public:
+    static constexpr int VINTAGE_DAYS = 365;
+
+    struct vintage
+    {
+        int year = 0;  // day added / VINTAGE_DAYS
+        int count = 0; // machines
+        double rental = 0.0, units = 0.0;
+    };
+
+    void add(const capital &machine, int day = 0)
+    {
+        int year = day / VINTAGE_DAYS;
+        if (buckets.empty() || buckets.back().year != year)
+            buckets.push_back({year, 0, 0.0, 0.0});
+        vintage &v = buckets.back();
+        v.count++;
+        v.rental += machine.rentalRate;
+        v.units += machine.efficiency;
+        machines++;
+        rentalTotal += machine.rentalRate;
+        unitsTotal += machine.efficiency;
+    }
+
+    int count() const { return machines; }
+    double rental() const { return rentalTotal; } // summed rental rates
+    double units() const { return unitsTotal; }   // efficiency-weighted machines
+    const std::vector<vintage> &vintages() const { return buckets; }
+
+    // Every vintage loses `rate` of its efficiency units
+    void depreciate(double rate)
+    {
+        unitsTotal = 0.0;
+        for (vintage &v : buckets)
+        {
+            v.units *= 1.0 - rate;
+            unitsTotal += v.units;
+        }
+    }
+
+    // Rebuild from saved totals and vintages (see snapshot.h)
+    void restore(int count, double rental, double units, std::vector<vintage> saved)
+    {
+        machines = count;
+        rentalTotal = rental;
+        unitsTotal = units;
+        buckets = std::move(saved);
+    }
+
+    void reserve(size_t vintages) { buckets.reserve(vintages); }
+    size_t capacity() const { return buckets.capacity(); }
+
+private:
+    int machines = 0;
+    double rentalTotal = 0.0, unitsTotal = 0.0;
+    std::vector<vintage> buckets; // oldest first
+};
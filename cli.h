@@ -4,6 +4,8 @@
 #include <string>
 #include <sstream>
 #include <iomanip>
+#include <thread>
+#include <chrono>
 
 #ifdef _WIN32
 #include <conio.h>
@@ -63,21 +65,9 @@ public:
     void run()
     {
 
-        std::cout << Styled("Innitializing world", Color::BrightYellow);
-// pause and clear screen
-#ifdef _WIN32 //todo: remove comments
-        // system("timeout 1 > nul"); // pause for 1 second (Windows)
-        // std::cout << ".";
-        // system("timeout 1 > nul"); // pause for 1 second (Windows)
-        // std::cout << ".";
-        // system("timeout 1 > nul"); // pause for 1 second (Windows)
-        // std::cout << ".";
-        // system("timeout 1 > nul"); // pause for 1 second (Windows)
-        system("cls");
-#else
-        system("sleep 3"); // pause for 3 seconds (Unix)
-        system("clear");
-#endif
+        std::cout << Styled("Innitializing world", Color::BrightYellow) << std::flush;
+        std::this_thread::sleep_for(std::chrono::seconds(3));
+        clearScreen();
 
         // show header
         showStickyHeader();
@@ -224,30 +214,18 @@ public:
             Repeat(Horizontal, rightWidth) + BottomRight,
             Theme::Primary) << "\n";
 
-        laborer *selLaborer = simulation.GetSelectedLaborer();
-        farmer *selFarmer = simulation.GetSelectedFarmer();
-        consumer *selConsumer = simulation.GetSelectedConsumer();
-        market *selMarket = simulation.GetSelectedMarket();
+        // Rendered from the published view, so the header can be drawn while
+        // a background run is stepping the world
+        const worldView &v = executor.view();
 
         std::string marketPriceText;
-        if (selMarket)
+        if (v.market.present)
         {
             std::ostringstream priceStream;
-            priceStream << std::fixed << std::setprecision(2) << selMarket->price;
+            priceStream << std::fixed << std::setprecision(2) << v.market.price;
             marketPriceText = priceStream.str();
         }
 
-        std::string cropNames = "";
-        if (selFarmer)
-        {
-            for (size_t i = 0; i < selFarmer->crops.size(); ++i)
-            {
-                cropNames += selFarmer->crops[i].name;
-                if (i < selFarmer->crops.size() - 1)
-                    cropNames += ", ";
-            }
-        }
-
         // Slot widths: 4 boxes each with left+right border = screen_width total
         // Each box visual width = slotWidth + 2 (borders), so 4*(sw+2) = screen_width
         // → slotWidth = (screen_width - 8) / 4, remainder distributed left-to-right
@@ -259,28 +237,28 @@ public:
         const int sw4 = slotBase;
 
         std::vector<std::string> slot1 = createSlot("LABORER",
-                                                    selLaborer ? selLaborer->name +
-                                                                     "\nSkill Level: " + std::to_string((int)(selLaborer->skillLevel * 100)) + "%" +
-                                                                     "\nMin Wage: " + std::to_string((int)selLaborer->minWage) + " Tk/day"
+                                                    v.laborer.present ? v.laborer.name +
+                                                                     "\nSkill Level: " + std::to_string((int)(v.laborer.skillLevel * 100)) + "%" +
+                                                                     "\nMin Wage: " + std::to_string((int)v.laborer.minWage) + " Tk/day"
                                                                : "\nNone selected\n ",
                                                     sw1);
 
         std::vector<std::string> slot2 = createSlot("FARMER",
-                                                    selFarmer ? selFarmer->name +
-                                                                    "\nLand: " + std::to_string((int)selFarmer->land) + " acres" +
-                                                                    "\nCrops: " + cropNames
+                                                    v.farmer.present ? v.farmer.name +
+                                                                    "\nLand: " + std::to_string((int)v.farmer.land) + " acres" +
+                                                                    "\nCrops: " + v.farmer.crops
                                                               : "\nNone selected\n ",
                                                     sw2);
 
         std::vector<std::string> slot3 = createSlot("CONSUMER",
-                                                    selConsumer ? selConsumer->name +
-                                                                      "\nAge: " + std::to_string(selConsumer->ageInDays / 365) + " years" +
-                                                                      "\nSavings: Tk " + std::to_string((int)selConsumer->savings)
+                                                    v.consumer.present ? v.consumer.name +
+                                                                      "\nAge: " + std::to_string(v.consumer.ageInDays / 365) + " years" +
+                                                                      "\nSavings: Tk " + std::to_string((int)v.consumer.savings)
                                                                 : "\nNone selected\n ",
                                                     sw3);
 
         std::vector<std::string> slot4 = createSlot("MARKET",
-                                                    selMarket ? selMarket->prod->name +
+                                                    v.market.present ? v.market.name +
                                                                     "\nPrice: Tk " + marketPriceText +
                                                                     "\n "
                                                               : "\nNone selected\n ",
@@ -364,16 +342,14 @@ public:
 
     void clearScreen()
     {
-#ifdef _WIN32
-        system("cls");
-#else
-        system("clear");
-#endif
+        // Windows needs the VT mode set by Init(); plain output just starts a new line
+        std::cout << (plainText ? "\n" : Screen::Clear) << std::flush;
     }
 
     void showStatus()
     {
-        auto stats = simulation.getStats();
+        const worldView &v = executor.view();
+        const world::stats &stats = v.stats;
 
         // helpers mirroring executor style (inline since sH/kv live in cmdExec)
         auto fmtD = [](double v, int p = 2) {
@@ -402,6 +378,13 @@ public:
 
         sH("ECONOMIC STATUS");
 
+        if (executor.busy())
+        {
+            kv("Background run", "day " + std::to_string(v.day) + " of " +
+                                     std::to_string(executor.background.targetDay));
+            hline();
+        }
+
         section("OUTPUT");
         kv("GDP",          "Tk " + fmtD(stats.gdp));
         double gdpPerCap = stats.population > 0 ? stats.gdp / stats.population : 0.0;
@@ -409,18 +392,18 @@ public:
         hline();
 
         section("MARKET PRICES");
-        for (auto &m : simulation.markets)
+        for (auto &m : v.markets)
         {
             if (m.price > 0.1)
             {
                 std::string trendStr;
-                if (m.priceHistory.size() > 1) {
-                    double delta = m.price - m.priceHistory[m.priceHistory.size() - 2];
+                if (m.hasPrev) {
+                    double delta = m.price - m.prevPrice;
                     trendStr = delta > 0.5 ? Styled("  ▲", Theme::Warning) :
                                delta < -0.5 ? Styled("  ▼", Theme::Info) :
                                Styled("  ─", Theme::Muted);
                 }
-                kv(m.prod->name, "Tk " + fmtD(m.price) + trendStr);
+                kv(m.name, "Tk " + fmtD(m.price) + trendStr);
             }
         }
         hline();
@@ -0,0 +1,391 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <type_traits>
+#include <utility>
+
+#ifndef _WIN32
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+// Transport for regions run as separate processes (see batchRunner's
+// --cluster and --worker).
+//
+// One coordinator listens on a TCP port and each worker connects to it and
+// owns one region. Messages are framed as {kind, byte count} followed by a
+// body of packed plain-data fields, so a day costs one step message (the
+// region's imports, one double per product) and one report (its stats and a
+// tradeQuote per market) per worker: O(markets), whatever the population.
+// Field layouts are the compiler's, so every process must run the same build
+// on machines of the same byte order; the hello carries a magic number and
+// the protocol version to catch mismatches. Sockets are POSIX only; on other
+// platforms every call fails with a message.
+namespace cluster
+{
+    static constexpr uint32_t MAGIC = 0x4C435043; // "CPCL"
+    static constexpr uint32_t VERSION = 2;
+    static constexpr uint64_t MAX_MESSAGE = 1ull << 30;
+
+    enum kind : uint32_t
+    {
+        Hello = 1, // worker -> coordinator: magic, version
+        Setup,     // coordinator -> worker: rank, region count, world options
+        Report,    // worker -> coordinator: day, region summary, quotes
+        Step,      // coordinator -> worker: imports for the next day, then run it
+        Stop       // coordinator -> worker: shut down
+    };
+
+    // ── MESSAGE ───────────────────────────────────────────────────────────
+    // A body under construction or being read back, field by field in the
+    // order it was written. Reads past the end fail instead of leaving junk.
+    class message
+    {
+    public:
+        template <class T>
+        void put(const T &v)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "message fields are plain data");
+            const char *p = reinterpret_cast<const char *>(&v);
+            bytes.insert(bytes.end(), p, p + sizeof(T));
+        }
+
+        template <class T>
+        void put(const std::vector<T> &v)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "message fields are plain data");
+            put((uint64_t)v.size());
+            const char *p = reinterpret_cast<const char *>(v.data());
+            bytes.insert(bytes.end(), p, p + sizeof(T) * v.size());
+        }
+
+        void put(const std::string &s)
+        {
+            put((uint64_t)s.size());
+            bytes.insert(bytes.end(), s.begin(), s.end());
+        }
+
+        template <class T>
+        bool get(T &v)
+        {
+            if (bytes.size() - readAt < sizeof(T))
+                return false;
+            std::memcpy(&v, bytes.data() + readAt, sizeof(T));
+            readAt += sizeof(T);
+            return true;
+        }
+
+        template <class T>
+        bool get(std::vector<T> &v)
+        {
+            uint64_t n = 0;
+            if (!get(n) || n > (bytes.size() - readAt) / sizeof(T))
+                return false;
+            v.resize((size_t)n);
+            if (n > 0)
+                std::memcpy(v.data(), bytes.data() + readAt, sizeof(T) * (size_t)n);
+            readAt += sizeof(T) * (size_t)n;
+            return true;
+        }
+
+        bool get(std::string &s)
+        {
+            uint64_t n = 0;
+            if (!get(n) || n > bytes.size() - readAt)
+                return false;
+            s.assign(bytes.data() + readAt, (size_t)n);
+            readAt += (size_t)n;
+            return true;
+        }
+
+        void clear()
+        {
+            bytes.clear();
+            readAt = 0;
+        }
+
+        std::vector<char> bytes;
+        size_t readAt = 0;
+    };
+
+    // ── CONNECTION ────────────────────────────────────────────────────────
+    // One end of a TCP stream; closes itself, moves but does not copy
+    class connection
+    {
+    public:
+        connection() = default;
+        explicit connection(int fd) : fd(fd) {}
+        connection(const connection &) = delete;
+        connection &operator=(const connection &) = delete;
+        connection(connection &&o) noexcept : sent(o.sent), received(o.received), fd(o.fd) { o.fd = -1; }
+        connection &operator=(connection &&o) noexcept
+        {
+            std::swap(fd, o.fd);
+            std::swap(sent, o.sent);
+            std::swap(received, o.received);
+            return *this;
+        }
+        ~connection() { close(); }
+
+        bool open() const { return fd >= 0; }
+
+        void close()
+        {
+#ifndef _WIN32
+            if (fd >= 0)
+                ::close(fd);
+#endif
+            fd = -1;
+        }
+
+        bool send(kind k, const message &m, std::string &err)
+        {
+            frame f{(uint32_t)k, 0, (uint64_t)m.bytes.size()};
+            return write(&f, sizeof(f), err) && write(m.bytes.data(), m.bytes.size(), err);
+        }
+
+        // Next message, which must be of kind `expected`
+        bool expect(kind expected, message &m, std::string &err)
+        {
+            kind k;
+            return receive(k, m, err) && (k == expected || fail(err, "unexpected message " + std::to_string(k)));
+        }
+
+        bool receive(kind &k, message &m, std::string &err)
+        {
+            frame f;
+            if (!read(&f, sizeof(f), err))
+                return false;
+            if (f.bytes > MAX_MESSAGE)
+                return fail(err, "oversized message");
+            k = (kind)f.kind;
+            m.clear();
+            m.bytes.resize((size_t)f.bytes);
+            return read(m.bytes.data(), m.bytes.size(), err);
+        }
+
+        uint64_t sent = 0, received = 0; // bytes, frames included
+
+    private:
+        struct frame
+        {
+            uint32_t kind, pad;
+            uint64_t bytes;
+        };
+
+        static bool fail(std::string &err, const std::string &why)
+        {
+            err = why;
+            return false;
+        }
+
+        bool write(const void *data, size_t n, std::string &err)
+        {
+#ifndef _WIN32
+#ifdef MSG_NOSIGNAL
+            const int flags = MSG_NOSIGNAL; // a dead peer is an error, not SIGPIPE
+#else
+            const int flags = 0;
+#endif
+            const char *p = static_cast<const char *>(data);
+            while (n > 0)
+            {
+                ssize_t k = ::send(fd, p, n, flags);
+                if (k < 0 && errno == EINTR)
+                    continue;
+                if (k <= 0)
+                    return fail(err, std::string("send failed: ") + std::strerror(errno));
+                p += k;
+                n -= (size_t)k;
+                sent += (uint64_t)k;
+            }
+            return true;
+#else
+            (void)data;
+            (void)n;
+            return fail(err, "cluster mode needs POSIX sockets");
+#endif
+        }
+
+        bool read(void *data, size_t n, std::string &err)
+        {
+#ifndef _WIN32
+            char *p = static_cast<char *>(data);
+            while (n > 0)
+            {
+                ssize_t k = ::recv(fd, p, n, 0);
+                if (k < 0 && errno == EINTR)
+                    continue;
+                if (k == 0)
+                    return fail(err, "connection closed by peer");
+                if (k < 0)
+                    return fail(err, std::string("receive failed: ") + std::strerror(errno));
+                p += k;
+                n -= (size_t)k;
+                received += (uint64_t)k;
+            }
+            return true;
+#else
+            (void)data;
+            (void)n;
+            return fail(err, "cluster mode needs POSIX sockets");
+#endif
+        }
+
+        int fd = -1;
+    };
+
+#ifndef _WIN32
+    // Small messages go out at once instead of waiting on Nagle's algorithm
+    inline void tune(int fd)
+    {
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+#ifdef SO_NOSIGPIPE
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+    }
+#endif
+
+    // ── LISTENER ──────────────────────────────────────────────────────────
+    class listener
+    {
+    public:
+        listener() = default;
+        listener(const listener &) = delete;
+        listener &operator=(const listener &) = delete;
+        ~listener() { socket.close(); }
+
+        // Listen on every interface
+        bool open(int port, std::string &err)
+        {
+#ifndef _WIN32
+            int fd = ::socket(AF_INET6, SOCK_STREAM, 0);
+            bool v6 = fd >= 0;
+            if (!v6)
+                fd = ::socket(AF_INET, SOCK_STREAM, 0);
+            if (fd < 0)
+            {
+                err = std::string("cannot create socket: ") + std::strerror(errno);
+                return false;
+            }
+            socket = connection(fd);
+            int one = 1, zero = 0;
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+            int bound;
+            if (v6)
+            {
+                setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &zero, sizeof(zero)); // IPv4 clients too
+                sockaddr_in6 a{};
+                a.sin6_family = AF_INET6;
+                a.sin6_addr = in6addr_any;
+                a.sin6_port = htons((uint16_t)port);
+                bound = ::bind(fd, reinterpret_cast<sockaddr *>(&a), sizeof(a));
+            }
+            else
+            {
+                sockaddr_in a{};
+                a.sin_family = AF_INET;
+                a.sin_addr.s_addr = htonl(INADDR_ANY);
+                a.sin_port = htons((uint16_t)port);
+                bound = ::bind(fd, reinterpret_cast<sockaddr *>(&a), sizeof(a));
+            }
+            if (bound != 0 || ::listen(fd, 64) != 0)
+            {
+                err = "cannot listen on port " + std::to_string(port) + ": " + std::strerror(errno);
+                socket.close();
+                return false;
+            }
+            listening = fd;
+            return true;
+#else
+            (void)port;
+            err = "cluster mode needs POSIX sockets";
+            return false;
+#endif
+        }
+
+        bool accept(connection &into, std::string &err)
+        {
+#ifndef _WIN32
+            int fd;
+            do
+                fd = ::accept(listening, nullptr, nullptr);
+            while (fd < 0 && errno == EINTR);
+            if (fd < 0)
+            {
+                err = std::string("accept failed: ") + std::strerror(errno);
+                return false;
+            }
+            tune(fd);
+            into = connection(fd);
+            return true;
+#else
+            (void)into;
+            err = "cluster mode needs POSIX sockets";
+            return false;
+#endif
+        }
+
+    private:
+        connection socket;
+        int listening = -1;
+    };
+
+    // ── CONNECT ───────────────────────────────────────────────────────────
+    // "host:port" (IPv6 literals as [::1]:port)
+    inline bool connect(const std::string &address, connection &into, std::string &err)
+    {
+        size_t colon = address.rfind(':');
+        if (colon == std::string::npos || colon == 0 || colon + 1 == address.size())
+        {
+            err = "expected host:port, got " + address;
+            return false;
+        }
+        std::string host = address.substr(0, colon), port = address.substr(colon + 1);
+        if (host.size() > 2 && host.front() == '[' && host.back() == ']')
+            host = host.substr(1, host.size() - 2);
+#ifndef _WIN32
+        addrinfo hints{}, *found = nullptr;
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        int rc = getaddrinfo(host.c_str(), port.c_str(), &hints, &found);
+        if (rc != 0)
+        {
+            err = "cannot resolve " + address + ": " + gai_strerror(rc);
+            return false;
+        }
+        err = "cannot connect to " + address;
+        for (addrinfo *a = found; a; a = a->ai_next)
+        {
+            int fd = ::socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+            if (fd < 0)
+                continue;
+            if (::connect(fd, a->ai_addr, a->ai_addrlen) == 0)
+            {
+                tune(fd);
+                into = connection(fd);
+                freeaddrinfo(found);
+                err.clear();
+                return true;
+            }
+            err = "cannot connect to " + address + ": " + std::strerror(errno);
+            ::close(fd);
+        }
+        freeaddrinfo(found);
+        return false;
+#else
+        (void)into;
+        err = "cluster mode needs POSIX sockets";
+        return false;
+#endif
+    }
+}
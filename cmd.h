@@ -25,6 +25,7 @@ struct Command
     ParamValue assignmentValue;     // Value being assigned
     bool valid = false;
     std::string errorMessage;
+    int handler = -1; // cmdExec dispatch slot, resolved once by cmdExec::prepare
 };
 
 struct CommandInfo
@@ -99,8 +100,36 @@ public:
 
             {"pass_day(n)", "Advance simulation by N days", {{"n", "Number of days"}}},
             {"pass_day", "Advance simulation by one day", {}},
+            {"fast_forward(n, tol)", "Advance N days, approximating days once prices move less than tol", {{"n", "Number of days"}, {"tol", "Relative price tolerance (default 0.001)"}}},
+            {"fast_forward(n)", "Advance N days, approximating calm stretches", {{"n", "Number of days"}}},
+            {"run(n)", "Advance N days in the background; status shows the latest day", {{"n", "Number of days"}}},
+            {"stop", "Stop a background run after its current day", {}},
+            {"threads(n)", "Set agent update threads (0 = all cores)", {{"n", "Thread count"}}},
+            {"threads", "Show agent update thread count", {}},
+            {"clearing(mode, tol, iters)", "Clear markets jointly (ge) with a solver tolerance and iteration budget", {{"mode", "ge"}, {"tol", "Largest relative excess demand (default 1e-6)"}, {"iters", "Iterations per clearing (default 50)"}}},
+            {"clearing(mode)", "Clear markets by aggregate curves, per-agent order books or general equilibrium", {{"mode", "curves | orders | ge"}}},
+            {"clearing", "Show the clearing mode and each market's order book", {}},
             {"set_income(value)", "Set selected consumer's daily income", {{"value", "Daily income in Tk"}}},
             {"status", "Show economic statistics", {}},
+            {"profile", "Show time spent in each pass_day phase", {}},
+            {"profile_dump(path)", "Write phase timings as JSON (stdout if no path)", {{"path", "Output file"}}},
+            {"profile_dump", "Print phase timings as JSON", {}},
+            {"profile_reset", "Reset phase timers", {}},
+            {"fork(name)", "Fork the active world into a named what-if branch", {{"name", "Branch name"}}},
+            {"checkout(name)", "Switch the active world to a branch", {{"name", "Branch name"}}},
+            {"branches", "Compare stats across all branches", {}},
+            {"pass_all(n)", "Advance every branch by N days", {{"n", "Number of days"}}},
+            {"pass_all", "Advance every branch by one day", {}},
+            {"drop_branch(name)", "Delete a branch", {{"name", "Branch name"}}},
+            {"regions(n)", "Split the active world into N trading regions", {{"n", "Number of regions"}}},
+            {"regions", "Show every region and inter-region trade", {}},
+            {"pass_regions(n)", "Advance every region by N days, trading between days", {{"n", "Number of days"}}},
+            {"pass_regions", "Advance every region by one day", {}},
+            {"record(path)", "Stream daily stats and market series to a CSV file", {{"path", "Output file"}}},
+            {"record_bin(path)", "Stream daily series to a binary columnar file", {{"path", "Output file"}}},
+            {"record_stop", "Flush and close the series file", {}},
+            {"save(path)", "Write the world to a binary snapshot", {{"path", "Snapshot file"}}},
+            {"load(path)", "Replace the world with a saved snapshot", {{"path", "Snapshot file"}}},
             {"help", "Show available commands", {}},
             {"clear", "Clear screen", {}},
             {"exit", "Exit simulation", {}}};
@@ -5,15 +5,10 @@
 #include <algorithm>
 #include <map>
 #include <cmath>
+#include <limits>
 
 #include "product.h"
-
-// demand curve: p = c - mQ
-struct demandLine
-{
-    double m;
-    double c;
-};
+#include "agentstore.h"
 
 class consumer
 {
@@ -22,26 +17,50 @@ public:
     std::string name;
     int ageInDays;
     bool isAlive;
-    double savings;
-    double expenses;
-    double incomePerDay; // Budget per day
+    double savings = 0.0;
+    double expenses = 0.0;
+    double incomePerDay = 0.0; // Budget per day
 
     double muPerTk = getMUperTk();
-    std::vector<product> needs; // goods needed (n)
+    double muSavings = std::numeric_limits<double>::quiet_NaN(); // inputs muPerTk was computed from
+    double muIncome = std::numeric_limits<double>::quiet_NaN();
+    std::vector<needRef> needs; // goods needed (n), by product id
+
+    // Demand lines, consumption and substitution ratios live in the world's
+    // demandStore: this agent owns one row, with a cell in the column of each
+    // product in needs.
+    demandStore *store = nullptr;
+    int row = -1;
+
+    int col(const product *prod) const { return store ? store->column(prod) : -1; }
+
+    bool demands(const product *prod) const
+    {
+        int k = col(prod);
+        return k >= 0 && row >= 0 && store->demands(k, row);
+    }
 
-    //              ╭ pointer to the same stored products
-    std::map<product *, demandLine> dd; // Map product pointer to demand line
-    std::map<product *, double> substitutionRatios;
-    std::map<product *, double> consumed;
+    demandLine demandOf(const product *prod) const
+    {
+        int k = col(prod);
+        if (k < 0 || row < 0)
+            return {0.0, 0.0};
+        return store->line(k, row);
+    }
 
-    // dd and consumed are keyed by global product pointers (e.g. &rice).
-    // needs stores copies, so &need != &rice. This helper finds the real key by name.
-    product *findKey(const std::string &name)
+    void setDemand(const product *prod, demandLine line)
     {
-        for (auto &[ptr, line] : dd)
-            if (ptr && ptr->name == name)
-                return ptr;
-        return nullptr;
+        int k = col(prod);
+        if (k >= 0 && row >= 0)
+            store->setLine(k, row, line);
+    }
+
+    double consumedOf(const product *prod) const
+    {
+        int k = col(prod);
+        if (k < 0 || row < 0)
+            return 0.0;
+        return store->consumed(k, row);
     }
 
     consumer(int id, const std::string &name, int ageInYears) : id(id), name(name), ageInDays(ageInYears * 365)
@@ -49,6 +68,19 @@ public:
         isAlive = true;
     }
 
+    // muPerTk, recomputed only when savings or income moved since the last
+    // refresh (the cache key starts as NaN, so the first call computes)
+    double currentMUperTk()
+    {
+        if (savings != muSavings || incomePerDay != muIncome)
+        {
+            muSavings = savings;
+            muIncome = incomePerDay;
+            muPerTk = getMUperTk();
+        }
+        return muPerTk;
+    }
+
     double getMUperTk()
     {
         double wealth = savings + (incomePerDay * 30); // consider 30 days of income as part of wealth
@@ -57,13 +89,15 @@ public:
         return 1.0 / wealth; // inverse relationship between wealth and MU per Tk
     }
 
-    double getMarginalUtility(product product)
+    double getMarginalUtility(const product *prod) const
     { // wtp * muPerTk // wtp = p (Willingness To Pay)
-        double wtp = dd[&product].c - (dd[&product].m * consumed[&product]);
+        demandLine line = demandOf(prod);
+        double wtp = line.c - (line.m * consumedOf(prod));
         return wtp * muPerTk;
     }
 
-    virtual void pass_day(double gdpPerCapita, const std::map<std::string, double> &prices = {})
+    // prices is indexed by product id; 0 means the product has no market
+    virtual void pass_day(double gdpPerCapita, const std::vector<double> &prices = {})
     {
         double oldIncome = incomePerDay;
 
@@ -72,32 +106,37 @@ public:
 
         // Calculate consumption and expenses
         expenses = 0.0;
-        for (auto &need : needs)
+        for (needRef &n : needs)
         {
-            // dd and consumed are keyed by global pointers (e.g. &rice), not &need.
-            // findKey() matches by product name to get the correct key.
-            product *key = findKey(need.name);
-            if (!key)
+            int k = n.id;
+            int at = store ? store->locate(k, row, n.at) : -1;
+            if (at < 0)
+                continue;
+            demandCell &cell = store->cellAt(k, at);
+            if (cell.m <= 0.0)
                 continue;
+            const product &need = *catalogue().get(k);
 
-            // Calculate how much to consume (uses the correct key into dd)
-            double consumeAmount = consumptionRate(need, gdpPerCapita, key);
-            consumed[key] += consumeAmount;
+            // Calculate how much to consume: today's matched fill when the
+            // world clears by order book, otherwise the consumption rule
+            double consumeAmount = store->matching() ? cell.filled
+                                                     : consumptionRate(need, gdpPerCapita, cell.c);
+            double &qty = cell.consumed;
+            qty += consumeAmount;
 
             // Use actual market price if provided, otherwise fall back to WTP
             double price;
-            auto it = prices.find(need.name);
-            if (it != prices.end() && it->second > 0.01)
-                price = it->second;
+            if (k < (int)prices.size() && prices[k] > 0.01)
+                price = prices[k];
             else
-                price = std::max(0.01, dd[key].c - dd[key].m * consumed[key]);
+                price = std::max(0.01, cell.c - cell.m * qty);
 
             expenses += price * consumeAmount;
 
             // Decay previously consumed amount
-            consumed[key] -= need.decayRate;
-            if (consumed[key] < 0.0)
-                consumed[key] = 0.0;
+            qty -= need.decayRate;
+            if (qty < 0.0)
+                qty = 0.0;
         }
 
         // Update finances
@@ -111,34 +150,47 @@ public:
         }
 
         // Update MU per Tk based on new wealth
-        muPerTk = getMUperTk();
+        currentMUperTk();
 
-        // Update substitution ratios
-        for (auto &need : needs)
+        // Update substitution ratios; MU of the rice numeraire is shared by
+        // every need, so it is computed once
+        double muRice = getMarginalUtility(&rice);
+        for (needRef &n : needs)
         {
-            product *key = findKey(need.name);
-            if (key)
-                substitutionRatios[key] = updateSubRatio(need);
+            int at = store ? store->locate(n.id, row, n.at) : -1;
+            if (at < 0)
+                continue;
+            demandCell &cell = store->cellAt(n.id, at);
+            if (cell.m > 0.0)
+                cell.sub = (cell.c - cell.m * cell.consumed) * muPerTk / muRice;
         }
     }
 
-    double consumerSurplus(product product, double marketPrice)
+    double consumerSurplus(const product *prod, double marketPrice) const
     {
-        return .5 * (dd[&product].c - marketPrice) * consumed[&product]; // .5 * c * quantity consumer
+        return .5 * (demandOf(prod).c - marketPrice) * consumedOf(prod); // .5 * c * quantity consumer
     }
 
-    void die()
+    virtual void die()
     {
         isAlive = false;
         needs.clear();
+        if (store && row >= 0)
+            store->releaseRow(row);
+        row = -1;
+    }
+    double updateSubRatio(const product *prod) const
+    {
+        return getMarginalUtility(prod) / getMarginalUtility(&rice);
     }
-    double updateSubRatio(product product)
+
+    double consumptionRate(const product &prod, double gdpPerCapita) const
     {
-        return getMarginalUtility(product) / getMarginalUtility(rice);
+        return consumptionRate(prod, gdpPerCapita, demands(&prod) ? demandOf(&prod).c : 0.0);
     }
 
-    // key must be the global product pointer (from findKey), not a local copy's address
-    double consumptionRate(const product &prod, double gdpPerCapita, product *key)
+    // c: the intercept of this agent's line for prod, 0 if it has none
+    double consumptionRate(const product &prod, double gdpPerCapita, double c) const
     {
         double wealth = savings + incomePerDay * 365;
         double wealthRatio = wealth / std::max(1.0, gdpPerCapita);
@@ -147,45 +199,51 @@ public:
         double baseRate = prod.baseConsumption * std::pow(wealthRatio, prod.eta);
 
         // Budget constraint: can't spend more than 30% of daily income on one good
-        double intercept = (dd.count(key) && dd[key].c > 0.01) ? dd[key].c : 1.0;
+        double intercept = c > 0.01 ? c : 1.0;
         double maxAffordable = (incomePerDay * 0.3) / intercept;
 
         return std::min(baseRate, maxAffordable);
     }
 
     // Update demand curve based on price changes (substitution effect)
-    void updateDemandForPriceChange(product *prod, double newPrice)
+    void updateDemandForPriceChange(needRef &need, double newPrice)
     {
-        if (dd.find(prod) != dd.end())
+        int k = need.id;
+        int at = store ? store->locate(k, row, need.at) : -1;
+        if (at < 0 || store->cellAt(k, at).m <= 0.0)
+            return;
+
+        // Price increase reduces willingness to pay ceiling
+        double c = store->cellAt(k, at).c;
+        double priceShock = newPrice / std::max(0.1, c);
+        if (priceShock > 1.2) // Significant price increase
         {
-            // Price increase reduces willingness to pay ceiling
-            double priceShock = newPrice / std::max(0.1, dd[prod].c);
-            if (priceShock > 1.2) // Significant price increase
-            {
-                dd[prod].c *= 0.95; // Reduce reservation price
-            }
+            store->setInterceptAt(k, at, c * 0.95); // Reduce reservation price
         }
     }
 
     // Shift demand curve based on income change
     void updateDemandForIncomeChange(double incomeChange)
     {
-        for (auto &need : needs)
+        for (const needRef &n : needs)
         {
-            if (dd.find(&need) != dd.end())
+            const product &need = *catalogue().get(n.id);
+            if (!demands(&need))
+                continue;
+
+            double c = demandOf(&need).c;
+            // Normal goods: demand increases with income
+            if (need.eta > 0)
+            {
+                c += incomeChange * 0.05 * need.eta;
+            }
+            // Inferior goods: demand decreases with income
+            else if (need.eta < 0)
             {
-                // Normal goods: demand increases with income
-                if (need.eta > 0)
-                {
-                    dd[&need].c += incomeChange * 0.05 * need.eta;
-                }
-                // Inferior goods: demand decreases with income
-                else if (need.eta < 0)
-                {
-                    dd[&need].c += incomeChange * 0.02 * need.eta;
-                    dd[&need].c = std::max(0.5, dd[&need].c); // Floor
-                }
+                c += incomeChange * 0.02 * need.eta;
+                c = std::max(0.5, c); // Floor
             }
+            store->setIntercept(n.id, row, c);
         }
     }
 
@@ -201,12 +259,13 @@ public:
         ss << KeyValue("MU per Tk", std::to_string(twoDecimal(muPerTk))) << "\n\n";
 
         ss << Styled("CONSUMPTION:\n", Theme::Primary);
-        for (const auto &need : needs)
+        for (const needRef &n : needs)
         {
-            if (consumed.find(const_cast<product *>(&need)) != consumed.end())
+            const product &need = *catalogue().get(n.id);
+            if (demands(&need))
             {
                 ss << "  • " << need.name << ": "
-                   << twoDecimal(consumed.at(const_cast<product *>(&need))) << " units\n";
+                   << twoDecimal(consumedOf(&need)) << " units\n";
             }
         }
 
@@ -0,0 +1,67 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+
+// Copy-on-write array: copies share one buffer until either side writes.
+//
+// Reads go through operator[] / read() and never copy. write() / mut() give
+// the caller a private buffer first, cloning it if another copy still shares
+// it. A clone swaps the buffer pointer, so a thread must not read through a
+// reference obtained before another thread's first write to the same array;
+// callers that write from several threads detach() first (see world::fork).
+template <class T>
+class cowVector
+{
+public:
+    cowVector() : items(std::make_shared<std::vector<T>>()) {}
+    cowVector(size_t n, const T &value) : items(std::make_shared<std::vector<T>>(n, value)) {}
+
+    // Copies share the buffer; both sides copy before their next write
+    cowVector(const cowVector &o) : items(o.items), owned(false) { o.owned.store(false, std::memory_order_relaxed); }
+    cowVector(cowVector &&o) noexcept : items(std::move(o.items)), owned(o.owned.load(std::memory_order_relaxed)) {}
+    cowVector &operator=(const cowVector &o)
+    {
+        if (this != &o)
+        {
+            items = o.items;
+            owned.store(false, std::memory_order_relaxed);
+            o.owned.store(false, std::memory_order_relaxed);
+        }
+        return *this;
+    }
+
+    size_t size() const { return items->size(); }
+    const T &operator[](size_t i) const { return (*items)[i]; }
+    const std::vector<T> &read() const { return *items; }
+
+    std::vector<T> &write()
+    {
+        if (!owned.load(std::memory_order_acquire))
+            unshare();
+        return *items;
+    }
+
+    T &mut(size_t i) { return write()[i]; }
+
+    // Take a private buffer now, so later writes never swap the pointer
+    void detach() { write(); }
+
+    bool shared() const { return items.use_count() > 1; }
+
+private:
+    void unshare()
+    {
+        static std::mutex m; // only taken on the first write after a copy
+        std::lock_guard<std::mutex> lk(m);
+        if (owned.load(std::memory_order_relaxed))
+            return;
+        if (items.use_count() > 1)
+            items = std::make_shared<std::vector<T>>(*items);
+        owned.store(true, std::memory_order_release);
+    }
+
+    std::shared_ptr<std::vector<T>> items;
+    mutable std::atomic<bool> owned{true};
+};
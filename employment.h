@@ -0,0 +1,128 @@
+#pragma once
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <cmath>
+#include "laborer.h"
+
+// Who works where, plus a pool of unemployed laborers ordered for hiring.
+//
+// The pool is bucketed by minimum wage (WAGE_BUCKET Tk wide) and each bucket is
+// ordered by skill, so "most skilled laborer who accepts wage w" looks at the
+// top of each affordable bucket and only walks the one bucket straddling w.
+// Hire, fire and lookup are logarithmic in the number of laborers.
+class employmentIndex
+{
+public:
+    static constexpr double WAGE_BUCKET = 50.0;
+
+    void clear()
+    {
+        records.clear();
+        pool.clear();
+    }
+
+    // Track a laborer; starts unemployed
+    void add(const laborer &l)
+    {
+        remove(l.id);
+        records[l.id] = {l.skillLevel, l.minWage, -1};
+        pool[bucketOf(l.minWage)].insert({l.skillLevel, l.id});
+    }
+
+    // Forget a laborer entirely (death / removal)
+    void remove(int laborerId)
+    {
+        auto it = records.find(laborerId);
+        if (it == records.end())
+            return;
+        if (it->second.employer < 0)
+            leavePool(laborerId, it->second);
+        records.erase(it);
+    }
+
+    bool tracks(int laborerId) const { return records.count(laborerId) > 0; }
+
+    // Firm index in world::firms, -1 if unemployed or unknown
+    int employerOf(int laborerId) const
+    {
+        auto it = records.find(laborerId);
+        return it == records.end() ? -1 : it->second.employer;
+    }
+
+    void setEmployer(int laborerId, int firmIndex)
+    {
+        auto it = records.find(laborerId);
+        if (it == records.end())
+            return;
+        record &r = it->second;
+        if (r.employer < 0 && firmIndex >= 0)
+            leavePool(laborerId, r);
+        else if (r.employer >= 0 && firmIndex < 0)
+            pool[bucketOf(r.minWage)].insert({r.skill, laborerId});
+        r.employer = firmIndex;
+    }
+
+    // Most skilled unemployed laborer whose minWage <= wage; ties go to the
+    // lowest id. -1 if nobody will take the job.
+    int bestCandidate(double wage) const
+    {
+        int limit = bucketOf(wage);
+        const entry *best = nullptr;
+        for (auto b = pool.begin(); b != pool.end() && b->first <= limit; ++b)
+        {
+            for (const entry &e : b->second)
+            {
+                if (best && !(e < *best))
+                    break; // bucket is skill-ordered: nothing better below
+                if (b->first == limit && records.at(e.id).minWage > wage)
+                    continue;
+                best = &e;
+                break;
+            }
+        }
+        return best ? best->id : -1;
+    }
+
+    int unemployed() const
+    {
+        int n = 0;
+        for (auto &[bucket, entries] : pool)
+            n += (int)entries.size();
+        return n;
+    }
+
+private:
+    struct record
+    {
+        double skill;
+        double minWage;
+        int employer; // firm index, -1 = unemployed
+    };
+
+    // Ordered by skill descending, then id ascending
+    struct entry
+    {
+        double skill;
+        int id;
+        bool operator<(const entry &o) const
+        {
+            return skill != o.skill ? skill > o.skill : id < o.id;
+        }
+    };
+
+    static int bucketOf(double wage) { return (int)std::floor(wage / WAGE_BUCKET); }
+
+    void leavePool(int laborerId, const record &r)
+    {
+        auto b = pool.find(bucketOf(r.minWage));
+        if (b == pool.end())
+            return;
+        b->second.erase({r.skill, laborerId});
+        if (b->second.empty())
+            pool.erase(b);
+    }
+
+    std::unordered_map<int, record> records;
+    std::map<int, std::set<entry>> pool; // wage bucket -> unemployed by skill
+};
@@ -0,0 +1,307 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include "markettable.h"
+
+// Joint clearing of every market (general equilibrium).
+//
+// marketTable::solve crosses each market's summed lines on their own. Here the
+// caller supplies demandAt(prices, quantities), each market's demand when all
+// prices are set at once. In the world that demand is budget constrained, so
+// a dearer good leaves less money for the others (world::jointDemand). The
+// solver then searches for the price vector at which every market clears:
+//
+//   z(p) = D(p) - S(p),   S_i(p) = max(0, (p_i - supplyC_i) / supplyM_i)
+//
+// with quasi-Newton steps. The Jacobian starts from the summed lines' own-price
+// slopes (-1/demandM - 1/supplyM) and takes a Broyden update after every step,
+// so cross-market effects enter from the demand evaluations alone. The
+// Jacobian is kept for the next solve while the set of markets is unchanged,
+// so a calm day starts from yesterday's estimate. Each step is projected onto
+// the price bounds and halved until the sum of squared residuals falls.
+//
+// Market i's residual is |z_i| / max(1, D_i, S_i) with D and S taken at the
+// start prices, so one tolerance fits any population and a market with no
+// supply (or no demand) at its start price still shows progress as the price
+// moves. A market pinned at a bound with its excess pointing out of the box
+// counts as cleared.
+//
+// Only markets where both curves are non-trivial are solved; the others keep
+// what marketTable::solve gives them. solved(i) is true for the markets that
+// ended within tolerance; tâtonnement moves the prices of all the others.
+// Prices start from the table's prices on entry (yesterday's, or today's
+// earlier clearing), so a calm day converges in a step or two. Scratch space
+// is kept between solves, so a warmed-up solve does not allocate.
+class equilibriumSolver
+{
+public:
+    static constexpr double MIN_PRICE = 0.5, MAX_PRICE = 1000.0; // market::adjustPrice's bounds
+
+    double tolerance = 1e-6; // largest relative excess demand accepted
+    int maxIterations = 50;  // Newton steps per solve
+
+    struct report
+    {
+        int iterations = 0;  // steps taken
+        int evaluations = 0; // demandAt calls
+        double residual = 0.0;
+        bool converged = true;
+    };
+    report last;
+
+    // Running totals since the last resetTotals()
+    long long solves = 0, iterations = 0, evaluations = 0, unconverged = 0;
+
+    void resetTotals() { solves = iterations = evaluations = unconverged = 0; }
+
+    // Slot i was cleared (within tolerance) by the last solve
+    bool solved(size_t i) const { return i < cleared.size() && cleared[i]; }
+
+    // ── WARM START ────────────────────────────────────────────────────────
+    // What one solve hands the next: which slots were solved jointly, which
+    // cleared, and the Jacobian over the solved slots. Saved with the world
+    // (see snapshot.h) so a loaded run starts its next solve where the
+    // uninterrupted one would.
+    const std::vector<char> &liveSlots() const { return live; }
+    const std::vector<char> &clearedSlots() const { return cleared; }
+    const std::vector<double> &jacobianMatrix() const { return jacobian; }
+
+    // false (and nothing changed) unless the sizes fit together: one flag per
+    // slot in each list and a k x k Jacobian for the k live slots, or none
+    bool restore(std::vector<char> liveIn, std::vector<char> clearedIn, std::vector<double> jacobianIn)
+    {
+        size_t k = (size_t)std::count_if(liveIn.begin(), liveIn.end(), [](char c)
+                                         { return c != 0; });
+        if (!clearedIn.empty() && clearedIn.size() != liveIn.size())
+            return false;
+        if (!jacobianIn.empty() && jacobianIn.size() != k * k)
+            return false;
+        live = std::move(liveIn);
+        cleared = std::move(clearedIn);
+        jacobian = std::move(jacobianIn);
+        return true;
+    }
+
+    // Clear every market of t. demandAt(const std::vector<double> &prices,
+    // std::vector<double> &quantities) fills one quantity per slot.
+    template <class Demand>
+    void solve(marketTable &t, Demand demandAt)
+    {
+        size_t n = t.size();
+        start.assign(t.price.begin(), t.price.end());
+        t.solve(); // excluded markets, and a start for never-priced ones
+
+        bool sameSlots = live.size() == n;
+        live.resize(n);
+        cleared.assign(n, 0);
+        slots.clear();
+        for (size_t i = 0; i < n; i++)
+        {
+            char on = t.demandM[i] > EMPTY_CURVE_SLOPE && t.supplyM[i] > EMPTY_CURVE_SLOPE;
+            sameSlots = sameSlots && live[i] == on;
+            live[i] = on;
+            if (on)
+                slots.push_back(i);
+        }
+        last = report{};
+        if (slots.empty())
+            return;
+        size_t k = slots.size();
+
+        // Warm start; excluded markets stay at their price from t.solve()
+        p.assign(t.price.begin(), t.price.end());
+        for (size_t i : slots)
+            p[i] = clamp(start[i] > 0.0 ? start[i] : t.eqPrice[i]);
+
+        if (!sameSlots || jacobian.size() != k * k)
+        {
+            jacobian.assign(k * k, 0.0);
+            for (size_t a = 0; a < k; a++)
+            {
+                size_t i = slots[a];
+                jacobian[a * k + a] = -1.0 / t.demandM[i] - 1.0 / t.supplyM[i];
+            }
+        }
+
+        scale.assign(n, 1.0);
+        evaluate(t, demandAt, p, demand, z);
+        for (size_t i : slots)
+            scale[i] = std::max({1.0, demand[i], supplyAt(t, i, p[i])});
+        double norm = 0.0, r = measure(p, z, norm);
+        int stalls = 0;
+        while (r > tolerance && last.iterations < maxIterations && stalls < 2)
+        {
+            newtonStep(k);
+
+            // Projected step, halved until the squared residuals fall
+            double lambda = 1.0, rTrial = r, normTrial = norm;
+            for (int halvings = 0; halvings < 6; halvings++, lambda *= 0.5)
+            {
+                trial.assign(p.begin(), p.end());
+                for (size_t a = 0; a < k; a++)
+                    trial[slots[a]] = clamp(p[slots[a]] + lambda * step[a]);
+                evaluate(t, demandAt, trial, trialDemand, trialZ);
+                rTrial = measure(trial, trialZ, normTrial);
+                if (normTrial < norm)
+                    break;
+            }
+            last.iterations++;
+
+            // Broyden: B += (dz - B s) s' / (s' s), on the step actually taken
+            double ss = 0.0;
+            for (size_t a = 0; a < k; a++)
+            {
+                s[a] = trial[slots[a]] - p[slots[a]];
+                ss += s[a] * s[a];
+            }
+            if (ss == 0.0)
+                break; // pinned at the bounds
+            for (size_t a = 0; a < k; a++)
+            {
+                double bs = 0.0;
+                for (size_t b = 0; b < k; b++)
+                    bs += jacobian[a * k + b] * s[b];
+                double u = (trialZ[slots[a]] - z[slots[a]] - bs) / ss;
+                for (size_t b = 0; b < k; b++)
+                    jacobian[a * k + b] += u * s[b];
+            }
+
+            if (normTrial >= norm)
+            {
+                stalls++; // no descent: retry once with the updated Jacobian
+                continue;
+            }
+            stalls = 0;
+            p.swap(trial);
+            demand.swap(trialDemand);
+            z.swap(trialZ);
+            r = rTrial;
+            norm = normTrial;
+        }
+
+        last.residual = r;
+        last.converged = r <= tolerance;
+        solves++;
+        iterations += last.iterations;
+        evaluations += last.evaluations;
+        unconverged += !last.converged;
+
+        for (size_t i : slots)
+        {
+            cleared[i] = residualOf(i, p[i], z[i]) <= tolerance;
+            double supplied = supplyAt(t, i, p[i]);
+            t.price[i] = p[i];
+            t.eqPrice[i] = p[i];
+            t.eqQuantity[i] = std::max(0.0, std::min(demand[i], supplied));
+            t.excessDemand[i] = demand[i] - supplied;
+        }
+    }
+
+private:
+    static double clamp(double price) { return std::max(MIN_PRICE, std::min(MAX_PRICE, price)); }
+
+    static double supplyAt(const marketTable &t, size_t i, double price)
+    {
+        return std::max(0.0, (price - t.supplyC[i]) / t.supplyM[i]);
+    }
+
+    // Demand and excess demand at prices q (full slot vector)
+    template <class Demand>
+    void evaluate(const marketTable &t, Demand &demandAt, const std::vector<double> &q,
+                  std::vector<double> &d, std::vector<double> &excess)
+    {
+        d.assign(q.size(), 0.0);
+        excess.assign(q.size(), 0.0);
+        demandAt(q, d);
+        last.evaluations++;
+        for (size_t i : slots)
+            excess[i] = d[i] - supplyAt(t, i, q[i]);
+    }
+
+    // Scaled residual of slot i, 0 when pinned at a bound
+    double residualOf(size_t i, double price, double excess) const
+    {
+        bool pinned = (price <= MIN_PRICE && excess < 0.0) || (price >= MAX_PRICE && excess > 0.0);
+        return pinned ? 0.0 : std::abs(excess) / scale[i];
+    }
+
+    // Largest residual over the live slots; sum of squares into norm
+    double measure(const std::vector<double> &q, const std::vector<double> &excess, double &norm) const
+    {
+        double r = 0.0;
+        norm = 0.0;
+        for (size_t i : slots)
+        {
+            double ri = residualOf(i, q[i], excess[i]);
+            r = std::max(r, ri);
+            norm += ri * ri;
+        }
+        return r;
+    }
+
+    // step = -B⁻¹ z by Gaussian elimination with partial pivoting; a singular
+    // B falls back to the diagonal (one tâtonnement-like step per market)
+    void newtonStep(size_t k)
+    {
+        lu.assign(jacobian.begin(), jacobian.end());
+        step.resize(k);
+        s.resize(k);
+        for (size_t a = 0; a < k; a++)
+            step[a] = -z[slots[a]];
+
+        bool singular = false;
+        for (size_t c = 0; c < k && !singular; c++)
+        {
+            size_t pivot = c;
+            for (size_t a = c + 1; a < k; a++)
+                if (std::abs(lu[a * k + c]) > std::abs(lu[pivot * k + c]))
+                    pivot = a;
+            if (std::abs(lu[pivot * k + c]) < 1e-300)
+            {
+                singular = true;
+                break;
+            }
+            if (pivot != c)
+            {
+                for (size_t b = 0; b < k; b++)
+                    std::swap(lu[c * k + b], lu[pivot * k + b]);
+                std::swap(step[c], step[pivot]);
+            }
+            for (size_t a = c + 1; a < k; a++)
+            {
+                double f = lu[a * k + c] / lu[c * k + c];
+                for (size_t b = c; b < k; b++)
+                    lu[a * k + b] -= f * lu[c * k + b];
+                step[a] -= f * step[c];
+            }
+        }
+        if (!singular)
+        {
+            for (size_t a = k; a-- > 0;)
+            {
+                double v = step[a];
+                for (size_t b = a + 1; b < k; b++)
+                    v -= lu[a * k + b] * step[b];
+                step[a] = v / lu[a * k + a];
+            }
+            return;
+        }
+        for (size_t a = 0; a < k; a++)
+        {
+            double d = jacobian[a * k + a];
+            step[a] = d < 0.0 ? z[slots[a]] / -d : 0.0;
+        }
+    }
+
+    std::vector<char> live;     // per slot: solved jointly
+    std::vector<char> cleared;  // per slot: within tolerance after the solve
+    std::vector<size_t> slots;  // the live slots, in order
+    std::vector<double> start;  // prices on entry
+    std::vector<double> scale;  // per slot: max(1, D, S) at the start prices
+    std::vector<double> p, demand, z;
+    std::vector<double> trial, trialDemand, trialZ;
+    std::vector<double> jacobian, lu, step, s; // k x k row-major, k-vectors
+};
@@ -7,6 +7,10 @@
 #include <type_traits>
 #include <thread>
 #include <chrono>
+#include <fstream>
+#include <map>
+#include <unordered_map>
+#include <atomic>
 
 #include "consumer.h"
 #include "laborer.h"
@@ -14,6 +18,11 @@
 #include "firm.h"
 #include "market.h"
 #include "world.h"
+#include "snapshot.h"
+#include "recorder.h"
+#include "regions.h"
+#include "fastforward.h"
+#include "worldview.h"
 #include "cmd.h"
 #include "style.h"
 
@@ -29,6 +38,7 @@ public:
 
     cmdExec(world &simulation, OutputCallback outputFunc, RefreshHeaderCallback refreshHeaderFunc = {}, int screenWidth = 93)
         : simulation(simulation), outputCallback(outputFunc), refreshHeaderCallback(refreshHeaderFunc), sw(screenWidth) {};
+    ~cmdExec() { stopBackground(); }
 
     // Execute a parsed command
     bool execute(const Command &cmd)
@@ -40,6 +50,15 @@ public:
             return false;
         }
 
+        reapBackground();
+        if (busy() && (cmd.commandType == Command::Type::Assignment || !allowedWhileBusy(cmd.name)))
+        {
+            lastError = "Simulation is running in the background (day " + std::to_string(view().day) +
+                        " of " + std::to_string(background.targetDay) + ")  ·  stop, or wait for it to finish";
+            output("Error: " + lastError);
+            return false;
+        }
+
         try
         {
             // Handle property assignments first
@@ -48,109 +67,14 @@ public:
                 return executeAssignment(cmd);
             }
 
-            if (cmd.name == "consumers")
-                cmdConsumers(cmd);
-            else if (cmd.name == "laborers")
-                cmdLaborers(cmd);
-            else if (cmd.name == "farmers")
-                cmdFarmers(cmd);
-            else if (cmd.name == "firms")
-                cmdFirms(cmd);
-            else if (cmd.name == "markets")
-                cmdMarkets(cmd);
-            else if (cmd.name == "products")
-                cmdProducts(cmd);
-            else if (cmd.name == "add_consumer")
-                cmdAddConsumer(cmd);
-            else if (cmd.name == "add_laborer")
-                cmdAddLaborer(cmd);
-            else if (cmd.name == "add_farmer")
-                cmdAddFarmer(cmd);
-            else if (cmd.name == "add_firm")
-                cmdAddFirm(cmd);
-            else if (cmd.name == "select_consumer")
-                cmdSelectConsumer(cmd);
-            else if (cmd.name == "select_laborer")
-                cmdSelectLaborer(cmd);
-            else if (cmd.name == "select_farmer")
-                cmdSelectFarmer(cmd);
-            else if (cmd.name == "select_market")
-                cmdSelectMarket(cmd);
-            else if (cmd.name == "clear_selection")
-                cmdClearSelection(cmd);
-            else if (cmd.name == "consumer_mu")
-                cmdConsumerMU(cmd);
-            else if (cmd.name == "consumer_surplus")
-                cmdConsumerSurplus(cmd);
-            else if (cmd.name == "consumer_details")
-                simulation.selected_consumer != nullptr ? output(simulation.selected_consumer->getStyledDetails()) : output("No consumer selected");
-            else if (cmd.name == "consumer_substitution")
-                cmdConsumerSubstitution(cmd);
-            else if (cmd.name == "consumer_needs")
-                cmdConsumerNeeds(cmd);
-            else if (cmd.name == "consumer_demand_curve")
-                cmdConsumerDemandCurve(cmd);
-            else if (cmd.name == "kill_consumer")
-                cmdKillConsumer(cmd);
-            else if (cmd.name == "farmer_supply")
-                cmdFarmerSupply(cmd);
-            else if (cmd.name == "farmer_details")
-                simulation.selected_farmer != nullptr ? output(simulation.selected_farmer->getStyledDetails()) : output("No farmer selected");
-            else if (cmd.name == "farmer_crops")
-                cmdFarmerCrops(cmd);
-            else if (cmd.name == "farmer_upgrade")
-                cmdFarmerUpgrade(cmd);
-            else if (cmd.name == "farmer_tax")
-                cmdFarmerTax(cmd);
-            else if (cmd.name == "farmer_weather")
-                cmdFarmerWeather(cmd);
-            else if (cmd.name == "kill_farmer")
-                cmdKillFarmer(cmd);
-            else if (cmd.name == "laborer_details")
-                simulation.selected_laborer != nullptr ? output(simulation.selected_laborer->getStyledDetails()) : output("No laborer selected");
-            else if (cmd.name == "kill_laborer")
-                cmdKillLaborer(cmd);
-            else if (cmd.name == "firm_costs")
-                cmdFirmCosts(cmd);
-            else if (cmd.name == "firm_output")
-                cmdFirmOutput(cmd);
-            else if (cmd.name == "firm_mp")
-                cmdFirmMP(cmd);
-            else if (cmd.name == "firm_efficiency")
-                cmdFirmEfficiency(cmd);
-            else if (cmd.name == "firm_details")
-                simulation.selected_firm != nullptr ? output(simulation.selected_firm->getStyledDetails()) : output("No firm selected");
-            else if (cmd.name == "firm_hire")
-                cmdFirmHire(cmd);
-            else if (cmd.name == "firm_fire")
-                cmdFirmFire(cmd);
-            else if (cmd.name == "firm_capital")
-                cmdFirmCapital(cmd);
-            else if (cmd.name == "market_details")
-                simulation.selected_market != nullptr ? output(simulation.selected_market->getStyledDetails()) : output("No market selected");
-            else if (cmd.name == "market_history")
-                cmdMarketHistory(cmd);
-            else if (cmd.name == "pass_day")
-                cmdPassDay(cmd);
-            else if (cmd.name == "set_income")
-                cmdSetIncome(cmd);
-            else if (cmd.name == "status")
-                cmdStatus(cmd);
-            else if (cmd.name == "help")
-                cmdHelp(cmd);
-            else if (cmd.name == "clear")
-                cmdClear();
-            else if (cmd.name == "exit")
-            {
-                output("Exiting simulation...");
-                return true;
-            }
-            else
+            int slot = cmd.handler >= 0 ? cmd.handler : resolve(cmd.name);
+            if (slot < 0)
             {
                 lastError = "Unknown command: " + cmd.name;
                 output("Error: " + lastError);
                 return false;
             }
+            dispatchTable()[slot].second(*this, cmd);
             return true;
         }
         catch (const std::bad_variant_access &e)
@@ -186,6 +110,33 @@ public:
         return execute(cmd);
     }
 
+    // ── DISPATCH ──────────────────────────────────────────────────────────
+    using handler = void (*)(cmdExec &, const Command &);
+
+    // Slot in dispatchTable() for a command name, -1 if unknown. One hash
+    // lookup; pre-parsed scripts store the slot in Command::handler instead.
+    static int resolve(const std::string &name)
+    {
+        static const std::unordered_map<std::string, int> index = []
+        {
+            std::unordered_map<std::string, int> m;
+            const auto &table = dispatchTable();
+            for (size_t i = 0; i < table.size(); i++)
+                m.emplace(table[i].first, (int)i);
+            return m;
+        }();
+        auto it = index.find(name);
+        return it == index.end() ? -1 : it->second;
+    }
+
+    // Resolve every command once so execute() skips the name lookup
+    void prepare(std::vector<Command> &cmds) const
+    {
+        for (auto &c : cmds)
+            if (c.valid && c.commandType == Command::Type::Query)
+                c.handler = resolve(c.name);
+    }
+
     // Set output callback for results
     void setOutputCallback(OutputCallback callback) { outputCallback = callback; }
     void setRefreshHeaderCallback(RefreshHeaderCallback callback) { refreshHeaderCallback = callback; }
@@ -261,12 +212,176 @@ public:
     }
 
     world &simulation;
+    // Interactive pacing (sleeps between animated steps); off for scripts
+    bool animate = true;
+    // Day-by-day series of the active world, while recording
+    seriesRecorder recorder;
+    // Forked what-if worlds by name; the active one lives in `simulation`
+    std::map<std::string, world> branches;
+    std::string activeBranch = "main";
+    // The active world sharded into trading districts, once regions(n) ran
+    regionSet regions;
+    // run(n): the active world stepping on its own thread
+    struct backgroundRun
+    {
+        std::thread worker;
+        std::atomic<bool> stopRequested{false};
+        std::atomic<bool> finished{false};
+        int startDay = 0, targetDay = 0;
+        bool active = false; // started and not yet joined; CLI thread only
+    } background;
+    // Views published by the background run, and the one filled on demand
+    // from the world while nothing runs
+    viewBuffer views;
+    worldView idleView;
     CommandParser parser;
     OutputCallback outputCallback;
     RefreshHeaderCallback refreshHeaderCallback;
     int sw = 93; // screen width — set from cli::screen_width via constructor
     std::string lastError;
 
+    // Command name -> handler, in help order
+    static const std::vector<std::pair<std::string, handler>> &dispatchTable()
+    {
+        static const std::vector<std::pair<std::string, handler>> table = {
+            {"consumers", [](cmdExec &e, const Command &c)
+             { e.cmdConsumers(c); }},
+            {"laborers", [](cmdExec &e, const Command &c)
+             { e.cmdLaborers(c); }},
+            {"farmers", [](cmdExec &e, const Command &c)
+             { e.cmdFarmers(c); }},
+            {"firms", [](cmdExec &e, const Command &c)
+             { e.cmdFirms(c); }},
+            {"markets", [](cmdExec &e, const Command &c)
+             { e.cmdMarkets(c); }},
+            {"products", [](cmdExec &e, const Command &c)
+             { e.cmdProducts(c); }},
+            {"add_consumer", [](cmdExec &e, const Command &c)
+             { e.cmdAddConsumer(c); }},
+            {"add_laborer", [](cmdExec &e, const Command &c)
+             { e.cmdAddLaborer(c); }},
+            {"add_farmer", [](cmdExec &e, const Command &c)
+             { e.cmdAddFarmer(c); }},
+            {"add_firm", [](cmdExec &e, const Command &c)
+             { e.cmdAddFirm(c); }},
+            {"select_consumer", [](cmdExec &e, const Command &c)
+             { e.cmdSelectConsumer(c); }},
+            {"select_laborer", [](cmdExec &e, const Command &c)
+             { e.cmdSelectLaborer(c); }},
+            {"select_farmer", [](cmdExec &e, const Command &c)
+             { e.cmdSelectFarmer(c); }},
+            {"select_market", [](cmdExec &e, const Command &c)
+             { e.cmdSelectMarket(c); }},
+            {"clear_selection", [](cmdExec &e, const Command &c)
+             { e.cmdClearSelection(c); }},
+            {"consumer_mu", [](cmdExec &e, const Command &c)
+             { e.cmdConsumerMU(c); }},
+            {"consumer_surplus", [](cmdExec &e, const Command &c)
+             { e.cmdConsumerSurplus(c); }},
+            {"consumer_details", [](cmdExec &e, const Command &)
+             { e.simulation.GetSelectedConsumer() != nullptr ? e.output(e.simulation.GetSelectedConsumer()->getStyledDetails()) : e.output("No consumer selected"); }},
+            {"consumer_substitution", [](cmdExec &e, const Command &c)
+             { e.cmdConsumerSubstitution(c); }},
+            {"consumer_needs", [](cmdExec &e, const Command &c)
+             { e.cmdConsumerNeeds(c); }},
+            {"consumer_demand_curve", [](cmdExec &e, const Command &c)
+             { e.cmdConsumerDemandCurve(c); }},
+            {"kill_consumer", [](cmdExec &e, const Command &c)
+             { e.cmdKillConsumer(c); }},
+            {"farmer_supply", [](cmdExec &e, const Command &c)
+             { e.cmdFarmerSupply(c); }},
+            {"farmer_details", [](cmdExec &e, const Command &)
+             { e.simulation.GetSelectedFarmer() != nullptr ? e.output(e.simulation.GetSelectedFarmer()->getStyledDetails()) : e.output("No farmer selected"); }},
+            {"farmer_crops", [](cmdExec &e, const Command &c)
+             { e.cmdFarmerCrops(c); }},
+            {"farmer_upgrade", [](cmdExec &e, const Command &c)
+             { e.cmdFarmerUpgrade(c); }},
+            {"farmer_tax", [](cmdExec &e, const Command &c)
+             { e.cmdFarmerTax(c); }},
+            {"farmer_weather", [](cmdExec &e, const Command &c)
+             { e.cmdFarmerWeather(c); }},
+            {"kill_farmer", [](cmdExec &e, const Command &c)
+             { e.cmdKillFarmer(c); }},
+            {"laborer_details", [](cmdExec &e, const Command &)
+             { e.simulation.GetSelectedLaborer() != nullptr ? e.output(e.simulation.GetSelectedLaborer()->getStyledDetails()) : e.output("No laborer selected"); }},
+            {"kill_laborer", [](cmdExec &e, const Command &c)
+             { e.cmdKillLaborer(c); }},
+            {"firm_costs", [](cmdExec &e, const Command &c)
+             { e.cmdFirmCosts(c); }},
+            {"firm_output", [](cmdExec &e, const Command &c)
+             { e.cmdFirmOutput(c); }},
+            {"firm_mp", [](cmdExec &e, const Command &c)
+             { e.cmdFirmMP(c); }},
+            {"firm_efficiency", [](cmdExec &e, const Command &c)
+             { e.cmdFirmEfficiency(c); }},
+            {"firm_details", [](cmdExec &e, const Command &)
+             { e.simulation.selected_firm != nullptr ? e.output(e.simulation.selected_firm->getStyledDetails()) : e.output("No firm selected"); }},
+            {"firm_hire", [](cmdExec &e, const Command &c)
+             { e.cmdFirmHire(c); }},
+            {"firm_fire", [](cmdExec &e, const Command &c)
+             { e.cmdFirmFire(c); }},
+            {"firm_capital", [](cmdExec &e, const Command &c)
+             { e.cmdFirmCapital(c); }},
+            {"market_details", [](cmdExec &e, const Command &)
+             { e.simulation.selected_market != nullptr ? e.output(e.simulation.selected_market->getStyledDetails()) : e.output("No market selected"); }},
+            {"market_history", [](cmdExec &e, const Command &c)
+             { e.cmdMarketHistory(c); }},
+            {"pass_day", [](cmdExec &e, const Command &c)
+             { e.cmdPassDay(c); }},
+            {"fast_forward", [](cmdExec &e, const Command &c)
+             { e.cmdFastForward(c); }},
+            {"run", [](cmdExec &e, const Command &c)
+             { e.cmdRun(c); }},
+            {"stop", [](cmdExec &e, const Command &c)
+             { e.cmdStop(c); }},
+            {"threads", [](cmdExec &e, const Command &c)
+             { e.cmdThreads(c); }},
+            {"clearing", [](cmdExec &e, const Command &c)
+             { e.cmdClearing(c); }},
+            {"set_income", [](cmdExec &e, const Command &c)
+             { e.cmdSetIncome(c); }},
+            {"status", [](cmdExec &e, const Command &c)
+             { e.cmdStatus(c); }},
+            {"profile", [](cmdExec &e, const Command &c)
+             { e.cmdProfile(c); }},
+            {"profile_dump", [](cmdExec &e, const Command &c)
+             { e.cmdProfileDump(c); }},
+            {"profile_reset", [](cmdExec &e, const Command &)
+             { e.simulation.phaseTimes.reset(); e.successNote("Phase timers reset"); }},
+            {"fork", [](cmdExec &e, const Command &c)
+             { e.cmdFork(c); }},
+            {"checkout", [](cmdExec &e, const Command &c)
+             { e.cmdCheckout(c); }},
+            {"branches", [](cmdExec &e, const Command &c)
+             { e.cmdBranches(c); }},
+            {"pass_all", [](cmdExec &e, const Command &c)
+             { e.cmdPassAll(c); }},
+            {"drop_branch", [](cmdExec &e, const Command &c)
+             { e.cmdDropBranch(c); }},
+            {"regions", [](cmdExec &e, const Command &c)
+             { e.cmdRegions(c); }},
+            {"pass_regions", [](cmdExec &e, const Command &c)
+             { e.cmdPassRegions(c); }},
+            {"record", [](cmdExec &e, const Command &c)
+             { e.cmdRecord(c); }},
+            {"record_bin", [](cmdExec &e, const Command &c)
+             { e.cmdRecord(c); }},
+            {"record_stop", [](cmdExec &e, const Command &c)
+             { e.cmdRecordStop(c); }},
+            {"save", [](cmdExec &e, const Command &c)
+             { e.cmdSave(c); }},
+            {"load", [](cmdExec &e, const Command &c)
+             { e.cmdLoad(c); }},
+            {"help", [](cmdExec &e, const Command &c)
+             { e.cmdHelp(c); }},
+            {"clear", [](cmdExec &e, const Command &)
+             { e.cmdClear(); }},
+            {"exit", [](cmdExec &e, const Command &)
+             { e.output("Exiting simulation..."); }},
+        };
+        return table;
+    }
+
     // ── Shared visual helpers ────────────────────────────────────────────────
 
     // Format double to fixed decimal string
@@ -504,7 +619,7 @@ public:
                       << Styled(padStr(ownerName + "'s firm", 18), Theme::Highlight)
                       << Styled("cash ", Theme::Muted) << Styled(padStr("Tk " + fmtD(f.cash), 14), Theme::Highlight)
                       << Styled("workers ", Theme::Muted) << Styled(padStr(std::to_string(f.workers.size()), 4), Theme::Warning)
-                      << Styled("capital ", Theme::Muted) << Styled(padStr(std::to_string(f.capitals.size()), 4), Theme::Warning)
+                      << Styled("capital ", Theme::Muted) << Styled(padStr(std::to_string(f.capitals.count()), 4), Theme::Warning)
                       << Styled("Q ", Theme::Muted) << Styled(fmtD(f.currentOutput), Theme::Secondary)
                       << "\n";
         }
@@ -529,7 +644,7 @@ public:
 
     void cmdProducts(const Command &cmd)
     {
-        std::vector<product *> prods = {&rice, &cloth, &computer, &phone, &car, &steel, &potato, &banana, &corn, &jute};
+        const std::vector<product *> &prods = catalogue().all();
         sH("PRODUCTS", std::to_string(prods.size()) + " goods");
         for (auto *p : prods)
         {
@@ -622,57 +737,39 @@ public:
 
     void cmdKillConsumer(const Command &cmd)
     {
-        if (!simulation.selected_consumer)
+        if (!simulation.GetSelectedConsumer())
         {
             output(Styled("[✗]", Theme::Error) + " No consumer selected");
             return;
         }
-        std::string name = simulation.selected_consumer->name;
-        simulation.selected_consumer->die();
-        simulation.selected_consumer = nullptr;
-        simulation.consumers.erase(
-            std::remove_if(simulation.consumers.begin(), simulation.consumers.end(),
-                           [](const consumer &c)
-                           { return !c.isAlive; }),
-            simulation.consumers.end());
+        std::string name = simulation.GetSelectedConsumer()->name;
+        simulation.removeConsumer(simulation.selected_consumer); // frees its slot, nothing else moves
         requestHeaderRefresh();
         std::cout << "\n  " << Styled("  ✗  " + name + " was killed and removed from simulation", Theme::Error) << "\n\n";
     }
 
     void cmdKillFarmer(const Command &cmd)
     {
-        if (!simulation.selected_farmer)
+        if (!simulation.GetSelectedFarmer())
         {
             output(Styled("[✗]", Theme::Error) + " No farmer selected");
             return;
         }
-        std::string name = simulation.selected_farmer->name;
-        simulation.selected_farmer->die();
-        simulation.selected_farmer = nullptr;
-        simulation.farmers.erase(
-            std::remove_if(simulation.farmers.begin(), simulation.farmers.end(),
-                           [](const farmer &f)
-                           { return !f.isAlive; }),
-            simulation.farmers.end());
+        std::string name = simulation.GetSelectedFarmer()->name;
+        simulation.removeFarmer(simulation.selected_farmer); // frees its slot, nothing else moves
         requestHeaderRefresh();
         std::cout << "\n  " << Styled("  ✗  " + name + " was killed and removed from simulation", Theme::Error) << "\n\n";
     }
 
     void cmdKillLaborer(const Command &cmd)
     {
-        if (!simulation.selected_laborer)
+        if (!simulation.GetSelectedLaborer())
         {
             output(Styled("[✗]", Theme::Error) + " No laborer selected");
             return;
         }
-        std::string name = simulation.selected_laborer->name;
-        simulation.selected_laborer->die();
-        simulation.selected_laborer = nullptr;
-        simulation.laborers.erase(
-            std::remove_if(simulation.laborers.begin(), simulation.laborers.end(),
-                           [](const laborer &l)
-                           { return !l.isAlive; }),
-            simulation.laborers.end());
+        std::string name = simulation.GetSelectedLaborer()->name;
+        simulation.removeLaborer(simulation.selected_laborer); // frees its slot, nothing else moves
         requestHeaderRefresh();
         std::cout << "\n  " << Styled("  ✗  " + name + " was killed and removed from simulation", Theme::Error) << "\n\n";
     }
@@ -687,11 +784,12 @@ public:
             return;
         }
         std::string name = getParam<std::string>(cmd, "name", std::string());
-        for (auto &c : simulation.consumers)
+        auto &consumers = simulation.consumers;
+        for (size_t s = 0; s < consumers.slots(); s++)
         {
-            if (c.name == name)
+            if (consumers.alive(s) && consumers[s].name == name)
             {
-                simulation.selected_consumer = &c;
+                simulation.selected_consumer = consumers.handleAt(s);
                 successNote("Selected consumer  →  " + name);
                 return;
             }
@@ -707,11 +805,12 @@ public:
             return;
         }
         std::string name = getParam<std::string>(cmd, "name", std::string());
-        for (auto &l : simulation.laborers)
+        auto &laborers = simulation.laborers;
+        for (size_t s = 0; s < laborers.slots(); s++)
         {
-            if (l.name == name)
+            if (laborers.alive(s) && laborers[s].name == name)
             {
-                simulation.selected_laborer = &l;
+                simulation.selected_laborer = laborers.handleAt(s);
                 successNote("Selected laborer  →  " + name);
                 return;
             }
@@ -727,11 +826,12 @@ public:
             return;
         }
         std::string name = getParam<std::string>(cmd, "name", std::string());
-        for (auto &f : simulation.farmers)
+        auto &farmers = simulation.farmers;
+        for (size_t s = 0; s < farmers.slots(); s++)
         {
-            if (f.name == name)
+            if (farmers.alive(s) && farmers[s].name == name)
             {
-                simulation.selected_farmer = &f;
+                simulation.selected_farmer = farmers.handleAt(s);
                 successNote("Selected farmer  →  " + name);
                 return;
             }
@@ -761,9 +861,9 @@ public:
 
     void cmdClearSelection(const Command &cmd)
     {
-        simulation.selected_consumer = nullptr;
-        simulation.selected_laborer = nullptr;
-        simulation.selected_farmer = nullptr;
+        simulation.selected_consumer = {};
+        simulation.selected_laborer = {};
+        simulation.selected_farmer = {};
         simulation.selected_market = nullptr;
         successNote("All selections cleared");
     }
@@ -779,8 +879,8 @@ public:
             return;
         }
 
-        m->calculateAggregateDemand(simulation.consumers, simulation.farmers, simulation.laborers);
-        m->calculateAggregateSupply(simulation.farmers);
+        m->calculateAggregateDemand(simulation.demand);
+        m->calculateAggregateSupply(simulation.supply, simulation.firms);
         auto eq = m->findEquilibrium();
         m->price = eq.price;
 
@@ -803,7 +903,7 @@ public:
             return;
         }
 
-        m->calculateAggregateDemand(simulation.consumers, simulation.farmers, simulation.laborers);
+        m->calculateAggregateDemand(simulation.demand);
 
         sH("AGGREGATE DEMAND", m->prod->name);
         eqRow("Aggregate curve", "P = " + fmtD(m->aggregateDemand.c) + " − " + fmtD(m->aggregateDemand.m) + "Q");
@@ -812,11 +912,11 @@ public:
 
         auto printDemandCurve = [&](const std::string &label, const consumer &agent)
         {
-            auto it = agent.dd.find(m->prod);
-            if (it != agent.dd.end())
+            if (agent.demands(m->prod))
             {
+                demandLine line = agent.demandOf(m->prod);
                 std::cout << "      " << Styled(padStr(label, 18), Theme::Warning)
-                          << Styled("P = " + fmtD(it->second.c) + " − " + fmtD(it->second.m) + "Q",
+                          << Styled("P = " + fmtD(line.c) + " − " + fmtD(line.m) + "Q",
                                     Theme::Secondary)
                           << "\n";
             }
@@ -848,7 +948,7 @@ public:
             return;
         }
 
-        m->calculateAggregateSupply(simulation.farmers);
+        m->calculateAggregateSupply(simulation.supply, simulation.firms);
 
         sH("AGGREGATE SUPPLY", m->prod->name);
         eqRow("Aggregate curve", "P = " + fmtD(m->aggregateSupply.c) + " + " + fmtD(m->aggregateSupply.m) + "Q");
@@ -856,11 +956,12 @@ public:
         noteText("Individual supply curves:");
         for (auto &f : simulation.farmers)
         {
-            if (f.ss.find(m->prod) != f.ss.end())
+            int ci = f.cropIndex(m->prod);
+            if (ci >= 0)
             {
                 std::cout << "      " << Styled(padStr(f.name, 14), Theme::Warning)
-                          << Styled("P = " + fmtD(f.ss[m->prod].c) + " + " + fmtD(f.ss[m->prod].m) + "Q", Theme::Secondary)
-                          << "  " << Styled("max " + fmtD(f.maxOutput[m->prod]) + " u", Theme::Muted)
+                          << Styled("P = " + fmtD(f.ss[ci].c) + " + " + fmtD(f.ss[ci].m) + "Q", Theme::Secondary)
+                          << "  " << Styled("max " + fmtD(f.maxOutput[ci]) + " u", Theme::Muted)
                           << "\n";
             }
         }
@@ -871,7 +972,7 @@ public:
 
     void cmdConsumerMU(const Command &cmd)
     {
-        consumer *c = simulation.selected_consumer;
+        consumer *c = simulation.GetSelectedConsumer();
         if (!c)
         {
             output(Styled("[✗]", Theme::Error) + " No consumer selected");
@@ -891,14 +992,15 @@ public:
             return;
         }
 
-        double mu = c->getMarginalUtility(*p);
-        double muPerTk = c->getMUperTk();
-        double wtp = c->dd[p].c - c->dd[p].m * c->consumed[p];
+        double mu = c->getMarginalUtility(p);
+        double muPerTk = c->currentMUperTk();
+        demandLine line = c->demandOf(p);
+        double wtp = line.c - line.m * c->consumedOf(p);
 
         sH("MARGINAL UTILITY", c->name + "  →  " + prodName);
         kv("MU per Tk", fmtD(muPerTk, 7) + "  (= 1 / wealth)");
         kv("Willingness to pay", "Tk " + fmtD(wtp));
-        kv("Consumed so far", fmtD(c->consumed[p]) + " units");
+        kv("Consumed so far", fmtD(c->consumedOf(p)) + " units");
         hline();
         kv("Marginal utility", fmtD(mu, 7));
         bln();
@@ -906,7 +1008,7 @@ public:
 
     void cmdConsumerSurplus(const Command &cmd)
     {
-        consumer *c = simulation.selected_consumer;
+        consumer *c = simulation.GetSelectedConsumer();
         if (!c)
         {
             output(Styled("[✗]", Theme::Error) + " No consumer selected");
@@ -927,17 +1029,16 @@ public:
             return;
         }
 
-        // findKey() returns the real global pointer used as the map key.
-        // Using &(*p) directly would point at a local copy and miss the map entry.
-        product *key = c->findKey(prodName);
-        if (!key)
+        product *key = p;
+        if (!c->demands(key))
         {
             output(Styled("[✗]", Theme::Error) + " Consumer has no demand curve for " + prodName);
             return;
         }
 
-        double intercept = c->dd[key].c; // P-intercept of individual demand curve
-        double slope = c->dd[key].m;     // slope m
+        demandLine line = c->demandOf(key);
+        double intercept = line.c; // P-intercept of individual demand curve
+        double slope = line.m;     // slope m
         double marketPrice = m->price;
 
         // Consumer surplus = ½ × (c − P) × Q*   where Q* = (c−P)/m
@@ -945,7 +1046,7 @@ public:
         double surplus = 0.5 * (intercept - marketPrice) * qStar;
         surplus = std::max(0.0, surplus);
 
-        double wtp = intercept - slope * c->consumed[key]; // WTP at current consumed qty
+        double wtp = intercept - slope * c->consumedOf(key); // WTP at current consumed qty
 
         sH("CONSUMER SURPLUS", c->name + "  →  " + prodName);
         kv("Market price", "Tk " + fmtD(marketPrice));
@@ -962,7 +1063,7 @@ public:
 
     void cmdConsumerSubstitution(const Command &cmd)
     {
-        consumer *c = simulation.selected_consumer;
+        consumer *c = simulation.GetSelectedConsumer();
         if (!c)
         {
             output(Styled("[✗]", Theme::Error) + " No consumer selected");
@@ -972,9 +1073,10 @@ public:
         sH("SUBSTITUTION RATIOS", c->name);
         noteText("MRS relative to Rice  (MU_good / MU_rice)");
         hline();
-        for (auto &need : c->needs)
+        for (const needRef &n : c->needs)
         {
-            double ratio = c->updateSubRatio(need);
+            const product &need = *catalogue().get(n.id);
+            double ratio = c->updateSubRatio(&need);
             std::string bar = "";
             int barLen = std::min((int)(ratio * 20), 30);
             for (int i = 0; i < barLen; i++)
@@ -990,7 +1092,7 @@ public:
 
     void cmdConsumerNeeds(const Command &cmd)
     {
-        consumer *c = simulation.selected_consumer;
+        consumer *c = simulation.GetSelectedConsumer();
         if (!c)
         {
             output(Styled("[✗]", Theme::Error) + " No consumer selected");
@@ -998,19 +1100,20 @@ public:
         }
 
         sH("NEEDS & CONSUMPTION", c->name);
-        for (auto &need : c->needs)
+        for (const needRef &n : c->needs)
         {
-            product *p = &need;
-            entLabel(need.name);
-            eqRow("Demand curve", "P = " + fmtD(c->dd[p].c) + " − " + fmtD(c->dd[p].m) + "Q");
-            kv("Consumed", fmtD(c->consumed[p]) + " units");
+            const product *p = catalogue().get(n.id);
+            demandLine line = c->demandOf(p);
+            entLabel(p->name);
+            eqRow("Demand curve", "P = " + fmtD(line.c) + " − " + fmtD(line.m) + "Q");
+            kv("Consumed", fmtD(c->consumedOf(p)) + " units");
         }
         bln();
     }
 
     void cmdConsumerDemandCurve(const Command &cmd)
     {
-        consumer *c = simulation.selected_consumer;
+        consumer *c = simulation.GetSelectedConsumer();
         if (!c)
         {
             output(Styled("[✗]", Theme::Error) + " No consumer selected");
@@ -1030,11 +1133,12 @@ public:
             return;
         }
 
+        demandLine line = c->demandOf(p);
         sH("DEMAND CURVE", c->name + "  →  " + prodName);
-        eqRow("Individual curve", "P = " + fmtD(c->dd[p].c) + " − " + fmtD(c->dd[p].m) + "Q");
+        eqRow("Individual curve", "P = " + fmtD(line.c) + " − " + fmtD(line.m) + "Q");
         hline();
-        kv("Intercept (c)", fmtD(c->dd[p].c) + "  (max WTP at Q=0)");
-        kv("Slope (m)", fmtD(c->dd[p].m) + "  (WTP falls by this per unit)");
+        kv("Intercept (c)", fmtD(line.c) + "  (max WTP at Q=0)");
+        kv("Slope (m)", fmtD(line.m) + "  (WTP falls by this per unit)");
         bln();
     }
 
@@ -1042,7 +1146,7 @@ public:
 
     void cmdFarmerSupply(const Command &cmd)
     {
-        farmer *f = simulation.selected_farmer;
+        farmer *f = simulation.GetSelectedFarmer();
         if (!f)
         {
             output(Styled("[✗]", Theme::Error) + " No farmer selected");
@@ -1064,21 +1168,22 @@ public:
         }
 
         double qty = f->calculateSupply(p, price);
+        supplyLine line = f->supplyOf(p);
 
         sH("FARMER SUPPLY", f->name + "  →  " + prodName);
         kv("Query price", "Tk " + fmtD(price));
-        kv("MC intercept", "Tk " + fmtD(f->ss[p].c));
-        kv("Slope", fmtD(f->ss[p].m, 4));
+        kv("MC intercept", "Tk " + fmtD(line.c));
+        kv("Slope", fmtD(line.m, 4));
         hline();
         kv("Supply at P", fmtD(qty) + " units");
-        if (price <= f->ss[p].c)
+        if (price <= line.c)
             noteText("Price is below marginal cost — farmer will not produce");
         bln();
     }
 
     void cmdFarmerCrops(const Command &cmd)
     {
-        farmer *f = simulation.selected_farmer;
+        farmer *f = simulation.GetSelectedFarmer();
         if (!f)
         {
             output(Styled("[✗]", Theme::Error) + " No farmer selected");
@@ -1086,21 +1191,20 @@ public:
         }
 
         sH("CROPS", f->name);
-        for (auto &crop : f->crops)
+        for (size_t i = 0; i < f->crops.size(); i++)
         {
-            product *p = &crop;
-            entLabel(crop.name);
-            eqRow("Supply curve", "P = " + fmtD(f->ss[p].c) + " + " + fmtD(f->ss[p].m) + "Q");
-            kv("Growth rate", fmtD(f->growthRate[p]) + " units/day");
-            kv("Decay rate", fmtD(f->decay[p]) + " units/day");
-            kv("Max output", fmtD(f->maxOutput[p]) + " units");
+            entLabel(f->crops[i].name);
+            eqRow("Supply curve", "P = " + fmtD(f->ss[i].c) + " + " + fmtD(f->ss[i].m) + "Q");
+            kv("Growth rate", fmtD(f->growthRate[i]) + " units/day");
+            kv("Decay rate", fmtD(f->decay[i]) + " units/day");
+            kv("Max output", fmtD(f->maxOutput[i]) + " units");
         }
         bln();
     }
 
     void cmdFarmerUpgrade(const Command &cmd)
     {
-        farmer *f = simulation.selected_farmer;
+        farmer *f = simulation.GetSelectedFarmer();
         if (!f)
         {
             output(Styled("[✗]", Theme::Error) + " No farmer selected");
@@ -1117,8 +1221,8 @@ public:
 
         // Snapshot supply curves BEFORE upgrade
         std::vector<std::tuple<std::string, double, double>> before; // name, c, m
-        for (auto &crop : f->crops)
-            before.emplace_back(crop.name, f->ss[&crop].c, f->ss[&crop].m);
+        for (size_t i = 0; i < f->crops.size(); i++)
+            before.emplace_back(f->crops[i].name, f->ss[i].c, f->ss[i].m);
 
         f->upgradeTech(newLevel);
 
@@ -1158,8 +1262,8 @@ public:
             for (size_t i = 0; i < f->crops.size() && i < before.size(); i++)
             {
                 auto &[cname, oldC, oldM] = before[i];
-                double newC = f->ss[&f->crops[i]].c;
-                double newM = f->ss[&f->crops[i]].m;
+                double newC = f->ss[i].c;
+                double newM = f->ss[i].m;
 
                 std::cout << "    " << Styled(padStr(cname, 12), Theme::Warning) << "\n";
                 eqRow("  Before", "P = " + fmtD(oldC) + " + " + fmtD(oldM, 3) + "Q  (cost floor Tk " + fmtD(oldC) + ")");
@@ -1179,7 +1283,7 @@ public:
 
     void cmdFarmerWeather(const Command &cmd)
     {
-        farmer *f = simulation.selected_farmer;
+        farmer *f = simulation.GetSelectedFarmer();
         if (!f)
         {
             output(Styled("[✗]", Theme::Error) + " No farmer selected");
@@ -1207,7 +1311,7 @@ public:
 
     void cmdFarmerSupplyCurve(const Command &cmd)
     {
-        farmer *f = simulation.selected_farmer;
+        farmer *f = simulation.GetSelectedFarmer();
         if (!f)
         {
             output(Styled("[✗]", Theme::Error) + " No farmer selected");
@@ -1227,9 +1331,10 @@ public:
             return;
         }
 
+        supplyLine line = f->supplyOf(p);
         sH("SUPPLY CURVE", f->name + "  →  " + prodName);
-        eqRow("Curve", "P = " + fmtD(f->ss[p].c) + " + " + fmtD(f->ss[p].m) + "Q");
-        kv("Max output", fmtD(f->maxOutput[p]) + " units");
+        eqRow("Curve", "P = " + fmtD(line.c) + " + " + fmtD(line.m) + "Q");
+        kv("Max output", fmtD(f->maxOutputOf(p)) + " units");
         bln();
     }
 
@@ -1255,7 +1360,9 @@ public:
 
         sH("COST ANALYSIS", ownerName);
         kv("Labor (L)", std::to_string(f->workers.size()) + " workers");
-        kv("Capital (K)", std::to_string(f->capitals.size()) + " units");
+        kv("Capital (K)", std::to_string(f->capitals.count()) + " units");
+        kv("Capital stock", fmtD(f->capitals.units()) + " efficiency units, " +
+                                std::to_string(f->capitals.vintages().size()) + " vintages");
         kv("Output (Q)", fmtD(f->currentOutput) + " units");
         hline();
 
@@ -1295,7 +1402,7 @@ public:
         }
         firm *f = simulation.selected_firm;
         double L = f->workers.size();
-        double K = f->capitals.size();
+        double K = f->capitals.count();
         double Q = f->prodFunc->output(L, K);
 
         std::string ownerName = "Owner #" + std::to_string(f->ownerId);
@@ -1403,8 +1510,11 @@ public:
         {
             if (l.name == name)
             {
-                f->workers.push_back(l);
-                f->calculateCosts();
+                if (!simulation.hire(*f, l.id))
+                {
+                    output(Styled("[✗]", Theme::Error) + " " + name + " is already employed");
+                    return;
+                }
                 successNote("Hired " + name + "  →  Q = " + fmtD(f->currentOutput) + " units");
                 return;
             }
@@ -1427,12 +1537,10 @@ public:
         }
 
         std::string name = getParam<std::string>(cmd, "laborer", std::string());
-        for (auto it = f->workers.begin(); it != f->workers.end(); ++it)
+        for (auto &l : simulation.laborers)
         {
-            if (it->name == name)
+            if (l.name == name && simulation.fire(*f, l.id))
             {
-                f->workers.erase(it);
-                f->calculateCosts();
                 std::cout << "\n  " << Styled("  ✗  Fired " + name + "  →  Q = " + fmtD(f->currentOutput) + " units", Theme::Warning) << "\n\n";
                 return;
             }
@@ -1455,7 +1563,7 @@ public:
         }
         double rental = getParam<double>(cmd, "rental", 0.0);
         double eff = getParam<double>(cmd, "eff", 0.0);
-        f->capitals.emplace_back(rental, eff);
+        f->addCapital(rental, eff, simulation.dayCount);
         f->calculateCosts();
         successNote("Capital added  r=$" + fmtD(rental) + " eff=" + fmtD(eff) + "  →  Q = " + fmtD(f->currentOutput) + " units");
     }
@@ -1463,7 +1571,7 @@ public:
     // ── FARMER TAX ────────────────────────────────────────────────────────
     void cmdFarmerTax(const Command &cmd)
     {
-        farmer *f = simulation.selected_farmer;
+        farmer *f = simulation.GetSelectedFarmer();
         if (!f)
         {
             output(Styled("[✗]", Theme::Error) + " No farmer selected");
@@ -1486,8 +1594,8 @@ public:
 
         // Snapshot curves before
         std::vector<std::tuple<std::string, double, double>> before;
-        for (auto &crop : f->crops)
-            before.emplace_back(crop.name, f->ss[&crop].c, f->ss[&crop].m);
+        for (size_t i = 0; i < f->crops.size(); i++)
+            before.emplace_back(f->crops[i].name, f->ss[i].c, f->ss[i].m);
 
         // Apply tax and immediately recalculate supply curves
         f->tax = newRate;
@@ -1511,8 +1619,8 @@ public:
         for (size_t i = 0; i < f->crops.size() && i < before.size(); i++)
         {
             auto &[cname, oldC, oldM] = before[i];
-            double newC = f->ss[&f->crops[i]].c;
-            double newM = f->ss[&f->crops[i]].m;
+            double newC = f->ss[i].c;
+            double newM = f->ss[i].m;
             double costRise = newC - oldC;
 
             std::cout << "    " << Styled(padStr(cname, 12), Theme::Warning) << "\n";
@@ -1615,7 +1723,7 @@ public:
     // ── SET INCOME ────────────────────────────────────────────────────────
     void cmdSetIncome(const Command &cmd)
     {
-        consumer *c = simulation.selected_consumer;
+        consumer *c = simulation.GetSelectedConsumer();
         if (!c)
         {
             output(Styled("[✗]", Theme::Error) + " No consumer selected");
@@ -1643,19 +1751,22 @@ public:
 
         // Update MU per Tk (richer = values each Tk less)
         double oldMU = c->muPerTk;
-        c->muPerTk = c->getMUperTk();
+        c->currentMUperTk();
 
         // Shift demand curves for all needs (Engel curve effect)
-        for (auto &need : c->needs)
+        for (const needRef &n : c->needs)
         {
-            product *key = c->findKey(need.name);
-            if (!key)
+            const product &need = *catalogue().get(n.id);
+            const product *key = &need;
+            if (!c->demands(key))
                 continue;
             // Normal goods: demand shifts out; inferior goods: demand shifts in
+            demandLine line = c->demandOf(key);
             if (need.eta > 0)
-                c->dd[key].c += incomeChange * 0.05 * need.eta;
+                line.c += incomeChange * 0.05 * need.eta;
             else
-                c->dd[key].c = std::max(0.5, c->dd[key].c + incomeChange * 0.02 * need.eta);
+                line.c = std::max(0.5, line.c + incomeChange * 0.02 * need.eta);
+            c->setDemand(key, line);
         }
 
         sH("INCOME CHANGE", c->name);
@@ -1675,10 +1786,11 @@ public:
         hline();
         std::cout << "\n  " << Styled("DEMAND SHIFTS  (Engel curve effect)", Theme::Warning) << "\n\n";
 
-        for (auto &need : c->needs)
+        for (const needRef &n : c->needs)
         {
-            product *key = c->findKey(need.name);
-            if (!key)
+            const product &need = *catalogue().get(n.id);
+            const product *key = &need;
+            if (!c->demands(key))
                 continue;
 
             std::string elasticityTag = need.eta > 1.0 ? "luxury" : need.eta > 0.0 ? "normal"
@@ -1698,7 +1810,8 @@ public:
             else if (incomeChange < 0 && need.eta < 0)
                 noteText("  WTP intercept ▲  →  inferior good: buys more when poorer");
 
-            eqRow("  New demand", "P = " + fmtD(c->dd[key].c) + " − " + fmtD(c->dd[key].m) + "Q");
+            demandLine line = c->demandOf(key);
+            eqRow("  New demand", "P = " + fmtD(line.c) + " − " + fmtD(line.m) + "Q");
         }
 
         hline();
@@ -1726,7 +1839,9 @@ public:
             {"LABORER", "laborer_"},
             {"FIRM", "firm_"},
             {"MARKET", "market_"},
-            {"SIMULATION", "pass_day|status|help|clear|exit"},
+            {"SIMULATION", "pass_day|fast_forward|run|stop|threads|clearing|status|profile|profile_|record|save|load|help|clear|exit"},
+            {"BRANCHES", "fork|checkout|branches|pass_all|drop_branch"},
+            {"REGIONS", "regions|pass_regions"},
         };
 
         auto inGroup = [](const std::string &name, const std::string &pattern) -> bool
@@ -1818,7 +1933,8 @@ public:
 
     void cmdStatus(const Command &cmd)
     {
-        auto stats = simulation.getStats();
+        const worldView &v = view();
+        const world::stats &stats = v.stats;
 
         sH("ECONOMIC STATUS");
 
@@ -1831,18 +1947,18 @@ public:
 
         // Market prices snapshot
         std::cout << "  " << Styled("MARKET PRICES", Theme::Warning) << "\n";
-        for (auto &m : simulation.markets)
+        for (auto &m : v.markets)
         {
             if (m.price > 0.1)
             {
                 std::string trendStr;
-                if (m.priceHistory.size() > 1)
+                if (m.hasPrev)
                 {
-                    double delta = m.price - m.priceHistory[m.priceHistory.size() - 2];
+                    double delta = m.price - m.prevPrice;
                     trendStr = delta > 0.5 ? Styled("  ▲", Theme::Warning) : delta < -0.5 ? Styled("  ▼", Theme::Info)
                                                                                           : Styled("  ─", Theme::Muted);
                 }
-                kv(m.prod->name, "Tk " + fmtD(m.price) + trendStr);
+                kv(m.name, "Tk " + fmtD(m.price) + trendStr);
             }
         }
         hline();
@@ -1865,7 +1981,550 @@ public:
         bln();
     }
 
+    // ── PROFILE ───────────────────────────────────────────────────────────
+    void cmdProfile(const Command &)
+    {
+        const profile::phaseTimes &t = simulation.phaseTimes;
+        sH("PASS_DAY PROFILE", std::to_string(t[profile::Agents].calls) + " days timed");
+#ifdef CPPCONOMY_NO_PROFILE
+        noteText("Built with CPPCONOMY_NO_PROFILE — timers are compiled out");
+        bln();
+        return;
+#endif
+        double total = (double)std::max<uint64_t>(1, t.totalNs());
+        std::cout << "    " << Styled(padStr("Phase", 18), Theme::Info)
+                  << Styled(padStr("avg ms", 11), Theme::Info)
+                  << Styled(padStr("last ms", 11), Theme::Info)
+                  << Styled(padStr("max ms", 11), Theme::Info)
+                  << Styled(padStr("ns/item", 11), Theme::Info)
+                  << Styled("share", Theme::Info) << "\n";
+        for (int p = 0; p < profile::PhaseCount; p++)
+        {
+            const profile::phaseStats &s = t[p];
+            double avgMs = s.calls ? s.totalNs / 1e6 / s.calls : 0.0;
+            double perItem = s.items ? (double)s.totalNs / s.items : 0.0;
+            double share = 100.0 * s.totalNs / total;
+            const char *color = share > 40.0 ? Theme::Warning : Theme::Secondary;
+            std::cout << "    " << Styled(padStr(profile::phaseName(p), 18), Theme::Muted)
+                      << Styled(padStr(fmtD(avgMs, 3), 11), color)
+                      << Styled(padStr(fmtD(s.lastNs / 1e6, 3), 11), color)
+                      << Styled(padStr(fmtD(s.maxNs / 1e6, 3), 11), color)
+                      << Styled(padStr(fmtD(perItem, 1), 11), color)
+                      << Styled(fmtD(share, 1) + "%", color) << "\n";
+        }
+        hline();
+        noteText("profile_dump for JSON  |  profile_reset to start over");
+        bln();
+    }
+
+    // JSON to stdout, or to a file when a path is given
+    void cmdProfileDump(const Command &cmd)
+    {
+        std::string json = simulation.phaseTimes.toJson();
+        if (!hasParam(cmd, "path"))
+        {
+            std::cout << json << "\n";
+            return;
+        }
+        std::string path = getParam<std::string>(cmd, "path", std::string());
+        std::ofstream out(path);
+        if (!out)
+        {
+            output(Styled("[✗]", Theme::Error) + " Cannot write " + path);
+            return;
+        }
+        out << json << "\n";
+        successNote("Profile written to " + path);
+    }
+
+    // ── BRANCHES ──────────────────────────────────────────────────────────
+    // fork(name) copies the active world (store columns copy-on-write);
+    // checkout(name) swaps which branch commands act on.
+    void cmdFork(const Command &cmd)
+    {
+        std::string name = getParam<std::string>(cmd, "name", std::string());
+        if (name.empty() || name == activeBranch || branches.count(name))
+        {
+            output(Styled("[✗]", Theme::Error) + " Branch name missing or already in use");
+            return;
+        }
+        branches.emplace(name, simulation.fork());
+        successNote("Forked '" + name + "' from '" + activeBranch + "' at day " +
+                    std::to_string(simulation.dayCount));
+    }
+
+    void cmdCheckout(const Command &cmd)
+    {
+        std::string name = getParam<std::string>(cmd, "name", std::string());
+        auto it = branches.find(name);
+        if (it == branches.end())
+        {
+            output(Styled("[✗]", Theme::Error) + " No branch named '" + name + "'");
+            return;
+        }
+        world next = it->second;
+        branches.erase(it);
+        branches.emplace(activeBranch, simulation);
+        simulation = next;
+        activeBranch = name;
+        requestHeaderRefresh();
+        successNote("Now on '" + name + "' (day " + std::to_string(simulation.dayCount) + ")");
+    }
+
+    void cmdDropBranch(const Command &cmd)
+    {
+        std::string name = getParam<std::string>(cmd, "name", std::string());
+        if (!branches.erase(name))
+        {
+            output(Styled("[✗]", Theme::Error) + " No branch named '" + name + "'");
+            return;
+        }
+        successNote("Dropped '" + name + "'");
+    }
+
+    // Advance the active world and every branch by the same number of days
+    void cmdPassAll(const Command &cmd)
+    {
+        int n = std::max(1, getParam<int>(cmd, "n", 1));
+        for (int i = 0; i < n; i++)
+            stepDay();
+        for (auto &[name, w] : branches)
+            for (int i = 0; i < n; i++)
+                w.pass_day();
+        requestHeaderRefresh();
+        cmdBranches(cmd);
+    }
+
+    // Stats of every branch side by side, with differences from the active one
+    void cmdBranches(const Command &)
+    {
+        world::stats base = simulation.getStats();
+        sH("BRANCHES", std::to_string(branches.size() + 1) + " worlds  ·  deltas vs '" + activeBranch + "'");
+        std::cout << "    " << Styled(padStr("Branch", 14), Theme::Info)
+                  << Styled(padStr("Day", 6), Theme::Info)
+                  << Styled(padStr("GDP", 26), Theme::Info)
+                  << Styled(padStr("Unemployment", 18), Theme::Info)
+                  << Styled("Money supply", Theme::Info) << "\n";
+
+        auto delta = [&](double v, double ref, int precision)
+        {
+            double d = v - ref;
+            if (std::fabs(d) < 0.005)
+                return std::string();
+            return std::string(d > 0 ? " (+" : " (") + fmtD(d, precision) + ")";
+        };
+        auto row = [&](const std::string &name, world &w, bool active)
+        {
+            world::stats s = w.getStats();
+            std::string shared = active ? "" : "  " + std::to_string(w.demand.sharedColumns() + w.supply.sharedColumns()) + " cols shared";
+            std::cout << "  " << Styled(active ? "●" : "▸", active ? Theme::Success : Theme::Primary) << " "
+                      << Styled(padStr(name, 14), Theme::Highlight)
+                      << Styled(padStr(std::to_string(w.dayCount), 6), Theme::Muted)
+                      << Styled(padStr(fmtD(s.gdp) + delta(s.gdp, base.gdp, 0), 26), Theme::Secondary)
+                      << Styled(padStr(fmtD(s.unemployment * 100.0) + "%" + delta(s.unemployment * 100.0, base.unemployment * 100.0, 2), 18), Theme::Secondary)
+                      << Styled(fmtD(s.moneySupply, 0) + delta(s.moneySupply, base.moneySupply, 0), Theme::Secondary)
+                      << Styled(shared, Theme::Muted) << "\n";
+        };
+        row(activeBranch, simulation, true);
+        for (auto &[name, w] : branches)
+            row(name, w, false);
+        hline();
+        noteText("fork(name)  |  checkout(name)  |  pass_all(n)  |  drop_branch(name)");
+        bln();
+    }
+
+    // ── REGIONS ───────────────────────────────────────────────────────────
+    // regions(n) shards the active world into n districts that clear their own
+    // markets and trade between days; the active world itself is left as is.
+    void cmdRegions(const Command &cmd)
+    {
+        if (hasParam(cmd, "n"))
+        {
+            int n = getParam<int>(cmd, "n", 0);
+            if (n < 2)
+            {
+                output(Styled("[✗]", Theme::Error) + " Need at least 2 regions");
+                return;
+            }
+            regions.setThreads(simulation.threads());
+            regions.split(simulation, n);
+            successNote("Split '" + activeBranch + "' into " + std::to_string(n) +
+                        " regions at day " + std::to_string(simulation.dayCount));
+        }
+        if (regions.empty())
+        {
+            output(Styled("[i]", Theme::Info) + " No regions yet  (regions(n) to split the active world)");
+            return;
+        }
+        showRegions();
+    }
+
+    void cmdPassRegions(const Command &cmd)
+    {
+        if (regions.empty())
+        {
+            output(Styled("[✗]", Theme::Error) + " No regions yet  (regions(n) to split the active world)");
+            return;
+        }
+        int n = std::max(1, getParam<int>(cmd, "n", 1));
+        for (int i = 0; i < n; i++)
+            regions.pass_day();
+        showRegions();
+    }
+
+    void showRegions()
+    {
+        world::stats total = regions.totals();
+        sH("REGIONS", std::to_string(regions.size()) + " districts  ·  day " + std::to_string(regions.dayCount()));
+        std::cout << "    " << Styled(padStr("Region", 10), Theme::Info)
+                  << Styled(padStr("Population", 12), Theme::Info)
+                  << Styled(padStr("Firms", 8), Theme::Info)
+                  << Styled(padStr("GDP", 16), Theme::Info)
+                  << Styled("Unemployment", Theme::Info) << "\n";
+        for (auto &r : regions.regions)
+        {
+            world::stats s = r.economy.getStats();
+            std::cout << "  " << Styled("▸", Theme::Primary) << " "
+                      << Styled(padStr(r.name, 10), Theme::Highlight)
+                      << Styled(padStr(std::to_string(s.population), 12), Theme::Secondary)
+                      << Styled(padStr(std::to_string(s.firms), 8), Theme::Secondary)
+                      << Styled(padStr(fmtD(s.gdp), 16), Theme::Secondary)
+                      << Styled(fmtD(s.unemployment * 100.0) + "%", Theme::Secondary) << "\n";
+        }
+        std::cout << "  " << Styled("Σ", Theme::Success) << " "
+                  << Styled(padStr("all", 10), Theme::Highlight)
+                  << Styled(padStr(std::to_string(total.population), 12), Theme::Secondary)
+                  << Styled(padStr(std::to_string(total.firms), 8), Theme::Secondary)
+                  << Styled(padStr(fmtD(total.gdp), 16), Theme::Secondary)
+                  << Styled(fmtD(total.unemployment * 100.0) + "%", Theme::Secondary) << "\n";
+
+        // Local price and net imports per product, then the integrated price
+        sH("TRADE", "price (net imports) per region  ·  integrated price");
+        for (auto &m : simulation.markets)
+        {
+            int pid = m.prod->id;
+            std::cout << "    " << Styled(padStr(m.prod->name, 10), Theme::Highlight);
+            for (auto &r : regions.regions)
+            {
+                const market *local = r.economy.marketFor(pid);
+                double q = r.economy.importsOf(pid);
+                std::string cell = local ? fmtD(local->price) : "-";
+                if (std::fabs(q) >= 0.005)
+                    cell += std::string(q > 0 ? " (+" : " (") + fmtD(q) + ")";
+                std::cout << Styled(padStr(cell, 20), Theme::Secondary);
+            }
+            double pooled = pid < (int)regions.pooledPrices.size() ? regions.pooledPrices[pid] : 0.0;
+            std::cout << Styled(pooled > 0.0 ? fmtD(pooled) : "untraded", Theme::Muted) << "\n";
+        }
+        hline();
+        noteText("regions(n)  |  pass_regions(n)");
+        bln();
+    }
+
+    // ── BACKGROUND RUN ────────────────────────────────────────────────────
+    // run(n) steps the active world on a worker thread that publishes a
+    // worldView after every day, so the prompt stays live. While it runs,
+    // only commands that read the published view or control the run are
+    // accepted; everything else would read the world mid-day.
+    bool busy() const { return background.active; }
+
+    static bool allowedWhileBusy(const std::string &name)
+    {
+        return name == "status" || name == "stop" || name == "help" || name == "clear" || name == "exit";
+    }
+
+    // What the CLI renders: the last published day while a run is going,
+    // otherwise the world itself
+    const worldView &view()
+    {
+        if (busy())
+            return views.latest();
+        idleView.capture(simulation);
+        return idleView;
+    }
+
+    void cmdRun(const Command &cmd)
+    {
+        int n = getParam<int>(cmd, "n", 0);
+        if (n < 1)
+        {
+            output(Styled("[✗]", Theme::Error) + " Usage: run(n)");
+            return;
+        }
+        if (!animate) // scripts: in the foreground, so the next line sees the result
+        {
+            for (int i = 0; i < n; i++)
+                stepDay();
+            successNote("Ran " + std::to_string(n) + " days  ·  now day " + std::to_string(simulation.dayCount));
+            return;
+        }
+
+        background.stopRequested.store(false);
+        background.finished.store(false);
+        background.startDay = simulation.dayCount;
+        background.targetDay = simulation.dayCount + n;
+        views.back().capture(simulation);
+        views.publish();
+        background.active = true;
+        background.worker = std::thread([this, n]
+                                        {
+            for (int i = 0; i < n && !background.stopRequested.load(std::memory_order_relaxed); i++)
+            {
+                stepDay();
+                views.back().capture(simulation);
+                views.publish();
+            }
+            background.finished.store(true, std::memory_order_release); });
+        successNote("Running " + std::to_string(n) + " days in the background  (status to watch, stop to halt)");
+    }
+
+    void cmdStop(const Command &)
+    {
+        if (!busy())
+        {
+            output(Styled("[i]", Theme::Info) + " Nothing is running");
+            return;
+        }
+        stopBackground();
+        successNote("Stopped at day " + std::to_string(simulation.dayCount) + "  (" +
+                    std::to_string(simulation.dayCount - background.startDay) + " days run)");
+    }
+
+    // Ask the worker to stop after its current day and wait for it
+    void stopBackground()
+    {
+        if (!background.active)
+            return;
+        background.stopRequested.store(true, std::memory_order_relaxed);
+        background.worker.join();
+        background.active = false;
+    }
+
+    // Join a worker that has run all its days, and say so
+    void reapBackground()
+    {
+        if (!background.active || !background.finished.load(std::memory_order_acquire))
+            return;
+        background.worker.join();
+        background.active = false;
+        successNote("Background run finished  ·  day " + std::to_string(background.startDay) + "  →  " +
+                    std::to_string(simulation.dayCount));
+    }
+
+    // ── RECORDING ─────────────────────────────────────────────────────────
+    // Every simulated day of the active world goes through here
+    void stepDay()
+    {
+        simulation.pass_day();
+        recorder.record(simulation);
+    }
+
+    void cmdRecord(const Command &cmd)
+    {
+        if (!hasParam(cmd, "path"))
+        {
+            output(Styled("[✗]", Theme::Error) + " Usage: " + cmd.name + "(path)");
+            return;
+        }
+        std::string path = getParam<std::string>(cmd, "path", std::string());
+        auto fmt = cmd.name == "record_bin" ? seriesRecorder::format::Binary : seriesRecorder::format::Csv;
+        std::string err;
+        if (!recorder.open(path, fmt, simulation, err))
+        {
+            output(Styled("[✗]", Theme::Error) + " " + err);
+            return;
+        }
+        successNote("Recording every day to " + path + "  (record_stop to finish)");
+    }
+
+    void cmdRecordStop(const Command &)
+    {
+        if (!recorder.isOpen())
+        {
+            output(Styled("[i]", Theme::Info) + " Not recording");
+            return;
+        }
+        long long rows = recorder.rows();
+        std::string path = recorder.path();
+        recorder.close();
+        successNote(std::to_string(rows) + " days written to " + path);
+    }
+
+    // ── SNAPSHOTS ─────────────────────────────────────────────────────────
+    void cmdSave(const Command &cmd)
+    {
+        if (!hasParam(cmd, "path"))
+        {
+            output(Styled("[✗]", Theme::Error) + " Usage: save(path)");
+            return;
+        }
+        std::string path = getParam<std::string>(cmd, "path", std::string());
+        std::string err;
+        if (!snapshot::save(simulation, path, err))
+        {
+            output(Styled("[✗]", Theme::Error) + " " + err);
+            return;
+        }
+        successNote("Day " + std::to_string(simulation.dayCount) + " saved to " + path);
+    }
+
+    void cmdLoad(const Command &cmd)
+    {
+        if (!hasParam(cmd, "path"))
+        {
+            output(Styled("[✗]", Theme::Error) + " Usage: load(path)");
+            return;
+        }
+        std::string path = getParam<std::string>(cmd, "path", std::string());
+        std::string err;
+        if (!snapshot::load(simulation, path, err))
+        {
+            output(Styled("[✗]", Theme::Error) + " Cannot load " + path + ": " + err);
+            return;
+        }
+        successNote("Loaded day " + std::to_string(simulation.dayCount) + " from " + path);
+    }
+
+    // ── THREADS ───────────────────────────────────────────────────────────
+    void cmdThreads(const Command &cmd)
+    {
+        if (hasParam(cmd, "n"))
+        {
+            int n = getParam<int>(cmd, "n", simulation.threads());
+            if (n < 0)
+            {
+                output(Styled("[✗]", Theme::Error) + " Thread count cannot be negative");
+                return;
+            }
+            simulation.setThreads(n);
+        }
+
+        sH("THREADS");
+        kv("Agent update threads", std::to_string(simulation.threads()));
+        kv("Hardware cores", std::to_string(std::thread::hardware_concurrency()));
+        kv("Agents per chunk", std::to_string(world::AGENT_GRAIN));
+        noteText("Results are identical for any thread count");
+        bln();
+    }
+
+    // ── CLEARING MODE ─────────────────────────────────────────────────────
+    void cmdClearing(const Command &cmd)
+    {
+        if (hasParam(cmd, "mode"))
+        {
+            std::string mode = getParam<std::string>(cmd, "mode", std::string());
+            double tol = getParam<double>(cmd, "tol", simulation.solver.tolerance);
+            int iters = getParam<int>(cmd, "iters", simulation.solver.maxIterations);
+            if ((mode != "curves" && mode != "orders" && mode != "ge") || !(tol >= 0.0) || iters < 1)
+            {
+                output(Styled("[✗]", Theme::Error) + " Usage: clearing(curves), clearing(orders) or clearing(ge, tol, iters)");
+                return;
+            }
+            simulation.orderMatching = mode == "orders";
+            simulation.jointClearing = mode == "ge";
+            simulation.solver.tolerance = tol;
+            simulation.solver.maxIterations = iters;
+            simulation.solver.resetTotals();
+        }
+
+        sH("MARKET CLEARING", simulation.orderMatching   ? "order books"
+                              : simulation.jointClearing ? "general equilibrium"
+                                                         : "aggregate curves");
+        if (simulation.jointClearing)
+        {
+            const equilibriumSolver &g = simulation.solver;
+            kv("Tolerance", fmtD(g.tolerance, 9) + " relative excess demand");
+            kv("Iteration budget", std::to_string(g.maxIterations) + " per clearing");
+            kv("Last clearing", std::to_string(g.last.iterations) + " iterations, " +
+                                    std::to_string(g.last.evaluations) + " demand passes, residual " +
+                                    fmtD(g.last.residual, 9) + (g.last.converged ? "" : " (not converged)"));
+            if (g.solves > 0)
+                kv("Since switching", std::to_string(g.solves) + " clearings, " +
+                                          fmtD((double)g.iterations / g.solves) + " iterations each, " +
+                                          std::to_string(g.unconverged) + " not converged");
+            hline();
+            noteText("All prices solve at once against budget-limited agent demand");
+            noteText("Markets left outside tolerance fall back to tâtonnement");
+            bln();
+            return;
+        }
+        if (!simulation.orderMatching)
+        {
+            noteText("Prices clear the summed demand and supply lines; agents consume by rule");
+            noteText("clearing(orders) matches every agent's line in a per-market book instead");
+            noteText("clearing(ge) solves every market jointly under agents' budgets");
+            bln();
+            return;
+        }
+        std::cout << "    " << Styled(padStr("Market", 12), Theme::Info)
+                  << Styled(padStr("Bids", 8), Theme::Info)
+                  << Styled(padStr("Asks", 8), Theme::Info)
+                  << Styled(padStr("Price", 12), Theme::Info)
+                  << Styled("Volume", Theme::Info) << "\n";
+        for (size_t i = 0; i < simulation.markets.size(); i++)
+        {
+            const market &m = simulation.markets[i];
+            const orderBook *book = i < simulation.books.size() ? &simulation.books[i] : nullptr;
+            std::cout << "  " << Styled("▸", Theme::Primary) << " "
+                      << Styled(padStr(m.prod->name, 12), Theme::Highlight);
+            if (!book)
+            {
+                std::cout << Styled("not matched yet", Theme::Muted) << "\n";
+                continue;
+            }
+            std::cout << Styled(padStr(std::to_string(book->bids.size()), 8), Theme::Secondary)
+                      << Styled(padStr(std::to_string(book->asks.size()), 8), Theme::Secondary)
+                      << Styled(padStr(book->traded ? fmtD(book->price) : "-", 12), Theme::Secondary)
+                      << Styled(book->traded ? fmtD(book->volume) : "no cross", Theme::Secondary) << "\n";
+        }
+        hline();
+        noteText("Agents consume their fills; sellers are paid the clearing price");
+        bln();
+    }
+
     // ── PASS DAY  ────────────────────────────────────────────────────────
+    // Long runs without the 365-day cap: calm stretches between shock days
+    // run as quiet days (see fastforward.h)
+    void cmdFastForward(const Command &cmd)
+    {
+        long long n = getParam<int>(cmd, "n", 0);
+        double tol = getParam<double>(cmd, "tol", 0.001);
+        if (n < 1 || !(tol >= 0.0))
+        {
+            output(Styled("[✗]", Theme::Error) + " Usage: fast_forward(n) or fast_forward(n, tol)");
+            return;
+        }
+
+        double gdpBefore = simulation.currentStats.gdp;
+        int dayBefore = simulation.dayCount;
+        fastForwarder ff(simulation, tol);
+        auto start = std::chrono::steady_clock::now();
+        for (long long i = 0; i < n; i++)
+        {
+            ff.step();
+            recorder.record(simulation);
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        requestHeaderRefresh();
+
+        const fastForwarder::report &r = ff.stats();
+        auto line = [&](const std::string &key, const std::string &value)
+        {
+            std::cout << "    " << Styled(padStr(key, 22), Theme::Info) << Styled(value, Theme::Highlight) << "\n";
+        };
+        sH("FAST FORWARD", "day " + std::to_string(dayBefore) + "  →  " + std::to_string(simulation.dayCount) +
+                               "  ·  tolerance " + fmtD(tol * 100.0, 3) + "%");
+        line("Full days", std::to_string(r.full));
+        line("Approximated days", std::to_string(r.approximated) + "  (" +
+                                      fmtD(100.0 * r.approximated / std::max(1LL, r.full + r.approximated), 1) + "%)");
+        line("Longest quiet run", std::to_string(r.longestRun) + " days");
+        line("GDP", "Tk " + fmtD(gdpBefore) + "  →  Tk " + fmtD(simulation.currentStats.gdp));
+        line("Wall time", fmtD(ms, 1) + " ms");
+        hline();
+        noteText("Approximated days keep prices and spending, skip curve updates and shocks");
+        bln();
+    }
+
     void cmdPassDay(const Command &cmd)
     {
         int n = getParam<int>(cmd, "n", 1);
@@ -1880,9 +2539,9 @@ public:
         if (n > 1)
         {
             double gdpBefore = simulation.currentStats.gdp;
-            std::map<std::string, double> pricesBefore;
+            std::vector<double> pricesBefore; // by market index
             for (auto &m : simulation.markets)
-                pricesBefore[m.prod->name] = m.price;
+                pricesBefore.push_back(m.price);
 
             std::cout << "\n"
                       << Styled("  ◆ SIMULATING " + std::to_string(n) + " DAYS", Theme::BoldPrimary)
@@ -1890,9 +2549,10 @@ public:
 
             for (int i = 0; i < n; i++)
             {
-                simulation.pass_day();
+                stepDay();
                 std::cout << Styled(".", Theme::Primary) << std::flush;
-                std::this_thread::sleep_for(std::chrono::milliseconds(80));
+                if (animate)
+                    std::this_thread::sleep_for(std::chrono::milliseconds(80));
             }
             std::cout << "\n\n";
 
@@ -1905,10 +2565,10 @@ public:
                       << Styled("  →  ", Theme::Info)
                       << Styled("Tk " + fmtD(gdpAfter), Theme::Highlight) << "\n";
 
-            for (auto &m : simulation.markets)
+            for (size_t mi = 0; mi < simulation.markets.size(); mi++)
             {
-                auto pit = pricesBefore.find(m.prod->name);
-                double prevPrice = (pit != pricesBefore.end()) ? pit->second : 0.0;
+                auto &m = simulation.markets[mi];
+                double prevPrice = mi < pricesBefore.size() ? pricesBefore[mi] : 0.0;
                 if (m.price < 0.1 && prevPrice < 0.1)
                     continue;
                 double diff = m.price - prevPrice;
@@ -1929,9 +2589,10 @@ public:
         // n == 1 → full animated pass
         using namespace styledTerminal;
 
-        auto pause = [](int ms)
+        auto pause = [this](int ms)
         {
-            std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+            if (animate)
+                std::this_thread::sleep_for(std::chrono::milliseconds(ms));
         };
 
         auto dots = [&pause](int count, int delayMs)
@@ -2064,14 +2725,6 @@ public:
         for (auto &c : simulation.consumers)
             consSnap.push_back({c.name, c.savings, c.expenses, c.incomePerDay});
 
-        // crops vector stores copies — look up maxOutput by name via the ss map keys
-        auto getMaxOutput = [](const farmer &f, const std::string &cropName) -> double
-        {
-            for (auto &[ptr, val] : f.maxOutput)
-                if (ptr && ptr->name == cropName)
-                    return val;
-            return 0.0;
-        };
 
         std::vector<FarmSnap> farmSnap;
         for (auto &f : simulation.farmers)
@@ -2081,8 +2734,8 @@ public:
             s.savings = f.savings;
             s.weather = f.weather;
             s.tax = f.tax;
-            for (auto &crop : f.crops)
-                s.cropMax.push_back({crop.name, getMaxOutput(f, crop.name)});
+            for (size_t ci = 0; ci < f.crops.size(); ci++)
+                s.cropMax.push_back({f.crops[ci].name, f.maxOutput[ci]});
             farmSnap.push_back(s);
         }
 
@@ -2096,7 +2749,7 @@ public:
             const_cast<firm &>(f).calculateCosts();
             firmSnap.push_back({f.ownerId,
                                 f.currentOutput, f.totalCost, f.marginalCost, f.averageCost,
-                                (int)f.workers.size(), (int)f.capitals.size(), f.wage});
+                                (int)f.workers.size(), (int)f.capitals.count(), f.wage});
         }
 
         double gdpBefore = simulation.currentStats.gdp;
@@ -2117,7 +2770,7 @@ public:
                   << Styled(Separator(sw - 2), Theme::Primary) << "\n";
 
         // ── RUN SIMULATION ────────────────────────────────────────────────
-        simulation.pass_day();
+        stepDay();
 
         // ── PHASE 1: MARKETS ──────────────────────────────────────────────
         phaseHeader("PHASE 1 — MARKETS CLEARING & PRICES ADJUSTING");
@@ -2146,10 +2799,12 @@ public:
         // ── PHASE 2: CONSUMERS ────────────────────────────────────────────
         phaseHeader("PHASE 2 — CONSUMERS RESPONDING TO PRICES");
 
-        for (size_t i = 0; i < simulation.consumers.size() && i < consSnap.size(); i++)
+        size_t ci = 0; // snapshots were taken in the same (slot) order
+        for (auto &c : simulation.consumers)
         {
-            auto &c = simulation.consumers[i];
-            auto &snap = consSnap[i];
+            if (ci >= consSnap.size())
+                break;
+            auto &snap = consSnap[ci++];
             entityLabel(snap.name);
             row("Savings ($)", snap.savings, c.savings);
             row("Expenses ($)", snap.expenses, c.expenses);
@@ -2159,10 +2814,12 @@ public:
         // ── PHASE 3: FARMERS ──────────────────────────────────────────────
         phaseHeader("PHASE 3 — FARMERS UPDATING SUPPLY");
 
-        for (size_t i = 0; i < simulation.farmers.size() && i < farmSnap.size(); i++)
+        size_t fi = 0; // snapshots were taken in the same (slot) order
+        for (auto &f : simulation.farmers)
         {
-            auto &f = simulation.farmers[i];
-            auto &snap = farmSnap[i];
+            if (fi >= farmSnap.size())
+                break;
+            auto &snap = farmSnap[fi++];
             entityLabel(snap.name + "  (Tech: " + fmt(f.techLevel * 100) + "%)");
             row("Savings ($)", snap.savings, f.savings);
             row("Weather index", snap.weather, f.weather);
@@ -2171,7 +2828,7 @@ public:
             for (size_t ci = 0; ci < snap.cropMax.size(); ci++)
             {
                 const std::string &cropName = snap.cropMax[ci].first;
-                double maxAfter = getMaxOutput(f, cropName);
+                double maxAfter = ci < f.maxOutput.size() ? f.maxOutput[ci] : 0.0;
                 row("  " + cropName + " max output",
                     snap.cropMax[ci].second, maxAfter, " units");
             }
@@ -2180,10 +2837,12 @@ public:
         // ── PHASE 4: LABORERS ─────────────────────────────────────────────
         phaseHeader("PHASE 4 — LABORERS & WAGES");
 
-        for (size_t i = 0; i < simulation.laborers.size() && i < labSnap.size(); i++)
+        size_t li = 0; // snapshots were taken in the same (slot) order
+        for (auto &l : simulation.laborers)
         {
-            auto &l = simulation.laborers[i];
-            auto &snap = labSnap[i];
+            if (li >= labSnap.size())
+                break;
+            auto &snap = labSnap[li++];
             entityLabel(snap.name + "  (Skill: " + fmt(l.skillLevel * 100) + "%)");
             row("Savings ($)", snap.savings, l.savings);
             row("Income/day ($)", snap.income, l.incomePerDay);
@@ -2205,7 +2864,7 @@ public:
                 }
 
             entityLabel(ownerName + "  [L=" + std::to_string((int)f.workers.size()) +
-                        "  K=" + std::to_string((int)f.capitals.size()) + "]");
+                        "  K=" + std::to_string((int)f.capitals.count()) + "]");
             row("Wage ($/worker)", snap.wage, f.wage);
             row("Output (Q)", snap.output, f.currentOutput, " units");
             row("Total Cost (TC) ($)", snap.tc, f.totalCost);
@@ -2272,18 +2931,11 @@ public:
 
     product *getProductByName(const std::string &name)
     {
-        std::vector<product *> prods = {&rice, &cloth, &computer, &phone, &car, &steel, &potato, &banana, &corn, &jute};
-        for (auto *p : prods)
-            if (p->name == name)
-                return p;
-        return nullptr;
+        return catalogue().find(name);
     }
 
     market *getMarketByProduct(product *p)
     {
-        for (auto &m : simulation.markets)
-            if (m.prod == p)
-                return &m;
-        return nullptr;
+        return p ? simulation.marketFor(p->id) : nullptr;
     }
 };
\ No newline at end of file
@@ -1,108 +1,148 @@
 #pragma once
-#include <map>
-#include <random>
 #include "consumer.h"
 #include "product.h"
-
-// supply curve: p = c + mQ
-struct supplyLine {
-    double m;
-    double c;
-};
+#include "rng.h"
 
 class farmer : public consumer {
 public:
     double land;
     double techLevel;
     double weather; // 0 - 1 random number
+    double weatherChange = 0.0; // set by drawWeather() before pass_day
 
     double tax;
 
+    // Per-crop state, parallel to crops: crops[i] <-> ss[i], growthRate[i], ...
+    // Crops are found by product id, so a copy and its global (e.g. &rice) match.
     std::vector<product> crops; // crops produced (n)
-    std::map<product*, supplyLine> ss;
-    std::map<product*, double> growthRate;
-    std::map<product*, double> decay;
-    std::map<product*, double> maxOutput;
+    std::vector<supplyLine> ss;
+    std::vector<double> growthRate;
+    std::vector<double> decay;
+    std::vector<double> maxOutput;
+
+    // Mirror of ss in the world's supplyStore, which markets aggregate from.
+    // Every write to ss goes out through publishSupply().
+    supplyStore *supplyLedger = nullptr;
+    int supplyRow = -1;
 
     farmer(int id, const std::string& name, int age, double land, double techLevel) : consumer(id, name, age), land(land), techLevel(techLevel) {
 
     }
     void addCrop(product* prod, supplyLine supply, double growth, double decayRate, double initialMax) {
         crops.push_back(*prod);
-        ss[prod] = supply;
-        growthRate[prod] = growth;
-        decay[prod] = decayRate;
-        maxOutput[prod] = initialMax;
+        ss.push_back(supply);
+        growthRate.push_back(growth);
+        decay.push_back(decayRate);
+        maxOutput.push_back(initialMax);
+        publishSupply(crops.size() - 1);
+    }
+
+    void publishSupply(size_t i) {
+        if (supplyLedger && supplyRow >= 0) {
+            int col = supplyLedger->column(&crops[i]);
+            if (col >= 0)
+                supplyLedger->set(col, supplyRow, ss[i]);
+        }
+    }
+
+    void publishSupply() {
+        for (size_t i = 0; i < crops.size(); i++)
+            publishSupply(i);
+    }
+
+    void die() override {
+        consumer::die();
+        if (supplyLedger && supplyRow >= 0)
+            supplyLedger->releaseRow(supplyRow);
+        supplyRow = -1;
+    }
+
+    // Index into the per-crop vectors, -1 if this farmer doesn't grow it
+    int cropIndex(const product* prod) const {
+        if (!prod)
+            return -1;
+        for (size_t i = 0; i < crops.size(); i++)
+            if (crops[i].id == prod->id)
+                return (int)i;
+        return -1;
+    }
+
+    bool grows(const product* prod) const { return cropIndex(prod) >= 0; }
+
+    supplyLine supplyOf(const product* prod) const {
+        int i = cropIndex(prod);
+        return i >= 0 ? ss[i] : supplyLine{0.0, 0.0};
+    }
+
+    double maxOutputOf(const product* prod) const {
+        int i = cropIndex(prod);
+        return i >= 0 ? maxOutput[i] : 0.0;
     }
 
     void upgradeTech(double newTechLevel) {
         techLevel = newTechLevel;
     }
 
-    double getCropMetricByName(const std::map<product *, double> &metric, const std::string &cropName) const
+    // Today's weather change, drawn from this farmer's own stream for the day
+    void drawWeather(rng::generator gen)
     {
-        for (const auto &[cropPtr, value] : metric)
-        {
-            if (cropPtr && cropPtr->name == cropName)
-                return value;
-        }
-        return 0.0;
+        weatherChange = (gen.uniform() - 0.5) * 0.3;
     }
 
-    void pass_day(double perCapita, const std::map<std::string, double> &prices = {}) override
+    void pass_day(double perCapita, const std::vector<double> &prices = {}) override
 {
     consumer::pass_day(perCapita, prices);
 
     // Weather varies with some persistence
-    double weatherChange = ((double)rand() / RAND_MAX - 0.5) * 0.3;
     weather = std::max(0.2, std::min(0.95, weather + weatherChange));
 
-    // IMPORTANT: iterate ss map (correct original product* keys), NOT crops vector.
-    // crops vector stores copies, so &crop != &rice — using &crop as key silently
-    // creates a new zero-entry and the real maxOutput[&rice] never updates.
-    for (auto& [cropPtr, supply] : ss)
+    for (size_t i = 0; i < crops.size(); i++)
     {
         double weatherBonus  = (weather > 0.6) ? (weather - 0.6) * 20.0 : 0.0;
-        maxOutput[cropPtr]  += growthRate[cropPtr] + weatherBonus;
+        maxOutput[i]  += growthRate[i] + weatherBonus;
 
         double weatherPenalty = (weather < 0.5) ? (0.5 - weather) * 50.0 : 0.0;
-        maxOutput[cropPtr]  -= decay[cropPtr] + weatherPenalty;
+        maxOutput[i]  -= decay[i] + weatherPenalty;
 
-        if (maxOutput[cropPtr] < 0.0) maxOutput[cropPtr] = 0.0;
+        if (maxOutput[i] < 0.0) maxOutput[i] = 0.0;
 
-        updateSupplyCurve(cropPtr);
+        updateSupplyCurve(&crops[i]);
     }
 }
 
-void updateSupplyCurve(product* crop)
+void updateSupplyCurve(const product* crop)
 {
-    if (ss.find(crop) != ss.end())
+    int i = cropIndex(crop);
+    if (i >= 0)
     {
         // Tech improvement lowers marginal cost (shifts supply right/down)
         double techEffect = techLevel * 2.0;
-        ss[crop].c = std::max(1.0, ss[crop].c - techEffect * 0.1);
+        ss[i].c = std::max(1.0, ss[i].c - techEffect * 0.1);
         
         // Bad weather increases marginal cost (shifts supply left/up)
         double weatherEffect = (1.0 - weather) * 3.0;
-        ss[crop].c += weatherEffect;
+        ss[i].c += weatherEffect;
         
         // Tax increases cost
-        ss[crop].c += tax * 5.0;
+        ss[i].c += tax * 5.0;
         
         // Land scarcity increases slope (harder to produce more)
-        ss[crop].m = 0.1 + (100.0 / std::max(1.0, land)) * 0.02;
+        ss[i].m = 0.1 + (100.0 / std::max(1.0, land)) * 0.02;
+
+        publishSupply(i);
     }
 }
 
-double calculateSupply(product* crop, double marketPrice)
+double calculateSupply(const product* crop, double marketPrice) const
 {
-    if (ss.find(crop) == ss.end()) return 0.0;
+    int i = cropIndex(crop);
+    if (i < 0) return 0.0;
     
     // Effective marginal cost includes all factors
-    double effectiveMC = ss[crop].c;
+    double effectiveMC = ss[i].c;
     
     // Adjust slope for weather difficulty
-    double effectiveSlope = ss[crop].m * (2.0 - weather);  // Bad weather steepens
+    double effectiveSlope = ss[i].m * (2.0 - weather);  // Bad weather steepens
     
     // Won't produce if price below MC
     if (marketPrice <= effectiveMC) return 0.0;
@@ -111,7 +151,7 @@ double calculateSupply(product* crop, double marketPrice)
     double quantity = (marketPrice - effectiveMC) / effectiveSlope;
     
     // Physical capacity constraint
-    quantity = std::min(quantity, maxOutput[crop]);
+    quantity = std::min(quantity, maxOutput[i]);
     
     return std::max(0.0, quantity);
 }
@@ -129,20 +169,23 @@ std::string getStyledDetails() const
     ss << KeyValue("Tax Rate", std::to_string(twoDecimal(tax * 100)) + "%") << "\n\n";
     
     ss << Styled("CROPS:\n", Theme::Primary);
-    for (const auto& crop : crops)
+    for (size_t i = 0; i < crops.size(); i++)
     {
-        double max = getCropMetricByName(maxOutput, crop.name);
-        ss << "  • " << crop.name 
-           << " (Max: " << twoDecimal(max) << " units)\n";
+        ss << "  • " << crops[i].name 
+           << " (Max: " << twoDecimal(maxOutput[i]) << " units)\n";
     }
     
     return ss.str();
 }
 
-    double calculateCropOutput(product* crop) {
+    double calculateCropOutput(const product* crop) const {
+        int i = cropIndex(crop);
+        if (i < 0)
+            return 0.0;
+
         // 1. Base Potential: Land * Growth Rate
         // If you have 10 acres and rice grows at 50 units/acre, potential is 500.
-        double basePotential = land * growthRate[crop];
+        double basePotential = land * growthRate[i];
 
         // 2. Weather Impact (The "Shock")
         // Weather is 0.0 to 1.0. 
@@ -160,40 +203,35 @@ std::string getStyledDetails() const
 
         // 5. Cap at Maximum Output
         // Even with perfect weather, land has a physical limit per acre.
-        double physicalLimit = land * maxOutput[crop]; 
+        double physicalLimit = land * maxOutput[i]; 
         double actualHarvest = std::min(grossHarvest, physicalLimit);
 
         // 6. Subtract Decay & Tax
         // Decay happens *during* the season (pests, rot).
         // Tax is taken by the government/landlord.
-        double netHarvest = actualHarvest * (1.0 - decay[crop]) * (1.0 - tax);
+        double netHarvest = actualHarvest * (1.0 - decay[i]) * (1.0 - tax);
 
         return std::max(0.0, netHarvest);
     }
 
-    double getRealisticLandSize() {
-        // Random number generator
-        static std::random_device rd;
-        static std::mt19937 gen(rd());
-        std::uniform_real_distribution<> dis(0.0, 1.0);
-        
-        double p = dis(gen); // Roll a dice (0.0 to 1.0)
+    static double getRealisticLandSize(rng::generator &gen) {
+        double p = gen.uniform(); // Roll a dice (0.0 to 1.0)
 
         // 1. Marginal Farmers (45%) -> 0.05 to 0.49 acres
         if (p < 0.45) {
-            return 0.05 + (dis(gen) * 0.44); 
+            return 0.05 + (gen.uniform() * 0.44); 
         }
         // 2. Small Farmers (45%) -> 0.50 to 2.49 acres
         else if (p < 0.90) {
-            return 0.50 + (dis(gen) * 1.99);
+            return 0.50 + (gen.uniform() * 1.99);
         }
         // 3. Medium Farmers (9%) -> 2.50 to 7.49 acres
         else if (p < 0.99) {
-            return 2.50 + (dis(gen) * 4.99);
+            return 2.50 + (gen.uniform() * 4.99);
         }
         // 4. Large Farmers (Top 1%) -> 7.50 to 15.0 acres
         else {
-            return 7.50 + (dis(gen) * 7.50);
+            return 7.50 + (gen.uniform() * 7.50);
         }
     }
 };
@@ -0,0 +1,97 @@
+#pragma once
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include "world.h"
+
+// Long-horizon stepping that approximates quiet stretches.
+//
+// Every day with a demand shock (dayCount % 7 == 0) runs the full pass_day.
+// So does any day that follows a full day on which some market price, or the
+// economy's total daily income, moved by more than `tolerance` (relative).
+// Once a full day comes out calm, every day up to the next shock day runs
+// as world::pass_quiet_day, so a quiet run is at most 6 days long.
+//
+//   fastForwarder ff(simulation, 0.001);
+//   for (int d = 0; d < 3650; d++)
+//       ff.step();
+//   ff.stats().approximated; // days that ran as quiet days
+class fastForwarder
+{
+public:
+    struct report
+    {
+        long long full = 0;
+        long long approximated = 0;
+        long long longestRun = 0; // most consecutive approximated days
+    };
+
+    explicit fastForwarder(world &w, double tolerance = 0.001) : w(w), tolerance(tolerance) {}
+
+    // Advance one day; true if it was approximated
+    bool step()
+    {
+        bool shockDay = (w.dayCount + 1) % 7 == 0;
+        if (quiet && !shockDay)
+        {
+            w.pass_quiet_day();
+            rep.approximated++;
+            rep.longestRun = std::max(rep.longestRun, (long long)++run);
+            return true;
+        }
+
+        run = 0;
+        capture(pricesBefore, incomeBefore);
+        w.pass_day();
+        rep.full++;
+        quiet = calm();
+        return false;
+    }
+
+    const report &stats() const { return rep; }
+
+private:
+    void capture(std::vector<double> &prices, double &income) const
+    {
+        prices.clear();
+        for (auto &m : w.markets)
+            prices.push_back(m.price);
+        income = totalIncome();
+    }
+
+    double totalIncome() const
+    {
+        double s = 0.0;
+        for (auto &c : w.consumers)
+            s += c.incomePerDay;
+        for (auto &f : w.farmers)
+            s += f.incomePerDay;
+        for (auto &l : w.laborers)
+            s += l.incomePerDay;
+        return s;
+    }
+
+    static bool near(double before, double after, double tol)
+    {
+        return std::fabs(after - before) <= tol * std::max(1.0, std::fabs(before));
+    }
+
+    // Every price and the total income held still over the last full day
+    bool calm() const
+    {
+        if (pricesBefore.size() != w.markets.size())
+            return false;
+        for (size_t i = 0; i < w.markets.size(); i++)
+            if (!near(pricesBefore[i], w.markets[i].price, tolerance))
+                return false;
+        return near(incomeBefore, totalIncome(), tolerance);
+    }
+
+    world &w;
+    double tolerance;
+    bool quiet = false; // the last full day was calm: approximate until the next shock day
+    int run = 0;
+    std::vector<double> pricesBefore;
+    double incomeBefore = 0.0;
+    report rep;
+};
@@ -4,32 +4,79 @@
 #include "consumer.h"
 #include <iostream>
 #include <cmath>
+#include <algorithm>
+#include <array>
 
 struct productionFunction
 {
-    double tech;
+    double tech = 1.0;
     virtual double output(double L, double K) = 0; // pure virtual function makes this an abstract class
     virtual ~productionFunction() = default;
 };
 
-struct cobbDouglas : productionFunction
+// Q(L,K) together with the one-step neighbours the firm needs every day
+struct outputPoint
+{
+    double q;  // Q(L, K)
+    double qL; // Q(L+1, K)
+    double qK; // Q(L, K+1)
+};
+
+// CRTP layer: Derived::eval is called directly (and inlined) by the firm, the
+// virtual output() stays for code that only holds a productionFunction*.
+// Derived may provide a cheaper around() that shares work between the three
+// points; the default just evaluates them one by one.
+template <class Derived>
+struct productionFunctionBase : productionFunction
 {
-    double alpha, beta, tech;
-    cobbDouglas(double alpha, double beta, double tech = 1.0) : alpha(alpha), beta(beta), tech(tech) {}
     double output(double L, double K) override
+    {
+        return static_cast<Derived *>(this)->eval(L, K);
+    }
+
+    outputPoint around(double L, double K) const
+    {
+        const Derived &d = static_cast<const Derived &>(*this);
+        return {d.eval(L, K), d.eval(L + 1, K), d.eval(L, K + 1)};
+    }
+};
+
+struct cobbDouglas : productionFunctionBase<cobbDouglas>
+{
+    double alpha, beta;
+    cobbDouglas(double alpha, double beta, double tech = 1.0) : alpha(alpha), beta(beta)
+    {
+        this->tech = tech;
+    }
+    double eval(double L, double K) const
     {
         return pow(L, alpha) * pow(K, beta) * tech;
     }
+    // 4 pow calls instead of 6: L^a, (L+1)^a, K^b, (K+1)^b
+    outputPoint around(double L, double K) const
+    {
+        double la = pow(L, alpha), la1 = pow(L + 1, alpha);
+        double kb = pow(K, beta), kb1 = pow(K + 1, beta);
+        return {la * kb * tech, la1 * kb * tech, la * kb1 * tech};
+    }
 };
 
-struct ces : productionFunction
+struct ces : productionFunctionBase<ces>
 {
     double rho;
     ces(double rho) : rho(rho) {}
-    double output(double L, double K) override
+    double eval(double L, double K) const
     {
         return pow(pow(L, rho) + pow(K, rho), 1.0 / rho);
     }
+    // 7 pow calls instead of 9: L^r, (L+1)^r, K^r, (K+1)^r shared
+    outputPoint around(double L, double K) const
+    {
+        double lr = pow(L, rho), lr1 = pow(L + 1, rho);
+        double kr = pow(K, rho), kr1 = pow(K + 1, rho);
+        double inv = 1.0 / rho;
+        return {pow(lr + kr, inv), pow(lr1 + kr, inv), pow(lr + kr1, inv)};
+    }
 };
 
 class firm
@@ -44,10 +91,10 @@ public:
     double cash; // how much money they have to invest
 
     int ownerId; // for simplicity, each firm has one owner (a consumer)
-    std::vector<laborer> workers;
-    std::vector<capital> capitals;
+    std::vector<int> workers; // ids of employed laborers (see world::employment)
+    capitalStock capitals; // machines as running totals and vintages
 
-    std::vector<product> products; // goods produced (n)
+    std::vector<int> productIds; // registry ids of goods produced (n)
 
     double wage;
     double fixed_overhead;
@@ -66,6 +113,21 @@ public:
     productionFunction *prodFunc;
     ProdType prodType;
 
+private:
+    void reserveHeadroom()
+    {
+        workers.reserve(MAX_AUTO_WORKERS);
+        capitals.reserve(capitals.vintages().size() + VINTAGE_HEADROOM);
+    }
+
+    outputPoint cached{0.0, 0.0, 0.0};
+    int cachedL = -1, cachedK = -1;
+
+    // Inputs the cost figures were last computed from (see calculateCosts)
+    int costL = -1, costK = -1;
+    double costWage = 0.0, costOverhead = 0.0;
+
+public:
     firm(int id, double cash, cobbDouglas cd)
         : cash(cash), ownerId(id), wage(0.0), fixed_overhead(0.0),
           totalFixedCost(0.0), totalVariableCost(0.0), totalCost(0.0),
@@ -73,6 +135,7 @@ public:
           marginalCost(0.0), currentOutput(0.0),
           cdProd(cd), cesProd(0), prodFunc(&cdProd), prodType(ProdType::CobbDouglas)
     {
+        reserveHeadroom();
     }
     firm(int id, double cash, ces c)
         : cash(cash), ownerId(id), wage(0.0), fixed_overhead(0.0),
@@ -81,6 +144,7 @@ public:
           marginalCost(0.0), currentOutput(0.0),
           cdProd(0, 0), cesProd(c), prodFunc(&cesProd), prodType(ProdType::Ces)
     {
+        reserveHeadroom();
     }
 
     firm(const firm &other)
@@ -88,7 +152,7 @@ public:
           ownerId(other.ownerId),
           workers(other.workers),
           capitals(other.capitals),
-          products(other.products),
+          productIds(other.productIds),
           wage(other.wage),
           fixed_overhead(other.fixed_overhead),
           totalFixedCost(other.totalFixedCost),
@@ -105,6 +169,7 @@ public:
           prodType(other.prodType)
     {
         bindProdFunc();
+        reserveHeadroom();
     }
 
     firm &operator=(const firm &other)
@@ -115,7 +180,7 @@ public:
         ownerId = other.ownerId;
         workers = other.workers;
         capitals = other.capitals;
-        products = other.products;
+        productIds = other.productIds;
         wage = other.wage;
         fixed_overhead = other.fixed_overhead;
         totalFixedCost = other.totalFixedCost;
@@ -130,6 +195,7 @@ public:
         cesProd = other.cesProd;
         prodType = other.prodType;
         bindProdFunc();
+        invalidateOutput();
         return *this;
     }
 
@@ -138,7 +204,7 @@ public:
           ownerId(other.ownerId),
           workers(std::move(other.workers)),
           capitals(std::move(other.capitals)),
-          products(std::move(other.products)),
+          productIds(std::move(other.productIds)),
           wage(other.wage),
           fixed_overhead(other.fixed_overhead),
           totalFixedCost(other.totalFixedCost),
@@ -165,7 +231,7 @@ public:
         ownerId = other.ownerId;
         workers = std::move(other.workers);
         capitals = std::move(other.capitals);
-        products = std::move(other.products);
+        productIds = std::move(other.productIds);
         wage = other.wage;
         fixed_overhead = other.fixed_overhead;
         totalFixedCost = other.totalFixedCost;
@@ -180,6 +246,7 @@ public:
         cesProd = other.cesProd;
         prodType = other.prodType;
         bindProdFunc();
+        invalidateOutput();
         return *this;
     }
 
@@ -189,38 +256,77 @@ public:
                                                        : static_cast<productionFunction *>(&cesProd);
     }
 
-    double getCapitalCost()
+    bool employs(int laborerId) const
+    {
+        return std::find(workers.begin(), workers.end(), laborerId) != workers.end();
+    }
+
+    bool makes(int productId) const
+    {
+        for (int id : productIds)
+            if (id == productId)
+                return true;
+        return false;
+    }
+
+    // ── HEADROOM ──────────────────────────────────────────────────────────
+    // Worker and vintage lists start with spare capacity so hiring and
+    // investing inside the day loop do not allocate: auto-hiring stops at
+    // MAX_AUTO_WORKERS, and a new vintage opens only once a simulated year
+    // (VINTAGE_HEADROOM years are reserved at a time).
+    static constexpr size_t MAX_AUTO_WORKERS = 8;
+    static constexpr size_t VINTAGE_HEADROOM = 16;
+
+    // `day` picks the machine's vintage (see capitalStock)
+    void addCapital(double rentalRate, double efficiency, int day = 0)
     {
-        double capitalCost = 0.0;
-        for (const auto &cap : capitals)
+        if (capitals.vintages().size() == capitals.capacity())
+            capitals.reserve(capitals.vintages().size() + VINTAGE_HEADROOM);
+        capitals.add({rentalRate, efficiency}, day);
+    }
+
+    // Summed machine rentals, O(1) (kept by capitalStock)
+    double getCapitalCost() const { return capitals.rental(); }
+
+    // ── PRODUCTION CACHE ──────────────────────────────────────────────────
+    // Q(L,K), Q(L+1,K) and Q(L,K+1) for the current head counts. Output only
+    // depends on the number of workers and machines, so the cache is keyed on
+    // (L, K) and hiring, firing or adding capital invalidates it by changing
+    // the key. Call invalidateOutput() after editing cdProd / cesProd; it
+    // also marks the cost figures stale.
+    const outputPoint &outputs()
+    {
+        int L = (int)workers.size();
+        int K = capitals.count();
+        if (L != cachedL || K != cachedK)
         {
-            capitalCost += cap.rentalRate;
+            cached = (prodType == ProdType::CobbDouglas) ? cdProd.around(L, K)
+                                                         : cesProd.around(L, K);
+            cachedL = L;
+            cachedK = K;
         }
-        return capitalCost;
+        return cached;
     }
 
+    void invalidateOutput() { cachedL = cachedK = costL = costK = -1; }
+
     double MPofLabor()
     {
-        int L = workers.size();
-        int K = capitals.size();
-        double currentQ = prodFunc->output(L, K);
-        double newQ = prodFunc->output(L + 1, K);
-        return newQ - currentQ;
+        const outputPoint &p = outputs();
+        return p.qL - p.q;
     }
 
     // "How much does adding 1 more machine help me right now?"
     double MPofCapital()
     {
-        int L = workers.size();
-        int K = capitals.size();
-        double currentQ = prodFunc->output(L, K);
-        double newQ = prodFunc->output(L, K + 1);
-        return newQ - currentQ;
+        const outputPoint &p = outputs();
+        return p.qK - p.q;
     }
 
     // 3. THE OPTIMIZER (Finding the Tangency Point)
     // This function runs every turn to re-balance the firm.
-    std::vector<double> marginalCosts()
+    // {MPL/w, MPK/r}
+    std::array<double, 2> marginalCosts()
     {
         double mpL = MPofLabor();
         double mpK = MPofCapital();
@@ -250,13 +356,23 @@ public:
         return {laborRatio, capitalRatio};
     }
 
+    // Refreshes the cost figures when an input has changed since the last
+    // call (head counts, wage, overhead; capital rentals only change through
+    // addCapital, which changes K), so repeated calls in a day are free
     void calculateCosts()
     {
+        if ((int)workers.size() == costL && capitals.count() == costK &&
+            wage == costWage && fixed_overhead == costOverhead)
+            return;
+        costL = (int)workers.size();
+        costK = capitals.count();
+        costWage = wage;
+        costOverhead = fixed_overhead;
+
         double L = workers.size();
-        double K = capitals.size();
 
         // Q
-        currentOutput = prodFunc->output(L, K);
+        currentOutput = outputs().q;
 
         // TFC = Overhead (Building) + Machine Rentals
         totalFixedCost = fixed_overhead + getCapitalCost();
@@ -306,7 +422,7 @@ public:
         ss << Header("FIRM (Owner ID: " + std::to_string(ownerId) + ")") << "\n";
         ss << KeyValue("Cash", "Tk " + std::to_string(twoDecimal(cash))) << "\n";
         ss << KeyValue("Workers", std::to_string(workers.size())) << "\n";
-        ss << KeyValue("Capital Units", std::to_string(capitals.size())) << "\n";
+        ss << KeyValue("Capital Units", std::to_string(capitals.count())) << "\n";
         ss << KeyValue("Wage Rate", "Tk " + std::to_string(twoDecimal(wage))) << "\n\n";
 
         ss << Styled("PRODUCTION:\n", Theme::Primary);
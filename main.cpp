@@ -1,12 +1,43 @@
 #include "world.h"
 #include "style.h"
 #include "cli.h"
+#include "batch.h"
+#include "script.h"
+#include "sweep.h"
+#include "outputsink.h"
 
-int main()
+int main(int argc, char **argv)
 {
+    if (batchRunner::wantsBatch(argc, argv))
+    {
+        batchRunner::options opt;
+        if (!batchRunner::parseArgs(argc, argv, opt))
+            return 1;
+        world world;
+        return batchRunner(world, opt).run() ? 0 : 1;
+    }
+
+    if (sweepRunner::wantsSweep(argc, argv))
+    {
+        sweepRunner::options opt;
+        if (!sweepRunner::parseArgs(argc, argv, opt))
+            return 1;
+        return sweepRunner(opt).run() ? 0 : 1;
+    }
+
+    if (scriptRunner::wantsScript(argc, argv))
+    {
+        scriptRunner::options opt;
+        if (!scriptRunner::parseArgs(argc, argv, opt))
+            return 1;
+        return scriptRunner(opt).run() == 0 ? 0 : 1;
+    }
+
     styledTerminal::Init(); // Initialize terminal for color support (Windows)
+    styledTerminal::plainText = outputSink::wantsPlain(argc, argv);
+    outputSink sink(std::cout, styledTerminal::plainText);
     world world;
     cli cli_interface(world);
     cli_interface.run();
     return 0;
-}
\ No newline at end of file
+}
@@ -7,6 +7,8 @@
 #include "laborer.h"
 #include "firm.h"
 #include "product.h"
+#include "agentstore.h"
+#include "ringbuffer.h"
 
 class market
 {
@@ -33,37 +35,13 @@ public:
 
     market(product *prod) : prod(prod), aggregateDemand({0, 0}), aggregateSupply({0, 0}) {}
 
-    // Aggregate demand curves from consumers, farmers, and laborers
+    // Aggregate demand curves from every agent row in the world's demand store
     // Q = sum(c/m) - sum(1/m) * p
-    void calculateAggregateDemand(const std::vector<consumer> &consumers,
-                                  const std::vector<farmer> &farmers,
-                                  const std::vector<laborer> &laborers)
+    void calculateAggregateDemand(const demandStore &store)
     {
         double totalInvM = 0.0; // sum of 1/m
         double cByM = 0.0;      // sum of c/m
-
-        auto collectDemand = [&](const consumer &agent)
-        {
-            auto it = agent.dd.find(prod);
-            if (it == agent.dd.end())
-                return;
-
-            double slope = it->second.m;
-            if (slope <= 0.000001)
-                return;
-
-            totalInvM += 1.0 / slope;
-            cByM += it->second.c / slope;
-        };
-
-        for (const auto &c : consumers)
-            collectDemand(c);
-
-        for (const auto &f : farmers)
-            collectDemand(static_cast<const consumer &>(f));
-
-        for (const auto &l : laborers)
-            collectDemand(static_cast<const consumer &>(l));
+        store.aggregate(store.column(prod), totalInvM, cByM);
 
         if (totalInvM <= 0.000001)
         {
@@ -76,53 +54,25 @@ public:
         }
     }
 
-    // Aggregate all farmer supply curves
+    // Aggregate all farmer supply curves from the world's supply store
     // Q = sum(c/m) + sum(1/m) * p  (horizontal summation)
-    void calculateAggregateSupply(const std::vector<farmer> &farmers,
+    void calculateAggregateSupply(const supplyStore &supply,
                                    const std::vector<firm>   &firms = {})
     {
         double totalInvM = 0.0;
         double cByM      = 0.0;
 
         // ── Farmer supply ─────────────────────────────────────────────────
-        for (const auto &f : farmers)
-        {
-            auto it = f.ss.find(prod);
-            if (it == f.ss.end()) continue;
-            double slope = it->second.m;
-            if (slope <= 0.000001) continue;
-            totalInvM += 1.0 / slope;
-            cByM      += it->second.c / slope;
-        }
+        supply.aggregate(supply.column(prod), totalInvM, cByM);
 
         // ── Firm supply ───────────────────────────────────────────────────
-        // Each firm that makes this product contributes a linearised supply
-        // curve derived from its current MC.
-        // Scale: 1 production-function unit ≈ 80 market units (calibration).
-        static constexpr double OUTPUT_SCALE = 80.0;
-
         for (const auto &fi : firms)
         {
-            // Does this firm make this product?
-            bool makes = false;
-            for (const auto &p : fi.products)
-                if (p.name == prod->name) { makes = true; break; }
-            if (!makes) continue;
-            if (fi.currentOutput < 0.001) continue;
-
-            // Effective per-market-unit MC
-            double effMC = fi.marginalCost / OUTPUT_SCALE;
-            if (effMC < 0.5) effMC = fi.wage / OUTPUT_SCALE;  // fallback
-
-            // Upward-sloping supply: P = intercept + slope*Q
-            // Intercept = effMC*0.5 (sell once price covers half of MC — overhead covered by revenue)
-            // Slope      = effMC / (fi.currentOutput * OUTPUT_SCALE)
-            double intercept = effMC * 0.5;
-            double slope     = effMC / (fi.currentOutput * OUTPUT_SCALE);
-            if (slope <= 0.000001) continue;
-
-            totalInvM += 1.0 / slope;
-            cByM      += intercept / slope;
+            supplyLine line;
+            if (!firmSupply(fi, line))
+                continue;
+            totalInvM += 1.0 / line.m;
+            cByM      += line.c / line.m;
         }
 
         if (totalInvM <= 0.000001)
@@ -136,6 +86,29 @@ public:
         }
     }
 
+    // Each firm that makes this product contributes a linearised supply
+    // curve derived from its current MC; false if it does not supply here.
+    // Scale: 1 production-function unit ≈ 80 market units (calibration).
+    bool firmSupply(const firm &fi, supplyLine &line) const
+    {
+        static constexpr double OUTPUT_SCALE = 80.0;
+
+        // Does this firm make this product?
+        if (!fi.makes(prod->id)) return false;
+        if (fi.currentOutput < 0.001) return false;
+
+        // Effective per-market-unit MC
+        double effMC = fi.marginalCost / OUTPUT_SCALE;
+        if (effMC < 0.5) effMC = fi.wage / OUTPUT_SCALE;  // fallback
+
+        // Upward-sloping supply: P = intercept + slope*Q
+        // Intercept = effMC*0.5 (sell once price covers half of MC — overhead covered by revenue)
+        // Slope      = effMC / (fi.currentOutput * OUTPUT_SCALE)
+        line.c = effMC * 0.5;
+        line.m = effMC / (fi.currentOutput * OUTPUT_SCALE);
+        return line.m > 0.000001;
+    }
+
     // Find equilibrium price and quantity
     struct equilibrium
     {
@@ -147,13 +120,17 @@ public:
 
     double excessDemand = 0.0;         // Track disequilibrium
     double priceAdjustmentSpeed = 0.1; // How fast prices adjust
-    std::vector<double> priceHistory;  // Price recorded each pass_day
+    static constexpr size_t HISTORY_DAYS = 30;
+    ringBuffer<double, HISTORY_DAYS> priceHistory; // Closing price of the last HISTORY_DAYS days
 
-    // Replace findEquilibrium with dynamic adjustment
-    equilibrium findEquilibrium()
+    // Equilibrium found by the last world::updateAllMarkets (see marketTable)
+    equilibrium cleared{0.0, 0.0};
+
+    // Where the current curves cross; no side effects
+    equilibrium solve() const
     {
         double denominator = aggregateDemand.m + aggregateSupply.m;
-        if (denominator < 0.0001)
+        if (denominator < EMPTY_CURVE_SLOPE)
             return {price, 0.0};
 
         double Q = (aggregateDemand.c - aggregateSupply.c) / denominator;
@@ -162,15 +139,19 @@ public:
         // Ensure non-negative
         Q = std::max(0.0, Q);
         P = std::max(0.1, P);
+        return {P, Q};
+    }
 
+    // solve(), also refreshing excessDemand at the current price
+    equilibrium findEquilibrium()
+    {
         excessDemand = getQuantityDemanded(price) - getQuantitySupplied(price);
-
-        return {P, Q};
+        return solve();
     }
 
     double getQuantityDemanded(double p)
     {
-        if (aggregateDemand.m < 0.0001)
+        if (aggregateDemand.m < EMPTY_CURVE_SLOPE)
             return 0.0;
         double qd = (aggregateDemand.c - p) / aggregateDemand.m;
         return std::max(0.0, qd);
@@ -178,7 +159,7 @@ public:
 
     double getQuantitySupplied(double p)
     {
-        if (aggregateSupply.m < 0.0001)
+        if (aggregateSupply.m < EMPTY_CURVE_SLOPE)
             return 0.0;
         double qs = (p - aggregateSupply.c) / aggregateSupply.m;
         return std::max(0.0, qs);
@@ -193,10 +174,8 @@ public:
         // Floor and ceiling
         price = std::max(0.5, std::min(1000.0, price));
 
-        // Record history (keep last 30 days)
+        // Record the day's closing price (full history: see recorder.h)
         priceHistory.push_back(price);
-        if (priceHistory.size() > 30)
-            priceHistory.erase(priceHistory.begin());
     }
 
     std::string getStyledDetails() const
@@ -223,12 +202,11 @@ public:
 double quantityTraded = 0.0;  // Track actual trades
 double revenue = 0.0;         // Price × Quantity traded
 
-void clearMarket(const std::vector<consumer> &allConsumers,
-                 const std::vector<farmer> &allFarmers,
-                 const std::vector<laborer> &allLaborers)
+void clearMarket(const demandStore &store,
+                 const supplyStore &supply)
 {
-    calculateAggregateDemand(allConsumers, allFarmers, allLaborers);
-    calculateAggregateSupply(allFarmers);
+    calculateAggregateDemand(store);
+    calculateAggregateSupply(supply);
     
     auto eq = findEquilibrium();
     
@@ -237,8 +215,8 @@ void clearMarket(const std::vector<consumer> &allConsumers,
     revenue = eq.price * eq.quantity;
     price = eq.price;
     
-    // Distribute goods to consumers (simplified)
-    // In reality, you'd allocate based on willingness to pay
+    // Aggregate view only: per-agent allocations come from the order books
+    // (world::matchOrders, see orderbook.h)
 }
 
 std::string getStyledEquilibrium()
@@ -0,0 +1,134 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include "agentstore.h"
+
+#if (defined(__SSE2__) || defined(_M_X64)) && !defined(CPPCONOMY_NO_SIMD)
+#include <emmintrin.h>
+#define CPPCONOMY_SSE2 1
+#endif
+
+// Every market's curves and price as parallel arrays, one slot per market.
+//
+// solve() clears all markets and adjust() applies one tâtonnement step to all
+// of them, each in a single pass over contiguous doubles. On x86-64 both run
+// two markets per SSE2 instruction; clamps and branches are compare + blend
+// selects that give exactly the scalar results (NaN included), and the scalar
+// code handles the tail, other targets and -DCPPCONOMY_NO_SIMD builds.
+// Slot i is world::markets[i]; the world gathers curves in and scatters
+// results out.
+class marketTable
+{
+public:
+    // Inputs: aggregate curves, current price, adjustment speed
+    std::vector<double> demandM, demandC, supplyM, supplyC;
+    std::vector<double> price, speed;
+
+    // Outputs of solve(): the day's equilibrium and excess demand at `price`
+    std::vector<double> eqPrice, eqQuantity, excessDemand;
+
+    void resize(size_t n)
+    {
+        for (auto *v : {&demandM, &demandC, &supplyM, &supplyC, &price, &speed,
+                        &eqPrice, &eqQuantity, &excessDemand})
+            v->resize(n, 0.0);
+    }
+
+    size_t size() const { return price.size(); }
+
+    // market::solve for every market, then the clearing rule of
+    // world::updateAllMarkets: take the equilibrium price only when both
+    // curves are non-trivial, otherwise keep the price (floored at 0.1).
+    // Excess demand is measured at the resulting price, which is what the
+    // original pass_day's tâtonnement saw once calculateStats re-solved each
+    // market after clearing.
+    void solve()
+    {
+        size_t n = size(), i = 0;
+#ifdef CPPCONOMY_SSE2
+        const __m128d tiny = _mm_set1_pd(EMPTY_CURVE_SLOPE), floorP = _mm_set1_pd(0.1);
+        const __m128d zero = _mm_setzero_pd(), one = _mm_set1_pd(1.0);
+        for (; i + 2 <= n; i += 2)
+        {
+            __m128d dm = _mm_loadu_pd(&demandM[i]), dc = _mm_loadu_pd(&demandC[i]);
+            __m128d sm = _mm_loadu_pd(&supplyM[i]), sc = _mm_loadu_pd(&supplyC[i]);
+            __m128d cur = _mm_loadu_pd(&price[i]);
+
+            __m128d den = _mm_add_pd(dm, sm);
+            __m128d crosses = _mm_cmpge_pd(den, tiny);
+            __m128d q = _mm_div_pd(_mm_sub_pd(dc, sc), select(crosses, den, one));
+            __m128d pe = _mm_sub_pd(dc, _mm_mul_pd(dm, q));
+            __m128d solvedP = select(crosses, select(_mm_cmpgt_pd(pe, floorP), pe, floorP), cur);
+            __m128d solvedQ = _mm_and_pd(crosses, _mm_and_pd(_mm_cmpgt_pd(q, zero), q));
+            _mm_storeu_pd(&eqPrice[i], solvedP);
+            _mm_storeu_pd(&eqQuantity[i], solvedQ);
+
+            __m128d take = _mm_and_pd(_mm_and_pd(_mm_cmpgt_pd(dm, tiny), _mm_cmpgt_pd(sm, tiny)),
+                                      _mm_cmpgt_pd(solvedP, floorP));
+            __m128d floored = select(_mm_cmplt_pd(cur, floorP), floorP, cur);
+            __m128d next = select(take, solvedP, floored);
+            _mm_storeu_pd(&price[i], next);
+
+            __m128d demandLive = _mm_cmpge_pd(dm, tiny), supplyLive = _mm_cmpge_pd(sm, tiny);
+            __m128d qd = _mm_div_pd(_mm_sub_pd(dc, next), select(demandLive, dm, one));
+            __m128d qs = _mm_div_pd(_mm_sub_pd(next, sc), select(supplyLive, sm, one));
+            qd = _mm_and_pd(_mm_and_pd(demandLive, _mm_cmpgt_pd(qd, zero)), qd);
+            qs = _mm_and_pd(_mm_and_pd(supplyLive, _mm_cmpgt_pd(qs, zero)), qs);
+            _mm_storeu_pd(&excessDemand[i], _mm_sub_pd(qd, qs));
+        }
+#endif
+        for (; i < n; i++)
+            solveOne(i);
+    }
+
+    // Walrasian step for every market: p += speed * excess, kept in [0.5, 1000]
+    void adjust()
+    {
+        size_t n = size(), i = 0;
+#ifdef CPPCONOMY_SSE2
+        const __m128d lo = _mm_set1_pd(0.5), hi = _mm_set1_pd(1000.0);
+        for (; i + 2 <= n; i += 2)
+        {
+            __m128d p = _mm_add_pd(_mm_loadu_pd(&price[i]),
+                                   _mm_mul_pd(_mm_loadu_pd(&speed[i]), _mm_loadu_pd(&excessDemand[i])));
+            p = select(_mm_cmplt_pd(p, hi), p, hi); // std::min(1000.0, p)
+            p = select(_mm_cmpgt_pd(p, lo), p, lo); // std::max(0.5, p)
+            _mm_storeu_pd(&price[i], p);
+        }
+#endif
+        for (; i < n; i++)
+            price[i] = std::max(0.5, std::min(1000.0, price[i] + speed[i] * excessDemand[i]));
+    }
+
+private:
+#ifdef CPPCONOMY_SSE2
+    // mask ? a : b, lane by lane
+    static __m128d select(__m128d mask, __m128d a, __m128d b)
+    {
+        return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+    }
+#endif
+
+    void solveOne(size_t i)
+    {
+        double dm = demandM[i], dc = demandC[i], sm = supplyM[i], sc = supplyC[i];
+        double cur = price[i];
+
+        double den = dm + sm;
+        bool crosses = den >= EMPTY_CURVE_SLOPE;
+        double q = (dc - sc) / (crosses ? den : 1.0);
+        double pe = dc - dm * q;
+        eqPrice[i] = crosses ? std::max(0.1, pe) : cur;
+        eqQuantity[i] = crosses ? std::max(0.0, q) : 0.0;
+
+        bool take = dm > EMPTY_CURVE_SLOPE && sm > EMPTY_CURVE_SLOPE && eqPrice[i] > 0.1;
+        double next = take ? eqPrice[i] : (cur < 0.1 ? 0.1 : cur);
+        price[i] = next;
+
+        // market::getQuantityDemanded / getQuantitySupplied cut-offs
+        double qd = dm < EMPTY_CURVE_SLOPE ? 0.0 : std::max(0.0, (dc - next) / dm);
+        double qs = sm < EMPTY_CURVE_SLOPE ? 0.0 : std::max(0.0, (next - sc) / sm);
+        excessDemand[i] = qd - qs;
+    }
+};
@@ -0,0 +1,136 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include "agentstore.h"
+
+// One market's order book, rebuilt from the published curves at every
+// clearing (see world::matchOrders).
+//
+// Every agent demand line p = c - mQ is a bid: it buys (c - p)/m at any price
+// below its reservation price c. Every farmer or firm supply line p = c + mQ
+// is an ask: it sells (p - c)/m at any price above c. Bids are sorted by
+// reservation price (best first) and asks by ask price (best first), and one
+// pass over the merged price levels finds the price where the filled volumes
+// meet. Lines drop out of the book at their own price instead of going
+// negative, so this is the exact clearing of the kinked curves the aggregate
+// lines in market.h approximate. Sorting makes a match O(n log n); the books
+// keep their capacity, so a warmed-up match does not allocate.
+class orderBook
+{
+public:
+    struct order
+    {
+        double price; // reservation (bid) or minimum (ask) price
+        double invM;  // units per Tk above / below that price
+        int owner;    // demand row for bids; supply row, or -1 - firm index, for asks
+    };
+
+    std::vector<order> bids, asks;
+
+    // Result of the last match()
+    double price = 0.0;      // clearing price
+    double volume = 0.0;     // units traded
+    bool traded = false;     // false: one side empty, nothing filled
+    double bidScale = 0.0;   // rationing of the long side at a floored price
+    double askScale = 0.0;
+
+    // Fills by owner, written by the world after each match
+    std::vector<double> sold;     // supply row -> units sold
+    std::vector<double> firmSold; // firm index -> units sold
+
+    void clear()
+    {
+        bids.clear();
+        asks.clear();
+        traded = false;
+        volume = 0.0;
+    }
+
+    void bid(demandLine l, int owner)
+    {
+        if (l.m > 0.000001 && l.c > 0.0)
+            bids.push_back({l.c, 1.0 / l.m, owner});
+    }
+
+    void ask(supplyLine l, int owner)
+    {
+        if (l.m > 0.000001)
+            asks.push_back({l.c, 1.0 / l.m, owner});
+    }
+
+    // Cross the book. `offered` units arrive at any price (net imports; a
+    // negative value is an export bid). The price never goes below `floor`;
+    // if it would, the long side is rationed pro rata so volumes still match.
+    bool match(double offered = 0.0, double floor = 0.1)
+    {
+        std::sort(bids.begin(), bids.end(), [](const order &a, const order &b)
+                  { return a.price > b.price || (a.price == b.price && a.owner < b.owner); });
+        std::sort(asks.begin(), asks.end(), [](const order &a, const order &b)
+                  { return a.price < b.price || (a.price == b.price && a.owner < b.owner); });
+
+        traded = false;
+        volume = 0.0;
+        if (bids.empty() || (asks.empty() && offered <= 0.0))
+            return false;
+
+        // Excess demand ED(p) = A - B·p - offered over the lines active at p,
+        // non-increasing in p. Walk the price levels upwards: below every
+        // level all bids are active and no ask is; a bid leaves at its price,
+        // an ask joins at its own.
+        double A = 0.0, B = 0.0;
+        for (auto &o : bids)
+        {
+            A += o.price * o.invM;
+            B += o.invM;
+        }
+        size_t nb = bids.size(), na = 0; // bids[nb - 1] is the lowest still active
+        double root = 0.0;
+        bool found = false;
+        while (nb > 0 || na < asks.size())
+        {
+            bool nextIsBid = na >= asks.size() || (nb > 0 && bids[nb - 1].price <= asks[na].price);
+            double level = nextIsBid ? bids[nb - 1].price : asks[na].price;
+            if (A - B * level - offered <= 0.0)
+            {
+                root = B > 0.0 ? (A - offered) / B : level;
+                found = true;
+                break;
+            }
+            const order &o = nextIsBid ? bids[--nb] : asks[na++];
+            double sign = nextIsBid ? -1.0 : 1.0;
+            A += sign * o.price * o.invM;
+            B += sign * o.invM;
+        }
+        if (!found)
+        {
+            if (B <= 0.0) // only offered units left and no bid at any price
+                return false;
+            root = (A - offered) / B;
+        }
+
+        price = std::max(floor, root);
+        double qd = 0.0, qs = std::max(0.0, offered);
+        for (auto &o : bids)
+            qd += std::max(0.0, (o.price - price) * o.invM);
+        for (auto &o : asks)
+            qs += std::max(0.0, (price - o.price) * o.invM);
+        qd += std::max(0.0, -offered);
+
+        volume = std::min(qd, qs);
+        bidScale = qd > 0.0 ? volume / qd : 0.0;
+        askScale = qs > 0.0 ? volume / qs : 0.0;
+        traded = volume > 0.0;
+        return traded;
+    }
+
+    // Units filled for one order at the last clearing price
+    double bidFill(const order &bidOrder) const
+    {
+        return traded ? bidScale * std::max(0.0, (bidOrder.price - price) * bidOrder.invM) : 0.0;
+    }
+    double askFill(const order &askOrder) const
+    {
+        return traded ? askScale * std::max(0.0, (price - askOrder.price) * askOrder.invM) : 0.0;
+    }
+};
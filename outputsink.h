@@ -0,0 +1,158 @@
+#pragma once
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// Buffered stdout for the CLI and script mode.
+//
+// Everything written to std::cout lands in one reusable 64 KiB buffer and
+// leaves in large fwrite()s: when the buffer fills, on drain(), and on flush
+// only when someone is typing at a terminal (so the prompt and the animated
+// dots still appear). Piped runs pay one write per buffer instead of one per
+// std::flush.
+//
+// In plain mode the sink also drops every ANSI escape sequence (ESC [ ...
+// final byte) on the way through, whether it came from Styled() or was
+// written raw, so the output is clean text for files and pipes.
+class outputSink : public std::streambuf
+{
+public:
+    static constexpr size_t CAPACITY = 64 * 1024;
+
+    explicit outputSink(std::ostream &stream, bool plain = false)
+        : stream(stream), plain(plain), flushOnSync(stdinIsTerminal()), buffer(CAPACITY)
+    {
+        setp(buffer.data(), buffer.data() + buffer.size());
+        previous = stream.rdbuf(this);
+    }
+
+    ~outputSink() override
+    {
+        drain();
+        stream.rdbuf(previous);
+    }
+
+    outputSink(const outputSink &) = delete;
+    outputSink &operator=(const outputSink &) = delete;
+
+    // Write out everything buffered so far
+    void drain()
+    {
+        size_t n = (size_t)(pptr() - pbase());
+        if (n > 0)
+            std::fwrite(pbase(), 1, n, stdout);
+        std::fflush(stdout);
+        setp(buffer.data(), buffer.data() + buffer.size());
+    }
+
+    // --plain on the command line, or the NO_COLOR convention
+    static bool wantsPlain(int argc, char **argv)
+    {
+        for (int i = 1; i < argc; i++)
+            if (std::string(argv[i]) == "--plain")
+                return true;
+        const char *noColor = std::getenv("NO_COLOR");
+        return noColor && *noColor;
+    }
+
+    static bool stdinIsTerminal()
+    {
+#ifdef _WIN32
+        return _isatty(_fileno(stdin)) != 0;
+#else
+        return isatty(STDIN_FILENO) != 0;
+#endif
+    }
+
+protected:
+    int overflow(int c) override
+    {
+        drain();
+        if (c != traits_type::eof())
+            put((char)c);
+        return traits_type::not_eof(c);
+    }
+
+    std::streamsize xsputn(const char *s, std::streamsize n) override
+    {
+        if (plain)
+        {
+            for (std::streamsize i = 0; i < n; i++)
+                put(s[i]);
+            return n;
+        }
+        for (std::streamsize left = n; left > 0;)
+        {
+            if (pptr() == epptr())
+                drain();
+            std::streamsize k = std::min<std::streamsize>(left, epptr() - pptr());
+            std::memcpy(pptr(), s, (size_t)k);
+            pbump((int)k);
+            s += k;
+            left -= k;
+        }
+        return n;
+    }
+
+    int sync() override
+    {
+        if (flushOnSync)
+            drain();
+        return 0;
+    }
+
+private:
+    void put(char c)
+    {
+        if (plain && !passes(c))
+            return;
+        if (pptr() == epptr())
+            drain();
+        *pptr() = c;
+        pbump(1);
+    }
+
+    // Escape filter: false for the bytes of an ANSI sequence
+    bool passes(char c)
+    {
+        switch (escape)
+        {
+        case Text:
+            if (c != '\033')
+                return true;
+            escape = Esc;
+            return false;
+        case Esc:
+            escape = c == '[' ? Csi : Text; // ESC + one byte otherwise
+            return false;
+        default: // Csi: parameters until a final byte 0x40 - 0x7E
+            if (c >= 0x40 && c <= 0x7E)
+                escape = Text;
+            return false;
+        }
+    }
+
+    enum
+    {
+        Text,
+        Esc,
+        Csi
+    } escape = Text;
+
+    std::ostream &stream;
+    std::streambuf *previous = nullptr;
+    bool plain;
+    bool flushOnSync;
+    std::vector<char> buffer;
+};
@@ -0,0 +1,252 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include "world.h"
+#include "rng.h"
+
+// Population-scale world generator.
+//
+// Builds the markets plus `agents` consumers, laborers and farmers and the
+// firms that employ the laborers, all drawn from parametric distributions
+// instead of innitialize()'s hand-written cast. Storage is reserved up front;
+// agents are added in one serial pass (ids and names only), then every
+// agent's attributes, crops and curves are filled in on the world's pool.
+// Each agent draws from its own rng stream keyed by its id, so the world is
+// the same for any thread count.
+//
+// build(w, agents, rank, ranks) makes only region `rank` of `ranks`: the
+// agents and firms regionSet::shard would deal that region from the whole
+// population (firm i to region i % ranks with its workers, everyone else
+// round-robin), with the same ids and draws. One pass over the ids decides
+// membership, so a region is built without the rest of the population ever
+// existing (see batchRunner::prepareRegion).
+//
+//   world w;
+//   w.setThreads(0);
+//   populationBuilder({}).build(w, 5000000);
+//
+// Distributions (log-normal where a skewed, positive quantity is wanted):
+//   income    log-normal daily income around a median, floored
+//   savings   income × log-normal number of days saved
+//   skill     triangular on [skillLo, skillHi]; minimum wage rises with skill
+//   land      farmer::getRealisticLandSize (marginal / small / medium / large)
+//   crops     first crop from cropWeights; a second one, more likely on more land
+//   firms     Cobb-Douglas (α, TFP uniform) or, with cesShare, CES (ρ uniform);
+//             log-normal cash, good from goodWeights
+class populationBuilder
+{
+public:
+    struct spec
+    {
+        // Agent mix; the rest of `agents` are consumers
+        double laborerShare = 0.20;
+        double farmerShare = 0.10;
+
+        // Consumers
+        double incomeMedian = 520.0, incomeSigma = 0.55, incomeFloor = 150.0; // Tk / day
+        double savingsDaysMedian = 40.0, savingsDaysSigma = 0.8;
+        int ageLo = 18, ageHi = 70;
+
+        // Laborers
+        double skillLo = 0.25, skillHi = 0.95;
+        double minWageBase = 250.0, minWagePerSkill = 300.0;
+        double employmentRate = 0.90;
+
+        // Farmers: rice, potato, banana, corn, jute
+        double cropWeights[5] = {0.42, 0.20, 0.10, 0.13, 0.15};
+        double taxRate = 0.05;
+
+        // Firms
+        int laborersPerFirm = 6; // firms auto-hire up to firm::MAX_AUTO_WORKERS
+        double cesShare = 0.25;
+        double alphaLo = 0.40, alphaHi = 0.70, tfpLo = 1.0, tfpHi = 1.5;
+        double rhoLo = 0.35, rhoHi = 0.60;
+        double cashMedian = 8e5, cashSigma = 0.6;
+        double goodWeights[4] = {0.50, 0.15, 0.15, 0.20}; // cloth, computer, phone, rice
+    };
+
+    explicit populationBuilder(spec s) : s(s) {}
+
+    // Replace w's population with `agents` generated agents (seeded by w.seed)
+    void build(world &w, long long agents) { build(w, agents, 0, 1); }
+
+    // Only region `rank` of `ranks` of that population
+    void build(world &w, long long agents, int rank, int ranks)
+    {
+        ranks = std::max(1, ranks);
+        long long nLaborers = (long long)(agents * s.laborerShare);
+        long long nFarmers = (long long)(agents * s.farmerShare);
+        long long nConsumers = std::max(0LL, agents - nLaborers - nFarmers);
+        long long nFirms = std::max(1LL, nLaborers / std::max(1, s.laborersPerFirm));
+        uint64_t seed = w.seed;
+
+        w.markets.clear();
+        w.firms.clear();
+        w.consumers.clear();
+        w.laborers.clear();
+        w.farmers.clear();
+        w.demand = demandStore();
+        w.supply = supplyStore();
+        w.openMarkets();
+
+        // ── AGENTS: ids and names, serially ───────────────────────────────
+        // Ids are 1-based and contiguous across kinds: consumers, laborers,
+        // farmers. A laborer's job is drawn here: the employed ones are dealt
+        // to firms round-robin and go where their firm goes; every other
+        // agent is dealt to the regions round-robin.
+        long long share = ranks;
+        w.consumers.reserve(nConsumers / share + 1);
+        w.laborers.reserve(nLaborers / share + 1);
+        w.farmers.reserve(nFarmers / share + 1);
+        w.firms.reserve(nFirms / share + 1);
+        std::vector<std::pair<long long, int>> hires; // (firm index, laborer id)
+        long long dealt = 0, employed = 0;
+        auto dealHere = [&]()
+        { return dealt++ % ranks == rank; };
+        int id = 1;
+        for (long long i = 0; i < nConsumers; i++, id++)
+            if (dealHere())
+                w.consumers.emplace(id, "c" + std::to_string(id), 0);
+        for (long long i = 0; i < nLaborers; i++, id++)
+        {
+            rng::generator g(seed, rng::stream::Synthetic, Jobs, (uint64_t)id);
+            bool here;
+            if (g.uniform() < s.employmentRate)
+            {
+                long long employer = employed++ % nFirms;
+                here = employer % ranks == rank;
+                if (here)
+                    hires.push_back({employer, id});
+            }
+            else
+                here = dealHere();
+            if (here)
+                w.laborers.emplace(id, "l" + std::to_string(id), 0, 0.0, 0.0);
+        }
+        for (long long i = 0; i < nFarmers; i++, id++)
+            if (dealHere())
+                w.farmers.emplace(id, "f" + std::to_string(id), 0, 0.0, 0.0);
+
+        // ── ATTRIBUTES: in parallel, one rng stream per agent ─────────────
+        forEach(w, w.consumers, [&](consumer &c)
+                {
+            rng::generator g(seed, rng::stream::Synthetic, Agents, c.id);
+            c.ageInDays = age(g, s.ageLo, s.ageHi);
+            c.incomePerDay = std::max(s.incomeFloor, g.lognormal(s.incomeMedian, s.incomeSigma));
+            c.savings = c.incomePerDay * g.lognormal(s.savingsDaysMedian, s.savingsDaysSigma); });
+
+        forEach(w, w.laborers, [&](laborer &l)
+                {
+            rng::generator g(seed, rng::stream::Synthetic, Agents, l.id);
+            l.ageInDays = age(g, s.ageLo, std::min(s.ageHi, 58));
+            l.skillLevel = s.skillLo + (s.skillHi - s.skillLo) * 0.5 * (g.uniform() + g.uniform());
+            l.minWage = s.minWageBase + s.minWagePerSkill * l.skillLevel;
+            l.incomePerDay = l.minWage * g.uniform(1.0, 1.25);
+            l.savings = l.minWage * g.lognormal(0.5 * s.savingsDaysMedian, s.savingsDaysSigma); });
+
+        product *cropPool[5] = {&rice, &potato, &banana, &corn, &jute};
+        forEach(w, w.farmers, [&](farmer &f)
+                {
+            rng::generator g(seed, rng::stream::Synthetic, Agents, f.id);
+            f.ageInDays = age(g, std::max(s.ageLo, 20), s.ageHi);
+            f.land = farmer::getRealisticLandSize(g);
+            f.techLevel = std::max(0.1, std::min(0.95, 0.25 + 0.05 * f.land + 0.12 * g.normal()));
+            f.incomePerDay = 200.0 + f.land * 60.0;
+            f.savings = (3000.0 + f.land * 6000.0) * g.lognormal(1.0, 0.5);
+            f.tax = s.taxRate;
+            f.weather = 0.70;
+            int first = pick(g, s.cropWeights, 5);
+            f.addCrop(cropPool[first], {0.25, 35.0}, 40.0 + f.land * 8.0, 2.5, 60.0 + f.land * 20.0);
+            if (g.uniform() < std::min(0.9, f.land / 3.0))
+            {
+                int second = (first + 1 + g.below(4)) % 5;
+                f.addCrop(cropPool[second], {0.20, 30.0}, 35.0 + f.land * 6.0, 3.0, 50.0 + f.land * 15.0);
+            } });
+
+        // ── FIRMS: owners drawn from consumers, laborers dealt round-robin ──
+        // Firm i is this region's firm i / ranks
+        product *goods[4] = {&cloth, &computer, &phone, &rice};
+        for (long long i = rank; i < nFirms; i += ranks)
+        {
+            rng::generator g(seed, rng::stream::Synthetic, Firms, (uint64_t)i);
+            int owner = nConsumers > 0 ? 1 + g.below((int)nConsumers) : 0;
+            double cash = g.lognormal(s.cashMedian, s.cashSigma);
+            firm f = g.uniform() < s.cesShare
+                         ? firm(owner, cash, ces(g.uniform(s.rhoLo, s.rhoHi)))
+                         : firm(owner, cash, cobbDouglas(g.uniform(s.alphaLo, s.alphaHi), 0.4, g.uniform(s.tfpLo, s.tfpHi)));
+            product *good = goods[pick(g, s.goodWeights, 4)];
+            f.productIds.push_back(good->id);
+            f.wage = g.uniform(380.0, good == &computer || good == &phone ? 760.0 : 520.0);
+            f.fixed_overhead = g.uniform(1500.0, 9000.0);
+            int units = 1 + g.below(3);
+            double rental = g.uniform(500.0, 2000.0), eff = g.uniform(1.0, 2.0);
+            for (int k = 0; k < units; k++)
+                f.addCapital(rental, eff);
+            w.firms.push_back(f);
+        }
+        for (auto &h : hires)
+            w.firms[h.first / ranks].workers.push_back(h.second);
+        w.pool.parallelFor(w.firms.size(), 16, [&](size_t begin, size_t end)
+                           {
+            for (size_t i = begin; i < end; i++)
+                w.firms[i].calculateCosts(); });
+
+        // ── CURVES, INDEX, FIRST CLEARING ─────────────────────────────────
+        w.rebuildEmployment();
+        w.initializeDemandCurves();
+        w.initializeSupplyCurves();
+        w.updateAllMarkets();
+        w.statsStale = true;
+
+        w.selected_consumer = w.consumers.first();
+        w.selected_laborer = w.laborers.first();
+        w.selected_farmer = w.farmers.first();
+        w.selected_market = &w.markets[0];
+        w.selected_firm = w.firms.empty() ? nullptr : &w.firms[0];
+    }
+
+private:
+    // Day slots of the Synthetic stream, one per kind of draw
+    enum : uint64_t
+    {
+        Agents = 10,
+        Firms,
+        Jobs
+    };
+
+    template <class Agent, class Fn>
+    static void forEach(world &w, agentArena<Agent> &agents, Fn fn)
+    {
+        w.pool.parallelFor(agents.slots(), world::AGENT_GRAIN, [&](size_t begin, size_t end)
+                           {
+            for (size_t i = begin; i < end; i++)
+                if (agents.alive(i))
+                    fn(agents[i]); });
+    }
+
+    static int age(rng::generator &g, int lo, int hi)
+    {
+        return (lo + g.below(std::max(1, hi - lo + 1))) * 365 + g.below(365);
+    }
+
+    // Index drawn with probability proportional to weights[i]
+    static int pick(rng::generator &g, const double *weights, int n)
+    {
+        double total = 0.0;
+        for (int i = 0; i < n; i++)
+            total += weights[i];
+        double u = g.uniform() * total;
+        for (int i = 0; i < n - 1; i++)
+        {
+            if (u < weights[i])
+                return i;
+            u -= weights[i];
+        }
+        return n - 1;
+    }
+
+    spec s;
+};
@@ -1,5 +1,6 @@
 #pragma once
 #include <string>
+#include <vector>
 
 struct product {
     std::string name;
@@ -7,37 +8,140 @@ struct product {
     double eta;             // Income Elasticity (Rich vs Poor behavior)
     double baseConsumption; // Average person's daily need
     double growthRate;      // NEW: Units produced per acre of land (0.0 if not a crop)
+    int id = -1;            // Dense registry id (assigned by productRegistry, carried by copies)
 };
 
+// ==========================================
+//           CALIBRATION TABLE
+// ==========================================
+// Static calibration of every built-in product, indexed by product id. The
+// table is constexpr, so a lookup with a known id folds to a constant and a
+// lookup with a runtime id is one array index; nothing on the hot path
+// compares names. baseCost / baseSlope calibrate farm supply (p = c + mQ)
+// before land, tech, weather and tax adjustments; non-crops carry the
+// defaults. A product is added at build time as a new id below, a row in
+// the table and a global registered in productRegistry.
+struct productSpec {
+    const char *name;
+    double decayRate;
+    double eta;
+    double baseConsumption;
+    double growthRate;
+    double baseCost = 30.0;
+    double baseSlope = 0.20;
+};
+
+// Built-in ids, in registry order (snapshots store these ids)
+namespace productIds {
+    enum : int {
+        Rice, Cloth, Computer, Phone, Car, Steel, Potato, Banana, Corn, Jute,
+        BuiltIn
+    };
+}
+
+inline constexpr productSpec productTable[productIds::BuiltIn] = {
+    // name        decay   eta    base    growth   cost  slope
+    {"Rice",      0.01,   0.15,  0.5,    1600.0,  37.0, 0.22},
+    {"Cloth",     0.01,   0.8,   6.0,    0.0},
+    {"Computer",  0.001,  2.2,   0.1,    0.0},
+    {"Phone",     0.001,  1.4,   0.8,    0.0},
+    {"Car",       0.0001, 4.0,   0.002,  0.0},
+    {"Steel",     0.0001, 1.9,   50.0,   0.0},
+    {"Potato",    0.05,  -0.2,   0.2,    8000.0,  22.0, 0.16},
+    {"Banana",    0.2,    0.5,   0.1,    12000.0, 18.0, 0.14},
+    {"Corn",      0.01,   0.0,   0.05,   2500.0,  27.0, 0.19},
+    {"Jute",      0.001,  1.0,   0.0,    800.0,   34.0, 0.28},
+};
+
+// Calibration of products outside the table (registered at run time)
+inline constexpr productSpec defaultSpec{"", 0.0, 0.0, 0.0, 0.0};
+
+// Calibration by id: one index into the table, no registry lookup
+constexpr const productSpec &specOf(int id) {
+    return (id >= 0 && id < productIds::BuiltIn) ? productTable[id] : defaultSpec;
+}
+
+// A product filled from its table row, carrying its built-in id
+inline product makeProduct(int id) {
+    const productSpec &s = productTable[id];
+    return {s.name, s.decayRate, s.eta, s.baseConsumption, s.growthRate, id};
+}
+
 // ==========================================
 //           NON-FARM GOODS (Growth = 0)
 // ==========================================
 
-// Transport
+// Transport (not in the catalogue)
 inline product localBus = {"Local Bus", 1.0, -0.6, 2.0, 0.0};
 
 // Manufacturing
-inline product cloth = {"Cloth", 0.01, 0.8, 6.0, 0.0};
-inline product phone = {"Phone", 0.001, 1.4, 0.8, 0.0};
-inline product computer = {"Computer", 0.001, 2.2, 0.1, 0.0};
-inline product steel = {"Steel", 0.0001, 1.9, 50.0, 0.0};
-inline product car = {"Car", 0.0001, 4.0, 0.002, 0.0};
-
+inline product cloth = makeProduct(productIds::Cloth);
+inline product phone = makeProduct(productIds::Phone);
+inline product computer = makeProduct(productIds::Computer);
+inline product steel = makeProduct(productIds::Steel);
+inline product car = makeProduct(productIds::Car);
 
 // Rice (Paddy): ~40-50 Mon per acre -> ~1600 kg
 // This means 1 acre feeds ~3,200 "person-days" (enough for 1 family for 2 years).
-inline product rice = {"Rice", 0.01, 0.15, 0.5, 1600.0}; 
+inline product rice = makeProduct(productIds::Rice);
 
 // Potato: Yields are massive by weight (~8-10 tons/acre).
 // ~8000 kg per acre.
-inline product potato = {"Potato", 0.05, -0.2, 0.2, 8000.0}; 
+inline product potato = makeProduct(productIds::Potato);
 
 // Banana: Very dense biomass. ~12 tons/acre.
 // ~12000 kg per acre.
-inline product banana = {"Banana", 0.2, 0.5, 0.1, 12000.0}; 
+inline product banana = makeProduct(productIds::Banana);
 
 // Corn (Maize): Higher yield than rice. ~2500 kg/acre.
-inline product corn = {"Corn", 0.01, 0.0, 0.05, 2500.0}; 
+inline product corn = makeProduct(productIds::Corn);
 
 // Jute: Fiber is lighter than food grains. ~800 kg/acre.
-inline product jute = {"Jute", 0.001, 1.0, 0.0, 800.0};
\ No newline at end of file
+inline product jute = makeProduct(productIds::Jute);
+
+// ==========================================
+//           PRODUCT REGISTRY
+// ==========================================
+// Assigns every product a dense integer id (0..size-1) so prices, demand
+// columns and supply lookups index arrays instead of comparing names.
+// Copies of a product (needs, crops) carry the id of the original.
+class productRegistry {
+public:
+    static productRegistry& instance() {
+        static productRegistry registry;
+        return registry;
+    }
+
+    // Register a product (idempotent) and return its id
+    int add(product* prod) {
+        if (prod->id >= 0 && prod->id < size() && items[prod->id] == prod)
+            return prod->id;
+        prod->id = size();
+        items.push_back(prod);
+        return prod->id;
+    }
+
+    product* get(int id) const { return (id >= 0 && id < size()) ? items[id] : nullptr; }
+
+    // Name lookup is for the CLI only; simulation code uses ids
+    product* find(const std::string& name) const {
+        for (auto* p : items)
+            if (p->name == name)
+                return p;
+        return nullptr;
+    }
+
+    int size() const { return (int)items.size(); }
+    const std::vector<product*>& all() const { return items; }
+
+private:
+    productRegistry() {
+        // Same order as productIds, so every global keeps its table id
+        for (product* p : {&rice, &cloth, &computer, &phone, &car, &steel, &potato, &banana, &corn, &jute})
+            add(p);
+    }
+
+    std::vector<product*> items;
+};
+
+inline productRegistry& catalogue() { return productRegistry::instance(); }
@@ -0,0 +1,130 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <sstream>
+#include <algorithm>
+
+// Per-phase timers and counters for world::pass_day.
+//
+// PROFILE_PHASE(times, phase, items) opens a scoped timer that adds its elapsed
+// time and item count to `times` when the scope ends. Building with
+// -DCPPCONOMY_NO_PROFILE turns every PROFILE_PHASE into nothing.
+namespace profile
+{
+    // The numbered phases of world::pass_day, in order
+    enum phase
+    {
+        MarketsBefore, // 1. re-equilibrate before agents act
+        Matching,      //    order book clearing (world::orderMatching)
+        Agents,        // 2. agents respond to prices
+        MarketsAfter,  // 3. re-clear with updated curves
+        FirmCosts,     // 4. firm cost recalculation
+        FirmOptimize,  //    auto hire / fire / capital
+        Stats,         // 5. macro stats
+        Tatonnement,   // 6. Walrasian price adjustment
+        Shocks,        // 7-8. income and demand shocks
+        PhaseCount
+    };
+
+    inline const char *phaseName(int p)
+    {
+        static const char *names[PhaseCount] = {
+            "markets_before", "matching", "agents", "markets_after", "firm_costs",
+            "firm_optimize", "stats", "tatonnement", "shocks"};
+        return (p >= 0 && p < PhaseCount) ? names[p] : "?";
+    }
+
+    struct phaseStats
+    {
+        uint64_t calls = 0;
+        uint64_t items = 0; // agents / markets / firms touched
+        uint64_t totalNs = 0;
+        uint64_t lastNs = 0;
+        uint64_t maxNs = 0;
+    };
+
+    class phaseTimes
+    {
+    public:
+        void record(int p, uint64_t ns, uint64_t items)
+        {
+            phaseStats &s = stats[p];
+            s.calls++;
+            s.items += items;
+            s.totalNs += ns;
+            s.lastNs = ns;
+            s.maxNs = std::max(s.maxNs, ns);
+        }
+
+        void reset()
+        {
+            for (auto &s : stats)
+                s = phaseStats{};
+        }
+
+        const phaseStats &operator[](int p) const { return stats[p]; }
+
+        uint64_t totalNs() const
+        {
+            uint64_t t = 0;
+            for (auto &s : stats)
+                t += s.totalNs;
+            return t;
+        }
+
+        // One JSON object: {"phases":[{"name":..,"calls":..,...},...]}
+        std::string toJson() const
+        {
+            std::ostringstream os;
+            os << "{\"phases\":[";
+            for (int p = 0; p < PhaseCount; p++)
+            {
+                const phaseStats &s = stats[p];
+                os << (p ? "," : "") << "{\"name\":\"" << phaseName(p) << "\""
+                   << ",\"calls\":" << s.calls << ",\"items\":" << s.items
+                   << ",\"total_ns\":" << s.totalNs << ",\"last_ns\":" << s.lastNs
+                   << ",\"max_ns\":" << s.maxNs << "}";
+            }
+            os << "]}";
+            return os.str();
+        }
+
+    private:
+        phaseStats stats[PhaseCount];
+    };
+
+    class scopedTimer
+    {
+    public:
+        scopedTimer(phaseTimes &times, int p, uint64_t items = 0)
+            : times(times), p(p), items(items), start(std::chrono::steady_clock::now()) {}
+
+        ~scopedTimer()
+        {
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now() - start)
+                          .count();
+            times.record(p, (uint64_t)ns, items);
+        }
+
+        scopedTimer(const scopedTimer &) = delete;
+        scopedTimer &operator=(const scopedTimer &) = delete;
+
+    private:
+        phaseTimes &times;
+        int p;
+        uint64_t items;
+        std::chrono::steady_clock::time_point start;
+    };
+}
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+
+#ifdef CPPCONOMY_NO_PROFILE
+#define PROFILE_PHASE(times, phase, items) ((void)0)
+#else
+#define PROFILE_PHASE(times, phase, items) \
+    profile::scopedTimer PROFILE_CONCAT(profileTimer_, __LINE__)((times), (phase), (items))
+#endif
@@ -0,0 +1,191 @@
+#pragma once
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "world.h"
+
+// Streams one row per simulated day to an append-only file: day, macro stats,
+// then price, quantity, revenue and excess demand for every market.
+//
+// CSV: a header line, then one line per day.
+// Binary (columnar, little-endian):
+//   "CPPSERIE" | uint32 version | uint32 columns | per column: uint16 length, name
+//   then row groups until EOF: uint32 rows | columns × rows doubles, one
+//   column after another
+// Rows are buffered in memory and written in large chunks (a whole row group
+// for the binary format), so recording adds one disk write per few hundred days.
+class seriesRecorder
+{
+public:
+    enum class format
+    {
+        Csv,
+        Binary
+    };
+
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t GROUP_ROWS = 512;     // binary rows per group
+    static constexpr size_t CSV_FLUSH = 1 << 16; // bytes buffered before a write
+
+    seriesRecorder() = default;
+    seriesRecorder(const seriesRecorder &) = delete;
+    seriesRecorder &operator=(const seriesRecorder &) = delete;
+    ~seriesRecorder() { close(); }
+
+    // Columns are fixed to the world's markets at this point
+    bool open(const std::string &path, format f, const world &w, std::string &err)
+    {
+        close();
+        out.open(path, std::ios::binary | std::ios::trunc);
+        if (!out)
+        {
+            err = "cannot open " + path + " for writing";
+            return false;
+        }
+        fmt = f;
+        filePath = path;
+        rowCount = 0;
+
+        productIds.clear();
+        names = {"day", "gdp", "gdp_per_capita", "unemployment", "employed",
+                 "population", "firms", "money_supply"};
+        for (auto &m : w.markets)
+        {
+            productIds.push_back(m.prod->id);
+            for (const char *field : {"price", "quantity", "revenue", "excess_demand"})
+                names.push_back(m.prod->name + "_" + field);
+        }
+
+        if (fmt == format::Csv)
+        {
+            std::string header;
+            for (size_t i = 0; i < names.size(); i++)
+                header += (i ? "," : "") + names[i];
+            header += "\n";
+            out.write(header.data(), header.size());
+        }
+        else
+        {
+            out.write("CPPSERIE", 8);
+            writePod(VERSION);
+            writePod((uint32_t)names.size());
+            for (auto &n : names)
+            {
+                writePod((uint16_t)n.size());
+                out.write(n.data(), n.size());
+            }
+            group.assign(names.size() * GROUP_ROWS, 0.0);
+            groupRows = 0;
+        }
+        row.assign(names.size(), 0.0);
+        return (bool)out;
+    }
+
+    bool isOpen() const { return out.is_open(); }
+    const std::string &path() const { return filePath; }
+    long long rows() const { return rowCount; }
+
+    // Append the world's current day
+    void record(const world &w)
+    {
+        if (!isOpen())
+            return;
+
+        const world::stats &s = w.currentStats;
+        int population = w.getPopulation();
+        size_t k = 0;
+        row[k++] = w.dayCount;
+        row[k++] = s.gdp;
+        row[k++] = s.gdp / std::max(1, population);
+        row[k++] = s.unemployment;
+        row[k++] = s.employed;
+        row[k++] = population;
+        row[k++] = (double)w.firms.size();
+        row[k++] = s.moneySupply;
+        for (int id : productIds)
+        {
+            int mi = id < (int)w.marketIndex.size() ? w.marketIndex[id] : -1;
+            const market *m = mi >= 0 ? &w.markets[mi] : nullptr;
+            row[k++] = m ? m->price : 0.0;
+            row[k++] = m ? m->quantityTraded : 0.0;
+            row[k++] = m ? m->revenue : 0.0;
+            row[k++] = m ? m->excessDemand : 0.0;
+        }
+        rowCount++;
+
+        if (fmt == format::Csv)
+            appendCsv();
+        else
+            appendBinary();
+    }
+
+    void flush()
+    {
+        if (!isOpen())
+            return;
+        if (fmt == format::Csv)
+        {
+            out.write(text.data(), text.size());
+            text.clear();
+        }
+        else if (groupRows > 0)
+        {
+            writePod((uint32_t)groupRows);
+            for (size_t c = 0; c < names.size(); c++)
+                out.write(reinterpret_cast<const char *>(&group[c * GROUP_ROWS]), sizeof(double) * groupRows);
+            groupRows = 0;
+        }
+        out.flush();
+    }
+
+    void close()
+    {
+        if (!isOpen())
+            return;
+        flush();
+        out.close();
+    }
+
+private:
+    template <class T>
+    void writePod(T v) { out.write(reinterpret_cast<const char *>(&v), sizeof(v)); }
+
+    void appendCsv()
+    {
+        char buf[32];
+        for (size_t i = 0; i < row.size(); i++)
+        {
+            int n = i < 1 ? std::snprintf(buf, sizeof(buf), "%.0f", row[i])
+                          : std::snprintf(buf, sizeof(buf), ",%.10g", row[i]);
+            text.append(buf, n);
+        }
+        text.push_back('\n');
+        if (text.size() >= CSV_FLUSH)
+        {
+            out.write(text.data(), text.size());
+            text.clear();
+        }
+    }
+
+    void appendBinary()
+    {
+        for (size_t c = 0; c < row.size(); c++)
+            group[c * GROUP_ROWS + groupRows] = row[c];
+        if (++groupRows == GROUP_ROWS)
+            flush();
+    }
+
+    std::ofstream out;
+    format fmt = format::Csv;
+    std::string filePath;
+    std::vector<std::string> names;
+    std::vector<int> productIds; // market columns, in order
+    std::vector<double> row;     // the row being appended
+    std::string text;            // pending CSV bytes
+    std::vector<double> group;   // pending binary row group, column-major
+    size_t groupRows = 0;
+    long long rowCount = 0;
+};
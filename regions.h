@@ -0,0 +1,288 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <algorithm>
+#include "world.h"
+#include "threadpool.h"
+#include "rng.h"
+
+// One district: a complete world of its own agents, farmers, firms and
+// markets. Regions never touch each other's state during a day; the only
+// coupling is the trade step between days, which reads a tradeQuote per
+// market from every region and writes back world::imports.
+struct region
+{
+    std::string name;
+    world economy;
+};
+
+// What a region tells the exchange about one of its markets: the local
+// aggregate curves, before any imports, and the day's price (plain data, so
+// it can cross a thread or process boundary as is).
+struct tradeQuote
+{
+    int productId = -1;
+    double demandM = 0.0, demandC = 0.0; // p = c - mQ
+    double supplyM = 0.0, supplyC = 0.0; // p = c + mQ
+    double price = 0.0;
+
+    // Both curves non-trivial; a flat or empty side cannot trade
+    bool tradable() const { return demandM > EMPTY_CURVE_SLOPE && supplyM > EMPTY_CURVE_SLOPE; }
+
+    // Linear excess demand a - b·p
+    double a() const { return demandC / demandM + supplyC / supplyM; }
+    double b() const { return 1.0 / demandM + 1.0 / supplyM; }
+};
+
+// A region's day stats and labour force, from which totals over regions are
+// formed (plain data, like tradeQuote)
+struct regionSummary
+{
+    world::stats stats;
+    int labourForce = 0;
+};
+
+// A world partitioned into regions that each clear their own markets.
+//
+// pass_day steps every region on the set's own pool (one region per task,
+// each region single-threaded), then exchanges trade: per product, the price
+// that would clear all tradable regions together is found from their quotes,
+// and each region imports `tradeShare` of its excess demand at that price for
+// the next day. Imports sum to zero across regions, and the result does not
+// depend on the thread count.
+class regionSet
+{
+public:
+    std::vector<region> regions;
+    static constexpr double TRADE_SHARE = 0.5;
+    double tradeShare = TRADE_SHARE; // fraction of the inter-region price gap closed per day
+    std::vector<double> pooledPrices; // product id -> last integrated price, 0 if untraded
+
+    // Shard `from` into n regions. Firm i goes to region i % n together with
+    // its workers; every other agent is dealt round-robin in vector order.
+    // Each region keeps a copy of every market and the current prices.
+    void split(const world &from, int n)
+    {
+        open(n);
+        for (int r = 0; r < (int)regions.size(); r++)
+            shard(from, regions[r].economy, r, (int)regions.size());
+    }
+
+    // n empty regions, R1..Rn, for the caller to build one by one (see
+    // batchRunner::prepareRegion)
+    void open(int n)
+    {
+        n = std::max(1, n);
+        regions.clear();
+        regions.reserve(n); // worlds are built in place, never moved
+        for (int r = 0; r < n; r++)
+        {
+            regions.emplace_back();
+            regions.back().name = "R" + std::to_string(r + 1);
+        }
+        pooledPrices.assign(catalogue().size(), 0.0);
+    }
+
+    bool empty() const { return regions.empty(); }
+    size_t size() const { return regions.size(); }
+
+    // 0 = one thread per hardware core; regions run one per thread
+    void setThreads(int n) { pool.resize(n); }
+    int threads() const { return pool.size(); }
+
+    void pass_day()
+    {
+        pool.parallelFor(regions.size(), 1, [&](size_t begin, size_t end)
+                         {
+            for (size_t r = begin; r < end; r++)
+                regions[r].economy.pass_day(); });
+        exchangeTrade();
+    }
+
+    int dayCount() const { return regions.empty() ? 0 : regions.front().economy.dayCount; }
+
+    // Day stats summed over regions
+    world::stats totals()
+    {
+        std::vector<regionSummary> each;
+        each.reserve(regions.size());
+        for (auto &r : regions)
+            each.push_back(summarize(r.economy));
+        return combine(each);
+    }
+
+    static regionSummary summarize(world &w)
+    {
+        return {w.getStats(), (int)w.laborers.size()};
+    }
+
+    // Totals over regions, in region order
+    static world::stats combine(const std::vector<regionSummary> &each)
+    {
+        world::stats t;
+        int labourForce = 0;
+        for (auto &r : each)
+        {
+            t.gdp += r.stats.gdp;
+            t.employed += r.stats.employed;
+            t.population += r.stats.population;
+            t.moneySupply += r.stats.moneySupply;
+            t.firms += r.stats.firms;
+            labourForce += r.labourForce;
+        }
+        t.unemployment = labourForce > 0 ? (double)(labourForce - t.employed) / labourForce : 0.0;
+        return t;
+    }
+
+    // Mean price of one product over the regions that have its market
+    double meanPrice(int productId) const
+    {
+        double sum = 0.0;
+        int n = 0;
+        for (auto &r : regions)
+            if (const market *m = marketIn(r.economy, productId))
+            {
+                sum += m->price;
+                n++;
+            }
+        return n ? sum / n : 0.0;
+    }
+
+    // The same mean from every region's quotes
+    static double meanPrice(const std::vector<std::vector<tradeQuote>> &byRegion, int productId)
+    {
+        double sum = 0.0;
+        int n = 0;
+        for (auto &qs : byRegion)
+            for (auto &q : qs)
+                if (q.productId == productId)
+                {
+                    sum += q.price;
+                    n++;
+                }
+        return n ? sum / n : 0.0;
+    }
+
+    // ── TRADE EXCHANGE ────────────────────────────────────────────────────
+    static std::vector<tradeQuote> quotes(const world &w)
+    {
+        std::vector<tradeQuote> q;
+        q.reserve(w.markets.size());
+        for (auto &m : w.markets)
+            q.push_back({m.prod->id, m.aggregateDemand.m, m.aggregateDemand.c,
+                         m.aggregateSupply.m, m.aggregateSupply.c, m.price});
+        return q;
+    }
+
+    // Integrated price per product over every region's quotes, then each
+    // region's net imports at that price. imports[r] is indexed by product id.
+    static void clearTrade(const std::vector<std::vector<tradeQuote>> &byRegion, double share,
+                           std::vector<double> &pooled, std::vector<std::vector<double>> &imports)
+    {
+        int products = 0;
+        for (auto &qs : byRegion)
+            for (auto &q : qs)
+                products = std::max(products, q.productId + 1);
+
+        std::vector<double> sumA(products, 0.0), sumB(products, 0.0);
+        std::vector<int> traders(products, 0);
+        for (auto &qs : byRegion)
+            for (auto &q : qs)
+                if (q.productId >= 0 && q.tradable())
+                {
+                    sumA[q.productId] += q.a();
+                    sumB[q.productId] += q.b();
+                    traders[q.productId]++;
+                }
+
+        pooled.assign(std::max((int)pooled.size(), products), 0.0);
+        for (int p = 0; p < products; p++)
+            pooled[p] = traders[p] > 1 ? sumA[p] / sumB[p] : 0.0;
+
+        imports.assign(byRegion.size(), std::vector<double>(pooled.size(), 0.0));
+        for (size_t r = 0; r < byRegion.size(); r++)
+            for (auto &q : byRegion[r])
+                if (q.productId >= 0 && q.tradable() && pooled[q.productId] > 0.0)
+                    imports[r][q.productId] = share * (q.a() - q.b() * pooled[q.productId]);
+    }
+
+private:
+    void exchangeTrade()
+    {
+        if (regions.size() < 2)
+            return;
+        std::vector<std::vector<tradeQuote>> byRegion;
+        byRegion.reserve(regions.size());
+        for (auto &r : regions)
+            byRegion.push_back(quotes(r.economy));
+
+        std::vector<std::vector<double>> imports;
+        clearTrade(byRegion, tradeShare, pooledPrices, imports);
+        for (size_t r = 0; r < regions.size(); r++)
+            regions[r].economy.imports = std::move(imports[r]);
+    }
+
+    static const market *marketIn(const world &w, int productId)
+    {
+        if (productId < 0 || productId >= (int)w.marketIndex.size() || w.marketIndex[productId] < 0)
+            return nullptr;
+        return &w.markets[w.marketIndex[productId]];
+    }
+
+    threadPool pool;
+
+public:
+    // Build region r of n from `from` (see split); `into` must be a fresh world
+    static void shard(const world &from, world &into, int r, int n)
+    {
+        into.seed = from.seed + (uint64_t)r; // region 1 keeps the source's draws
+        into.dayCount = from.dayCount;
+        into.orderMatching = from.orderMatching;
+        into.jointClearing = from.jointClearing;
+        into.solver = from.solver;
+        into.setThreads(1);
+
+        into.marketIndex = from.marketIndex;
+        into.prices = from.prices;
+        into.markets = from.markets;
+        for (auto &m : into.markets)
+            into.demand.addColumn(m.prod);
+
+        for (size_t i = 0; i < from.firms.size(); i++)
+            if ((int)(i % n) == r)
+                into.firms.push_back(from.firms[i]);
+
+        int dealt = 0; // unattached agents seen so far, across every vector
+        auto dealHere = [&]()
+        { return dealt++ % n == r; };
+
+        for (auto &c : from.consumers)
+            if (dealHere())
+                into.adopt(into.consumers, c, from.demand);
+        for (auto &l : from.laborers)
+        {
+            int employer = from.employment.employerOf(l.id);
+            bool here = employer >= 0 ? employer % n == r : dealHere();
+            if (here)
+                into.adopt(into.laborers, l, from.demand);
+        }
+        for (auto &f : from.farmers)
+            if (dealHere())
+            {
+                farmer &g = into.adopt(into.farmers, f, from.demand);
+                g.supplyLedger = nullptr;
+                g.supplyRow = -1;
+                into.enrollSupply(g);
+            }
+
+        into.rebuildEmployment();
+        into.updateAllMarkets();
+        into.calculateStats();
+
+        into.selected_consumer = into.consumers.first();
+        into.selected_laborer = into.laborers.first();
+        into.selected_farmer = into.farmers.first();
+        into.selected_market = into.markets.empty() ? nullptr : &into.markets[0];
+        into.selected_firm = into.firms.empty() ? nullptr : &into.firms[0];
+    }
+};
@@ -0,0 +1,82 @@
+#pragma once
+#include <cstddef>
+#include <iterator>
+
+// Fixed-capacity history: push overwrites the oldest value once full.
+// Index 0 is the oldest retained value, size() - 1 the newest; push is O(1)
+// and nothing is ever allocated.
+template <class T, size_t N>
+class ringBuffer
+{
+public:
+    static constexpr size_t CAPACITY = N;
+
+    void push_back(const T &v)
+    {
+        items[(head + count) % N] = v;
+        if (count < N)
+            count++;
+        else
+            head = (head + 1) % N;
+    }
+
+    void clear() { head = count = 0; }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    const T &operator[](size_t i) const { return items[(head + i) % N]; }
+    const T &front() const { return (*this)[0]; }
+    const T &back() const { return (*this)[count - 1]; }
+
+    // Keeps the newest N of [first, last)
+    template <class It>
+    void assign(It first, It last)
+    {
+        clear();
+        for (; first != last; ++first)
+            push_back(*first);
+    }
+
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T *;
+        using reference = const T &;
+
+        const_iterator(const ringBuffer *r, size_t i) : r(r), i(i) {}
+        reference operator*() const { return (*r)[i]; }
+        pointer operator->() const { return &(*r)[i]; }
+        reference operator[](difference_type n) const { return (*r)[i + n]; }
+        const_iterator &operator++() { i++; return *this; }
+        const_iterator operator++(int) { const_iterator t = *this; i++; return t; }
+        const_iterator &operator--() { i--; return *this; }
+        const_iterator operator--(int) { const_iterator t = *this; i--; return t; }
+        const_iterator &operator+=(difference_type n) { i += n; return *this; }
+        const_iterator &operator-=(difference_type n) { i -= n; return *this; }
+        const_iterator operator+(difference_type n) const { return {r, i + n}; }
+        const_iterator operator-(difference_type n) const { return {r, i - n}; }
+        difference_type operator-(const const_iterator &o) const { return (difference_type)i - (difference_type)o.i; }
+        bool operator==(const const_iterator &o) const { return i == o.i; }
+        bool operator!=(const const_iterator &o) const { return i != o.i; }
+        bool operator<(const const_iterator &o) const { return i < o.i; }
+        bool operator>(const const_iterator &o) const { return i > o.i; }
+        bool operator<=(const const_iterator &o) const { return i <= o.i; }
+        bool operator>=(const const_iterator &o) const { return i >= o.i; }
+
+    private:
+        const ringBuffer *r;
+        size_t i;
+    };
+
+    const_iterator begin() const { return {this, 0}; }
+    const_iterator end() const { return {this, count}; }
+
+private:
+    T items[N] = {};
+    size_t head = 0;
+    size_t count = 0;
+};
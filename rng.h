@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+#include <cmath>
+
+// Counter-based random numbers.
+//
+// A draw is a pure function of (seed, stream, day, key, counter): nothing is
+// shared between call sites, so any thread can draw for any agent and a run is
+// bit-identical whatever the schedule. Each stochastic call site has its own
+// stream tag so two sites never reuse the same numbers for one agent.
+namespace rng
+{
+    enum class stream : uint64_t
+    {
+        Weather = 1,
+        ConsumerIncome,
+        FarmerIncome,
+        LaborerIncome,
+        FirmWage,
+        FirmCapital,
+        DemandShock,
+        LandSize,
+        Synthetic, // world generators (bench, population builder)
+        Sweep,     // Latin-hypercube points (sweep.h)
+    };
+
+    // SplitMix64 finaliser: a bijective avalanche mix of 64 bits
+    inline uint64_t mix(uint64_t z)
+    {
+        z += 0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    // One independent sequence of draws; cheap to build, copy and discard
+    class generator
+    {
+    public:
+        generator(uint64_t seed, stream s, uint64_t day, uint64_t key)
+            : base(mix(mix(mix(mix(seed) ^ (uint64_t)s) ^ day) ^ key)) {}
+
+        uint64_t next() { return mix(base + counter++); }
+
+        // [0, 1)
+        double uniform() { return (double)(next() >> 11) * 0x1.0p-53; }
+
+        // [lo, hi)
+        double uniform(double lo, double hi) { return lo + (hi - lo) * uniform(); }
+
+        // [0, n); n must be > 0
+        int below(int n) { return (int)(uniform() * n); }
+
+        // Standard normal (Box–Muller; two draws per value)
+        double normal()
+        {
+            double u = 1.0 - uniform(); // (0, 1], so the log is finite
+            return std::sqrt(-2.0 * std::log(u)) * std::cos(6.283185307179586 * uniform());
+        }
+
+        // Log-normal with the given median and log-scale spread
+        double lognormal(double median, double sigma) { return median * std::exp(sigma * normal()); }
+
+    private:
+        uint64_t base;
+        uint64_t counter = 0;
+    };
+}
@@ -0,0 +1,198 @@
+#pragma once
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <streambuf>
+#include "world.h"
+#include "executor.h"
+#include "outputsink.h"
+
+// A command file parsed once up front: one CLI command per line, in the same
+// syntax as the interactive prompt (see notes.md). Blank lines, '#' / '//'
+// comments and quoted narration lines ("...") are skipped.
+class commandScript
+{
+public:
+    std::vector<Command> commands;
+    std::vector<int> lineNumbers;    // source line of each command
+    std::vector<std::string> errors; // lines that did not parse, with line numbers
+
+    bool load(const std::string &path, CommandParser &parser, std::string &err)
+    {
+        std::ifstream in(path);
+        if (!in)
+        {
+            err = "cannot open " + path;
+            return false;
+        }
+        std::string text;
+        for (int n = 1; std::getline(in, text); n++)
+        {
+            size_t a = text.find_first_not_of(" \t\r");
+            if (a == std::string::npos)
+                continue;
+            size_t b = text.find_last_not_of(" \t\r");
+            std::string line = text.substr(a, b - a + 1);
+            if (line[0] == '#' || line[0] == '"' || line.compare(0, 2, "//") == 0)
+                continue;
+
+            Command cmd = parser.parse(line);
+            if (!cmd.valid)
+            {
+                errors.push_back(path + ":" + std::to_string(n) + ": " + cmd.errorMessage);
+                continue;
+            }
+            commands.push_back(std::move(cmd));
+            lineNumbers.push_back(n);
+        }
+        return true;
+    }
+};
+
+// Headless script mode: runs command files through cmdExec with no prompt,
+// no pacing sleeps and (with --quiet) no output, each on a fresh world.
+//
+//   ./cppConomy --script demo.txt --quiet
+//   ./cppConomy --script a.txt --script b.txt --threads 0 --seed 7
+class scriptRunner
+{
+public:
+    struct options
+    {
+        std::vector<std::string> paths;
+        bool quiet = false;
+        bool plain = false; // no ANSI styling (--plain, or NO_COLOR)
+        int threads = 1; // 0 = all cores
+        uint64_t seed = 42;
+    };
+
+    explicit scriptRunner(options opt) : opt(opt) {}
+
+    // Number of failed commands (parse errors included); -1 if a file is unreadable
+    int run()
+    {
+        styledTerminal::plainText = opt.plain;
+        outputSink sink(std::cout, opt.plain); // drained on return
+        int failures = 0;
+        for (auto &path : opt.paths)
+        {
+            world simulation;
+            simulation.seed = opt.seed;
+            simulation.setThreads(opt.threads);
+            simulation.innitialize();
+
+            cmdExec exec(simulation, [this](const std::string &msg)
+                         {
+                             if (!opt.quiet)
+                                 std::cout << msg << "\n"; });
+            exec.animate = false;
+
+            commandScript script;
+            std::string err;
+            if (!script.load(path, exec.parser, err))
+            {
+                std::cerr << err << "\n";
+                return -1;
+            }
+            for (auto &e : script.errors)
+                std::cerr << e << "\n";
+            failures += (int)script.errors.size();
+            exec.prepare(script.commands);
+
+            auto start = std::chrono::steady_clock::now();
+            failures += execute(exec, script, path);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            std::cerr << path << ": " << script.commands.size() << " commands, day "
+                      << simulation.dayCount << ", " << ms << " ms\n";
+        }
+        return failures;
+    }
+
+    // Parses --script F (repeatable) [--quiet] [--plain] [--threads T] [--seed S]
+    static bool parseArgs(int argc, char **argv, options &opt)
+    {
+        opt.plain = outputSink::wantsPlain(argc, argv);
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            if (arg == "--quiet")
+            {
+                opt.quiet = true;
+                continue;
+            }
+            if (arg == "--plain")
+            {
+                opt.plain = true;
+                continue;
+            }
+            if (i + 1 >= argc)
+            {
+                std::cerr << "missing value for " << arg << "\n";
+                return false;
+            }
+            std::string val = argv[++i];
+            try
+            {
+                if (arg == "--script")
+                    opt.paths.push_back(val);
+                else if (arg == "--threads")
+                    opt.threads = std::stoi(val);
+                else if (arg == "--seed")
+                    opt.seed = std::stoull(val);
+                else
+                {
+                    std::cerr << "unknown option " << arg << "\n";
+                    return false;
+                }
+            }
+            catch (const std::exception &)
+            {
+                std::cerr << "bad value for " << arg << ": " << val << "\n";
+                return false;
+            }
+        }
+        return !opt.paths.empty();
+    }
+
+    static bool wantsScript(int argc, char **argv)
+    {
+        for (int i = 1; i < argc; i++)
+            if (std::string(argv[i]) == "--script")
+                return true;
+        return false;
+    }
+
+private:
+    // Swallows everything written to it
+    struct nullBuffer : std::streambuf
+    {
+        int overflow(int c) override { return c; }
+    };
+
+    int execute(cmdExec &exec, const commandScript &script, const std::string &path)
+    {
+        nullBuffer sink;
+        std::streambuf *saved = opt.quiet ? std::cout.rdbuf(&sink) : nullptr;
+
+        int failures = 0;
+        for (size_t i = 0; i < script.commands.size(); i++)
+        {
+            const Command &cmd = script.commands[i];
+            if (cmd.name == "exit")
+                break;
+            if (!exec.execute(cmd))
+            {
+                failures++;
+                std::cerr << path << ":" << script.lineNumbers[i] << ": " << exec.getLastError() << "\n";
+            }
+        }
+
+        if (saved)
+            std::cout.rdbuf(saved);
+        return failures;
+    }
+
+    options opt;
+};
@@ -0,0 +1,735 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iterator>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "world.h"
+
+// Versioned binary snapshot of a world.
+//
+// File layout: a fixed header, a table of sections, then each section's data
+// 8-byte aligned. A section is a packed array of one POD record type (or raw
+// doubles / ints / chars), so loading is a bounds check plus bulk copies
+// straight out of a read-only memory map (whole-file read on Windows).
+// Demand and supply curves are stored column-major exactly as the stores hold
+// them. The RNG is counter-based, so (seed, dayCount) is its entire state.
+// Firm capital is stored as its running totals plus one record per vintage
+// (version 2; version 1 kept one record per machine). Version 3 adds the
+// clearing mode, the regional imports and the joint solver's warm start, so
+// a run in any clearing mode continues exactly after a load.
+namespace snapshot
+{
+    static constexpr char MAGIC[8] = {'C', 'P', 'P', 'C', 'O', 'N', 'O', 'M'};
+    static constexpr uint32_t VERSION = 3;
+
+    enum tag : uint32_t
+    {
+        WorldScalars = 1,
+        ProductNames, // char blob, ids 0..n-1 separated by '\0'
+        Names,        // char blob for agent names
+        Ints,         // int pool: needs, crops, workers, product ids, free rows
+        Doubles,      // double pool: price history
+        Agents,       // agentRec for consumers, then laborers, then farmers
+        Laborers,     // laborerRec parallel to the laborer agentRecs
+        Farmers,      // farmerRec parallel to the farmer agentRecs
+        Crops,        // cropRec pool
+        Firms,
+        Capitals,
+        Markets,
+        DemandSlope, // cols * rows, column-major
+        DemandIntercept,
+        DemandConsumed,
+        DemandSubstitution,
+        SupplySlope,
+        SupplyIntercept,
+        Clearing,       // clearingRec
+        Imports,        // doubles, product id -> units imported per day
+        SolverLive,     // chars, per market slot (see equilibriumSolver::restore)
+        SolverCleared,  // chars, per market slot
+        SolverJacobian, // doubles, k x k over the live slots
+    };
+
+    struct header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t sectionCount;
+        uint64_t fileSize;
+    };
+
+    struct sectionEntry
+    {
+        uint32_t tag;
+        uint32_t elemSize;
+        uint64_t offset;
+        uint64_t count;
+    };
+
+    // A [offset, offset + count) slice of one of the pools
+    struct span
+    {
+        uint32_t offset;
+        uint32_t count;
+    };
+
+    struct worldRec
+    {
+        int64_t dayCount;
+        uint64_t seed;
+        double gdp, unemployment, moneySupply;
+        int32_t employed, population, firms;
+        int32_t consumers, laborers, farmers;
+        int32_t demandCols, demandRows;
+        int32_t supplyCols, supplyRows;
+        span demandFree, supplyFree;
+    };
+
+    struct agentRec
+    {
+        int32_t id, ageInDays, row, isAlive;
+        double savings, expenses, incomePerDay, muPerTk;
+        span name, needs;
+    };
+
+    struct laborerRec
+    {
+        double skillLevel, minWage;
+    };
+
+    struct farmerRec
+    {
+        double land, techLevel, weather, weatherChange, tax;
+        int32_t supplyRow, pad;
+        span crops; // into Crops
+    };
+
+    struct cropRec
+    {
+        int32_t productId, pad;
+        double ssM, ssC, growthRate, decay, maxOutput;
+    };
+
+    struct firmRec
+    {
+        double cash, wage, fixedOverhead;
+        double totalFixedCost, totalVariableCost, totalCost;
+        double averageFixedCost, averageVariableCost, averageCost;
+        double marginalCost, currentOutput;
+        double alpha, beta, cdTech, rho, cesTech;
+        double capitalRental, capitalUnits;
+        int32_t ownerId, prodType, capitalCount, pad;
+        span workers, products, capitals; // capitals: vintages
+    };
+
+    struct capitalRec
+    {
+        int32_t year, count;
+        double rental, units;
+    };
+
+    struct marketRec
+    {
+        int32_t productId, pad;
+        double price, demandM, demandC, supplyM, supplyC;
+        double excessDemand, priceAdjustmentSpeed, quantityTraded, revenue;
+        span history; // into Doubles
+    };
+
+    struct clearingRec
+    {
+        int32_t orderMatching, jointClearing, maxIterations, pad;
+        double tolerance;
+    };
+
+    // ── WRITER ────────────────────────────────────────────────────────────
+    class writer
+    {
+    public:
+        template <class T>
+        void put(tag t, const T *data, size_t count)
+        {
+            while (body.size() % 8)
+                body.push_back(0);
+            sections.push_back({t, (uint32_t)sizeof(T), (uint64_t)body.size(), (uint64_t)count});
+            const char *p = reinterpret_cast<const char *>(data);
+            body.insert(body.end(), p, p + sizeof(T) * count);
+        }
+
+        template <class T>
+        void put(tag t, const std::vector<T> &v) { put(t, v.data(), v.size()); }
+
+        bool save(const std::string &path, std::string &err) const
+        {
+            header h;
+            std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+            h.version = VERSION;
+            h.sectionCount = (uint32_t)sections.size();
+            uint64_t bodyStart = sizeof(header) + sizeof(sectionEntry) * sections.size();
+            bodyStart = (bodyStart + 7) / 8 * 8;
+            h.fileSize = bodyStart + body.size();
+
+            std::vector<sectionEntry> table = sections;
+            for (auto &s : table)
+                s.offset += bodyStart;
+
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            if (!out)
+            {
+                err = "cannot open " + path + " for writing";
+                return false;
+            }
+            out.write(reinterpret_cast<const char *>(&h), sizeof(h));
+            out.write(reinterpret_cast<const char *>(table.data()), sizeof(sectionEntry) * table.size());
+            static const char zeros[8] = {};
+            out.write(zeros, bodyStart - sizeof(header) - sizeof(sectionEntry) * table.size());
+            out.write(body.data(), body.size());
+            if (!out)
+            {
+                err = "write failed for " + path;
+                return false;
+            }
+            return true;
+        }
+
+    private:
+        std::vector<sectionEntry> sections;
+        std::vector<char> body;
+    };
+
+    // ── MAPPED FILE ───────────────────────────────────────────────────────
+    class mappedFile
+    {
+    public:
+        bool open(const std::string &path, std::string &err)
+        {
+#ifndef _WIN32
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+            {
+                err = "cannot open " + path;
+                return false;
+            }
+            struct stat st;
+            if (fstat(fd, &st) != 0 || st.st_size <= 0)
+            {
+                ::close(fd);
+                err = "cannot read " + path;
+                return false;
+            }
+            size = (size_t)st.st_size;
+            void *p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (p == MAP_FAILED)
+            {
+                err = "cannot map " + path;
+                size = 0;
+                return false;
+            }
+            data = static_cast<const char *>(p);
+            return true;
+#else
+            std::ifstream in(path, std::ios::binary);
+            if (!in)
+            {
+                err = "cannot open " + path;
+                return false;
+            }
+            fallback.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+            data = fallback.data();
+            size = fallback.size();
+            return true;
+#endif
+        }
+
+        mappedFile() = default;
+        mappedFile(const mappedFile &) = delete;
+        mappedFile &operator=(const mappedFile &) = delete;
+
+        ~mappedFile()
+        {
+#ifndef _WIN32
+            if (data)
+                munmap(const_cast<char *>(data), size);
+#endif
+        }
+
+        const char *data = nullptr;
+        size_t size = 0;
+
+    private:
+#ifdef _WIN32
+        std::vector<char> fallback;
+#endif
+    };
+
+    // ── READER ────────────────────────────────────────────────────────────
+    class reader
+    {
+    public:
+        bool open(const std::string &path, std::string &err)
+        {
+            if (!file.open(path, err))
+                return false;
+            if (file.size < sizeof(header))
+                return fail(err, "file too small");
+            std::memcpy(&h, file.data, sizeof(h));
+            if (std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0)
+                return fail(err, "not a cppConomy snapshot");
+            if (h.version != VERSION)
+                return fail(err, "unsupported snapshot version " + std::to_string(h.version));
+            if (h.fileSize != file.size ||
+                sizeof(header) + sizeof(sectionEntry) * (uint64_t)h.sectionCount > file.size)
+                return fail(err, "truncated snapshot");
+            table = reinterpret_cast<const sectionEntry *>(file.data + sizeof(header));
+            for (uint32_t i = 0; i < h.sectionCount; i++)
+                if (table[i].offset + table[i].elemSize * table[i].count > file.size)
+                    return fail(err, "section out of bounds");
+            return true;
+        }
+
+        // Pointer to a section's records; nullptr (and count 0) if missing or
+        // written with a different record size
+        template <class T>
+        const T *get(tag t, size_t &count) const
+        {
+            for (uint32_t i = 0; i < h.sectionCount; i++)
+            {
+                if (table[i].tag != t)
+                    continue;
+                if (table[i].elemSize != sizeof(T))
+                    break;
+                count = (size_t)table[i].count;
+                return reinterpret_cast<const T *>(file.data + table[i].offset);
+            }
+            count = 0;
+            return nullptr;
+        }
+
+    private:
+        static bool fail(std::string &err, const std::string &msg)
+        {
+            err = msg;
+            return false;
+        }
+
+        mappedFile file;
+        header h{};
+        const sectionEntry *table = nullptr;
+    };
+
+    // ── SAVE ──────────────────────────────────────────────────────────────
+    inline bool save(const world &w, const std::string &path, std::string &err)
+    {
+        writer out;
+        std::vector<char> names;
+        std::vector<int32_t> ints;
+        std::vector<double> doubles;
+
+        auto addName = [&](const std::string &s) -> span
+        {
+            span sp{(uint32_t)names.size(), (uint32_t)s.size()};
+            names.insert(names.end(), s.begin(), s.end());
+            return sp;
+        };
+        auto addInts = [&](const std::vector<int> &v) -> span
+        {
+            span sp{(uint32_t)ints.size(), (uint32_t)v.size()};
+            ints.insert(ints.end(), v.begin(), v.end());
+            return sp;
+        };
+
+        // Products, so a load can check the catalogue ids still line up
+        std::vector<char> productNames;
+        for (product *p : catalogue().all())
+        {
+            productNames.insert(productNames.end(), p->name.begin(), p->name.end());
+            productNames.push_back('\0');
+        }
+
+        std::vector<agentRec> agents;
+        auto addAgent = [&](const consumer &c)
+        {
+            std::vector<int> needs;
+            for (auto &n : c.needs)
+                needs.push_back(n.id);
+            agents.push_back({c.id, c.ageInDays, c.row, c.isAlive ? 1 : 0,
+                              c.savings, c.expenses, c.incomePerDay, c.muPerTk,
+                              addName(c.name), addInts(needs)});
+        };
+
+        std::vector<laborerRec> laborers;
+        std::vector<farmerRec> farmers;
+        std::vector<cropRec> crops;
+        for (auto &c : w.consumers)
+            addAgent(c);
+        for (auto &l : w.laborers)
+        {
+            addAgent(l);
+            laborers.push_back({l.skillLevel, l.minWage});
+        }
+        for (auto &f : w.farmers)
+        {
+            addAgent(f);
+            span cs{(uint32_t)crops.size(), (uint32_t)f.crops.size()};
+            for (size_t i = 0; i < f.crops.size(); i++)
+                crops.push_back({f.crops[i].id, 0, f.ss[i].m, f.ss[i].c,
+                                 f.growthRate[i], f.decay[i], f.maxOutput[i]});
+            farmers.push_back({f.land, f.techLevel, f.weather, f.weatherChange, f.tax,
+                               f.supplyRow, 0, cs});
+        }
+
+        std::vector<firmRec> firms;
+        std::vector<capitalRec> capitals;
+        for (auto &fi : w.firms)
+        {
+            span caps{(uint32_t)capitals.size(), (uint32_t)fi.capitals.vintages().size()};
+            for (auto &v : fi.capitals.vintages())
+                capitals.push_back({v.year, v.count, v.rental, v.units});
+            firms.push_back({fi.cash, fi.wage, fi.fixed_overhead,
+                             fi.totalFixedCost, fi.totalVariableCost, fi.totalCost,
+                             fi.averageFixedCost, fi.averageVariableCost, fi.averageCost,
+                             fi.marginalCost, fi.currentOutput,
+                             fi.cdProd.alpha, fi.cdProd.beta, fi.cdProd.tech,
+                             fi.cesProd.rho, fi.cesProd.tech,
+                             fi.capitals.rental(), fi.capitals.units(),
+                             fi.ownerId, (int32_t)fi.prodType, fi.capitals.count(), 0,
+                             addInts(fi.workers), addInts(fi.productIds), caps});
+        }
+
+        std::vector<marketRec> markets;
+        for (auto &m : w.markets)
+        {
+            span hist{(uint32_t)doubles.size(), (uint32_t)m.priceHistory.size()};
+            doubles.insert(doubles.end(), m.priceHistory.begin(), m.priceHistory.end());
+            markets.push_back({m.prod->id, 0, m.price,
+                               m.aggregateDemand.m, m.aggregateDemand.c,
+                               m.aggregateSupply.m, m.aggregateSupply.c,
+                               m.excessDemand, m.priceAdjustmentSpeed,
+                               m.quantityTraded, m.revenue, hist});
+        }
+
+        // Curves, column-major (the sparse demand cells are written out
+        // densely, so the file layout does not depend on the store's)
+        const demandStore &d = w.demand;
+        int dCols = d.columns(), dRows = d.rows();
+        std::vector<double> dm, dc, dq, ds;
+        d.exportColumns(dm, dc, dq, ds);
+        const supplyStore &s = w.supply;
+        int sCols = s.columns(), sRows = s.rows();
+        std::vector<double> sm, sc;
+        for (int col = 0; col < sCols; col++)
+        {
+            sm.insert(sm.end(), s.slopeData(col), s.slopeData(col) + sRows);
+            sc.insert(sc.end(), s.interceptData(col), s.interceptData(col) + sRows);
+        }
+
+        worldRec wr{};
+        wr.dayCount = w.dayCount;
+        wr.seed = w.seed;
+        wr.gdp = w.currentStats.gdp;
+        wr.unemployment = w.currentStats.unemployment;
+        wr.moneySupply = w.currentStats.moneySupply;
+        wr.employed = w.currentStats.employed;
+        wr.population = w.currentStats.population;
+        wr.firms = w.currentStats.firms;
+        wr.consumers = (int32_t)w.consumers.size();
+        wr.laborers = (int32_t)w.laborers.size();
+        wr.farmers = (int32_t)w.farmers.size();
+        wr.demandCols = dCols;
+        wr.demandRows = dRows;
+        wr.supplyCols = sCols;
+        wr.supplyRows = sRows;
+        wr.demandFree = addInts(d.freeList());
+        wr.supplyFree = addInts(s.freeList());
+
+        out.put(WorldScalars, &wr, 1);
+        out.put(ProductNames, productNames);
+        out.put(Names, names);
+        out.put(Ints, ints);
+        out.put(Doubles, doubles);
+        out.put(Agents, agents);
+        out.put(Laborers, laborers);
+        out.put(Farmers, farmers);
+        out.put(Crops, crops);
+        out.put(Firms, firms);
+        out.put(Capitals, capitals);
+        out.put(Markets, markets);
+        out.put(DemandSlope, dm);
+        out.put(DemandIntercept, dc);
+        out.put(DemandConsumed, dq);
+        out.put(DemandSubstitution, ds);
+        out.put(SupplySlope, sm);
+        out.put(SupplyIntercept, sc);
+
+        clearingRec cr{w.orderMatching ? 1 : 0, w.jointClearing ? 1 : 0, w.solver.maxIterations, 0,
+                       w.solver.tolerance};
+        out.put(Clearing, &cr, 1);
+        out.put(Imports, w.imports);
+        out.put(SolverLive, w.solver.liveSlots());
+        out.put(SolverCleared, w.solver.clearedSlots());
+        out.put(SolverJacobian, w.solver.jacobianMatrix());
+        return out.save(path, err);
+    }
+
+    // ── LOAD ──────────────────────────────────────────────────────────────
+    // Replaces the world's state. On failure the world is left untouched.
+    inline bool load(world &w, const std::string &path, std::string &err)
+    {
+        reader in;
+        if (!in.open(path, err))
+            return false;
+
+        size_t n = 0, nNames = 0, nInts = 0, nDoubles = 0, nProducts = 0;
+        const worldRec *wr = in.get<worldRec>(WorldScalars, n);
+        const char *productNames = in.get<char>(ProductNames, nProducts);
+        const char *names = in.get<char>(Names, nNames);
+        const int32_t *ints = in.get<int32_t>(Ints, nInts);
+        const double *doubles = in.get<double>(Doubles, nDoubles);
+        if (!wr || n != 1)
+        {
+            err = "missing world section";
+            return false;
+        }
+
+        // Product ids must mean the same thing as when the file was written
+        {
+            std::string expected;
+            for (product *p : catalogue().all())
+                expected.append(p->name).push_back('\0');
+            if (!productNames || expected.compare(0, std::string::npos, productNames, nProducts) != 0)
+            {
+                err = "product catalogue does not match snapshot";
+                return false;
+            }
+        }
+
+        size_t nAgents = 0, nLab = 0, nFarm = 0, nCrops = 0, nFirms = 0, nCaps = 0, nMarkets = 0;
+        const agentRec *agents = in.get<agentRec>(Agents, nAgents);
+        const laborerRec *labs = in.get<laborerRec>(Laborers, nLab);
+        const farmerRec *farms = in.get<farmerRec>(Farmers, nFarm);
+        const cropRec *crops = in.get<cropRec>(Crops, nCrops);
+        const firmRec *firms = in.get<firmRec>(Firms, nFirms);
+        const capitalRec *caps = in.get<capitalRec>(Capitals, nCaps);
+        const marketRec *markets = in.get<marketRec>(Markets, nMarkets);
+
+        size_t dCells = (size_t)wr->demandCols * wr->demandRows;
+        size_t sCells = (size_t)wr->supplyCols * wr->supplyRows;
+        size_t c1, c2, c3, c4, c5, c6;
+        const double *dm = in.get<double>(DemandSlope, c1);
+        const double *dc = in.get<double>(DemandIntercept, c2);
+        const double *dq = in.get<double>(DemandConsumed, c3);
+        const double *ds = in.get<double>(DemandSubstitution, c4);
+        const double *sm = in.get<double>(SupplySlope, c5);
+        const double *sc = in.get<double>(SupplyIntercept, c6);
+
+        size_t nClearing = 0, nImports = 0, nLive = 0, nCleared = 0, nJacobian = 0;
+        const clearingRec *clearing = in.get<clearingRec>(Clearing, nClearing);
+        const double *imports = in.get<double>(Imports, nImports);
+        const char *live = in.get<char>(SolverLive, nLive);
+        const char *cleared = in.get<char>(SolverCleared, nCleared);
+        const double *jacobian = in.get<double>(SolverJacobian, nJacobian);
+
+        // ── Validate every count and span before touching the world ──────
+        auto intsOk = [&](span s)
+        { return (size_t)s.offset + s.count <= nInts; };
+        bool ok = nAgents == (size_t)wr->consumers + wr->laborers + wr->farmers &&
+                  nLab == (size_t)wr->laborers && nFarm == (size_t)wr->farmers &&
+                  c1 == dCells && c2 == dCells && c3 == dCells && c4 == dCells &&
+                  c5 == sCells && c6 == sCells &&
+                  intsOk(wr->demandFree) && intsOk(wr->supplyFree);
+        for (size_t i = 0; ok && i < nAgents; i++)
+            ok = (size_t)agents[i].name.offset + agents[i].name.count <= nNames && intsOk(agents[i].needs) &&
+                 agents[i].row >= 0 && agents[i].row < wr->demandRows;
+        for (size_t i = 0; ok && i < nFarm; i++)
+            ok = (size_t)farms[i].crops.offset + farms[i].crops.count <= nCrops &&
+                 farms[i].supplyRow >= -1 && farms[i].supplyRow < wr->supplyRows;
+        for (size_t i = 0; ok && i < nFirms; i++)
+            ok = intsOk(firms[i].workers) && intsOk(firms[i].products) &&
+                 (size_t)firms[i].capitals.offset + firms[i].capitals.count <= nCaps &&
+                 firms[i].capitalCount >= 0;
+        for (size_t i = 0; ok && i < nMarkets; i++)
+            ok = (size_t)markets[i].history.offset + markets[i].history.count <= nDoubles &&
+                 catalogue().get(markets[i].productId) != nullptr;
+        auto idsOk = [&](span s)
+        {
+            for (uint32_t k = 0; k < s.count; k++)
+                if (!catalogue().get(ints[s.offset + k]))
+                    return false;
+            return true;
+        };
+        for (size_t i = 0; ok && i < nAgents; i++)
+            ok = idsOk(agents[i].needs);
+        for (size_t i = 0; ok && i < nCrops; i++)
+            ok = catalogue().get(crops[i].productId) != nullptr;
+        for (size_t i = 0; ok && i < nFirms; i++)
+            ok = idsOk(firms[i].products);
+
+        // Clearing mode and the solver's warm start, which must describe
+        // these markets (no solve yet leaves the lists empty)
+        equilibriumSolver warm;
+        ok = ok && clearing && nClearing == 1 && clearing->maxIterations >= 1 && clearing->tolerance >= 0.0 &&
+             nImports <= (size_t)catalogue().size() && (nLive == 0 || nLive == nMarkets) &&
+             warm.restore(std::vector<char>(live, live + nLive), std::vector<char>(cleared, cleared + nCleared),
+                          std::vector<double>(jacobian, jacobian + nJacobian));
+        if (!ok)
+        {
+            err = "corrupt snapshot";
+            return false;
+        }
+
+        // ── Restore ──────────────────────────────────────────────────────
+        w.selected_consumer = {};
+        w.selected_laborer = {};
+        w.selected_farmer = {};
+        w.selected_market = nullptr;
+        w.selected_firm = nullptr;
+
+        w.dayCount = (int)wr->dayCount;
+        w.seed = wr->seed;
+        w.currentStats.gdp = wr->gdp;
+        w.currentStats.unemployment = wr->unemployment;
+        w.currentStats.moneySupply = wr->moneySupply;
+        w.currentStats.employed = wr->employed;
+        w.currentStats.population = wr->population;
+        w.currentStats.firms = wr->firms;
+        w.statsStale = false; // the saved stats describe exactly these agents
+
+        w.demand.restore(wr->demandCols, wr->demandRows, dm, dc, dq, ds,
+                         ints + wr->demandFree.offset, wr->demandFree.count);
+        w.supply.restore(wr->supplyCols, wr->supplyRows, sm, sc,
+                         ints + wr->supplyFree.offset, wr->supplyFree.count);
+
+        auto fill = [&](consumer &c, const agentRec &r)
+        {
+            c.ageInDays = r.ageInDays;
+            c.isAlive = r.isAlive != 0;
+            c.savings = r.savings;
+            c.expenses = r.expenses;
+            c.incomePerDay = r.incomePerDay;
+            c.muPerTk = r.muPerTk;
+            c.needs.clear();
+            for (uint32_t k = 0; k < r.needs.count; k++)
+                c.needs.push_back({ints[r.needs.offset + k]});
+            c.store = &w.demand;
+            c.row = r.row;
+        };
+        auto nameOf = [&](const agentRec &r)
+        { return std::string(names + r.name.offset, r.name.count); };
+
+        w.consumers.clear();
+        w.laborers.clear();
+        w.farmers.clear();
+        w.consumers.reserve(wr->consumers);
+        w.laborers.reserve(wr->laborers);
+        w.farmers.reserve(wr->farmers);
+
+        size_t a = 0;
+        for (int i = 0; i < wr->consumers; i++, a++)
+        {
+            fill(w.consumers.emplace(agents[a].id, nameOf(agents[a]), 0), agents[a]);
+        }
+        for (int i = 0; i < wr->laborers; i++, a++)
+        {
+            fill(w.laborers.emplace(agents[a].id, nameOf(agents[a]), 0, labs[i].skillLevel, labs[i].minWage), agents[a]);
+        }
+        for (int i = 0; i < wr->farmers; i++, a++)
+        {
+            const farmerRec &fr = farms[i];
+            farmer &f = w.farmers.emplace(agents[a].id, nameOf(agents[a]), 0, fr.land, fr.techLevel);
+            fill(f, agents[a]);
+            f.weather = fr.weather;
+            f.weatherChange = fr.weatherChange;
+            f.tax = fr.tax;
+            for (uint32_t k = 0; k < fr.crops.count; k++)
+            {
+                const cropRec &cr = crops[fr.crops.offset + k];
+                f.addCrop(catalogue().get(cr.productId), {cr.ssM, cr.ssC},
+                          cr.growthRate, cr.decay, cr.maxOutput);
+            }
+            f.supplyLedger = &w.supply; // rows already hold these curves
+            f.supplyRow = fr.supplyRow;
+        }
+
+        w.firms.clear();
+        w.firms.reserve(nFirms);
+        for (size_t i = 0; i < nFirms; i++)
+        {
+            const firmRec &r = firms[i];
+            w.firms.emplace_back(r.ownerId, r.cash, cobbDouglas(r.alpha, r.beta, r.cdTech));
+            firm &fi = w.firms.back();
+            fi.cesProd = ces(r.rho);
+            fi.cesProd.tech = r.cesTech;
+            fi.prodType = (firm::ProdType)r.prodType;
+            fi.bindProdFunc();
+            fi.invalidateOutput();
+            fi.wage = r.wage;
+            fi.fixed_overhead = r.fixedOverhead;
+            fi.totalFixedCost = r.totalFixedCost;
+            fi.totalVariableCost = r.totalVariableCost;
+            fi.totalCost = r.totalCost;
+            fi.averageFixedCost = r.averageFixedCost;
+            fi.averageVariableCost = r.averageVariableCost;
+            fi.averageCost = r.averageCost;
+            fi.marginalCost = r.marginalCost;
+            fi.currentOutput = r.currentOutput;
+            fi.workers.assign(ints + r.workers.offset, ints + r.workers.offset + r.workers.count);
+            fi.productIds.assign(ints + r.products.offset, ints + r.products.offset + r.products.count);
+            std::vector<capitalStock::vintage> vintages;
+            vintages.reserve(r.capitals.count + firm::VINTAGE_HEADROOM);
+            for (uint32_t k = 0; k < r.capitals.count; k++)
+            {
+                const capitalRec &c = caps[r.capitals.offset + k];
+                vintages.push_back({c.year, c.count, c.rental, c.units});
+            }
+            fi.capitals.restore(r.capitalCount, r.capitalRental, r.capitalUnits, std::move(vintages));
+        }
+
+        w.markets.clear();
+        w.marketIndex.assign(catalogue().size(), -1);
+        w.prices.assign(catalogue().size(), 0.0);
+        for (size_t i = 0; i < nMarkets; i++)
+        {
+            const marketRec &r = markets[i];
+            w.marketIndex[r.productId] = (int)w.markets.size();
+            w.markets.emplace_back(catalogue().get(r.productId));
+            market &m = w.markets.back();
+            m.price = r.price;
+            m.aggregateDemand = {r.demandM, r.demandC};
+            m.aggregateSupply = {r.supplyM, r.supplyC};
+            m.excessDemand = r.excessDemand;
+            m.priceAdjustmentSpeed = r.priceAdjustmentSpeed;
+            m.quantityTraded = r.quantityTraded;
+            m.revenue = r.revenue;
+            m.priceHistory.assign(doubles + r.history.offset, doubles + r.history.offset + r.history.count);
+            m.cleared = m.solve(); // curves are as last cleared
+            w.prices[r.productId] = m.price;
+        }
+
+        w.rebuildEmployment();
+
+        w.orderMatching = clearing->orderMatching != 0;
+        w.jointClearing = clearing->jointClearing != 0;
+        w.solver.tolerance = clearing->tolerance;
+        w.solver.maxIterations = clearing->maxIterations;
+        w.solver.restore(warm.liveSlots(), warm.clearedSlots(), warm.jacobianMatrix());
+        w.imports.assign(imports, imports + nImports);
+
+        w.selected_consumer = w.consumers.first();
+        w.selected_laborer = w.laborers.first();
+        w.selected_farmer = w.farmers.first();
+        w.selected_market = w.markets.empty() ? nullptr : &w.markets[0];
+        w.selected_firm = w.firms.empty() ? nullptr : &w.firms[0];
+        return true;
+    }
+}
@@ -75,6 +75,15 @@ namespace styledTerminal
         constexpr const char *Highlight = Color::BrightWhite;
     }
 
+    // Cursor and screen control (written directly, no shell-out)
+    namespace Screen
+    {
+        constexpr const char *Clear = "\033[H\033[2J\033[3J"; // cursor home, erase screen and scrollback (as clear(1))
+    }
+
+    // No-ANSI mode (--plain, or NO_COLOR set): Styled() returns the text as is
+    inline bool plainText = false;
+
     // Box drawing characters (Unicode rounded corners like Claude)
     namespace Box
     {
@@ -91,8 +100,17 @@ namespace styledTerminal
         constexpr const char *Cross = "┼";
     }
 
-    // Utility functions for styled output                               ╭ convert char to std::string
-    inline std::string Styled(const std::string &text, const char *style) { return std::string(style) + text + Color::Reset; } // ansiCode + text + reset
+    // Utility functions for styled output
+    inline std::string Styled(const std::string &text, const char *style) // ansiCode + text + reset
+    {
+        if (plainText)
+            return text;
+        size_t styleLen = std::char_traits<char>::length(style);
+        std::string s;
+        s.reserve(styleLen + text.size() + 4); // one allocation; Reset is 4 bytes
+        s.append(style, styleLen).append(text).append(Color::Reset);
+        return s;
+    }
 
     // Helper to repeat a std::string n times
     inline std::string Repeat(const std::string &str, size_t count)
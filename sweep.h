@@ -0,0 +1,356 @@
+#pragma once
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+#include "world.h"
+#include "snapshot.h"
+#include "threadpool.h"
+#include "rng.h"
+
+// Policy sweep: one base world (initialised or loaded from a snapshot) is
+// forked once per parameter point, the policy is applied to the fork, and the
+// forks run side by side, one per pool thread and each single-threaded, for
+// the same number of days. Every fork keeps the base seed, so two points see
+// the same weather and income draws and differ only by their policy.
+//
+//   ./cppConomy --sweep 365 --tax 0:0.3:4 --wage 300:600:4 --threads 0
+//   ./cppConomy --sweep 730 --load year10.snap --lhs 64 --tax 0:0.5 --income 200:800
+//
+// Parameters are economy-wide versions of the CLI commands:
+//   tax     farmer_tax(rate) on every farmer      (0 – 1)
+//   tech    farmer_upgrade(level) on every farmer
+//   income  set_income(value) on every consumer   (Tk / day)
+//   wage    the wage every firm starts from       (Tk / day, drifts daily)
+// An axis lo:hi:n takes n evenly spaced values; --lhs N instead draws N
+// Latin-hypercube points over the lo:hi ranges. Unswept parameters keep the
+// base world's values. Output is one CSV row per point, in point order.
+class sweepRunner
+{
+public:
+    enum param
+    {
+        Tax,
+        Tech,
+        Income,
+        Wage,
+        PARAMS
+    };
+
+    struct axis
+    {
+        param which;
+        double lo, hi;
+        int steps = 1;
+    };
+
+    struct options
+    {
+        long long days = 365;
+        std::vector<axis> axes;
+        int lhs = 0;     // > 0: this many Latin-hypercube points instead of a grid
+        int threads = 1; // 0 = all cores
+        uint64_t seed = 42;
+        std::string loadPath; // base world, instead of innitialize()
+        std::string outPath;  // results CSV; stdout if empty
+    };
+
+    // Per point: the parameter values (one per axis) and the outcome
+    struct result
+    {
+        std::vector<double> values;
+        world::stats last;
+        double meanGdp = 0.0, meanUnemployment = 0.0;
+        std::vector<double> prices; // per base market, after the last day
+    };
+
+    static const char *paramName(param p)
+    {
+        static const char *names[PARAMS] = {"tax", "tech", "income", "wage"};
+        return names[p];
+    }
+
+    explicit sweepRunner(options opt) : opt(opt) {}
+
+    // false (with a message on stderr) if the base cannot be loaded or the
+    // results file cannot be written
+    bool run()
+    {
+        world base;
+        std::string err;
+        if (opt.loadPath.empty())
+        {
+            base.seed = opt.seed;
+            base.innitialize();
+        }
+        else if (!snapshot::load(base, opt.loadPath, err))
+        {
+            std::cerr << "cannot load " << opt.loadPath << ": " << err << "\n";
+            return false;
+        }
+
+        std::vector<std::vector<double>> points = opt.lhs > 0 ? latinHypercube(opt.axes, opt.lhs, base.seed)
+                                                              : grid(opt.axes);
+        std::vector<result> results(points.size());
+
+        threadPool pool(opt.threads);
+        auto start = std::chrono::steady_clock::now();
+        pool.parallelFor(points.size(), 1, [&](size_t begin, size_t end)
+                         {
+            for (size_t i = begin; i < end; i++)
+                results[i] = runPoint(base, points[i]); });
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        std::ofstream file;
+        if (!opt.outPath.empty())
+        {
+            file.open(opt.outPath);
+            if (!file)
+            {
+                std::cerr << "cannot write " << opt.outPath << "\n";
+                return false;
+            }
+        }
+        std::ostream &out = opt.outPath.empty() ? std::cout : file;
+        out.precision(10);
+        writeTable(out, base, results);
+
+        std::cerr << "swept " << points.size() << " points × " << opt.days << " days in "
+                  << ms << " ms (" << pool.size() << " threads)\n";
+        return true;
+    }
+
+    // ── POLICY ────────────────────────────────────────────────────────────
+    static void apply(world &w, param p, double v)
+    {
+        switch (p)
+        {
+        case Tax:
+            for (auto &f : w.farmers)
+            {
+                f.tax = std::max(0.0, std::min(1.0, v));
+                for (auto &crop : f.crops)
+                    f.updateSupplyCurve(&crop);
+            }
+            break;
+        case Tech:
+            for (auto &f : w.farmers)
+            {
+                f.upgradeTech(v);
+                for (auto &crop : f.crops)
+                    f.updateSupplyCurve(&crop);
+            }
+            break;
+        case Income:
+            for (auto &c : w.consumers)
+            {
+                double change = std::max(0.0, v) - c.incomePerDay;
+                c.incomePerDay = std::max(0.0, v);
+                c.currentMUperTk();
+                c.updateDemandForIncomeChange(change); // Engel shift, as set_income
+            }
+            break;
+        case Wage:
+            for (auto &f : w.firms)
+                f.wage = std::max(250.0, v); // the floor of the daily wage drift
+            break;
+        default:
+            break;
+        }
+    }
+
+    // ── SAMPLING ──────────────────────────────────────────────────────────
+    // Every combination of the axes' values, the last axis varying fastest
+    static std::vector<std::vector<double>> grid(const std::vector<axis> &axes)
+    {
+        std::vector<std::vector<double>> points(1);
+        for (auto &a : axes)
+        {
+            std::vector<std::vector<double>> next;
+            next.reserve(points.size() * std::max(1, a.steps));
+            for (auto &p : points)
+                for (int k = 0; k < std::max(1, a.steps); k++)
+                {
+                    next.push_back(p);
+                    next.back().push_back(a.steps > 1 ? a.lo + (a.hi - a.lo) * k / (a.steps - 1) : a.lo);
+                }
+            points = std::move(next);
+        }
+        return points;
+    }
+
+    // n points; on every axis each of the n equal strata of [lo, hi] holds
+    // exactly one point, at a uniform offset inside it
+    static std::vector<std::vector<double>> latinHypercube(const std::vector<axis> &axes, int n, uint64_t seed)
+    {
+        std::vector<std::vector<double>> points(n, std::vector<double>(axes.size()));
+        for (size_t d = 0; d < axes.size(); d++)
+        {
+            rng::generator gen(seed, rng::stream::Sweep, 0, d);
+            std::vector<int> strata(n);
+            for (int i = 0; i < n; i++)
+                strata[i] = i;
+            for (int i = n - 1; i > 0; i--) // Fisher–Yates
+                std::swap(strata[i], strata[gen.below(i + 1)]);
+            for (int i = 0; i < n; i++)
+                points[i][d] = axes[d].lo + (axes[d].hi - axes[d].lo) * (strata[i] + gen.uniform()) / n;
+        }
+        return points;
+    }
+
+    // ── ARGUMENTS ─────────────────────────────────────────────────────────
+    // Parses --sweep DAYS [--tax|--tech|--income|--wage LO:HI[:N]]... [--lhs N]
+    // [--threads T] [--seed S] [--load F] [--out F]
+    static bool parseArgs(int argc, char **argv, options &opt)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            if (i + 1 >= argc)
+            {
+                std::cerr << "missing value for " << arg << "\n";
+                return false;
+            }
+            std::string val = argv[++i];
+            try
+            {
+                int p = paramOf(arg);
+                if (arg == "--sweep")
+                    opt.days = std::stoll(val);
+                else if (p >= 0)
+                {
+                    axis a;
+                    if (!parseAxis((param)p, val, a))
+                    {
+                        std::cerr << "bad range for " << arg << ": " << val << "  (LO:HI or LO:HI:N)\n";
+                        return false;
+                    }
+                    opt.axes.push_back(a);
+                }
+                else if (arg == "--lhs")
+                    opt.lhs = std::stoi(val);
+                else if (arg == "--threads")
+                    opt.threads = std::stoi(val);
+                else if (arg == "--seed")
+                    opt.seed = std::stoull(val);
+                else if (arg == "--load")
+                    opt.loadPath = val;
+                else if (arg == "--out")
+                    opt.outPath = val;
+                else
+                {
+                    std::cerr << "unknown option " << arg << "\n";
+                    return false;
+                }
+            }
+            catch (const std::exception &)
+            {
+                std::cerr << "bad value for " << arg << ": " << val << "\n";
+                return false;
+            }
+        }
+        if (opt.days < 0 || opt.lhs < 0)
+        {
+            std::cerr << "day and point counts cannot be negative\n";
+            return false;
+        }
+        if (opt.axes.empty())
+        {
+            std::cerr << "--sweep needs at least one of --tax, --tech, --income, --wage\n";
+            return false;
+        }
+        return true;
+    }
+
+    static bool wantsSweep(int argc, char **argv)
+    {
+        for (int i = 1; i < argc; i++)
+            if (std::string(argv[i]) == "--sweep")
+                return true;
+        return false;
+    }
+
+private:
+    result runPoint(const world &base, const std::vector<double> &values) const
+    {
+        world w;
+        w = base; // fork; the base is only read, so forks can be taken concurrently
+        w.setThreads(1);
+        for (size_t d = 0; d < opt.axes.size(); d++)
+            apply(w, opt.axes[d].which, values[d]);
+
+        result r;
+        r.values = values;
+        for (long long d = 1; d <= opt.days; d++)
+        {
+            w.pass_day();
+            r.meanGdp += w.currentStats.gdp;
+            r.meanUnemployment += w.currentStats.unemployment;
+        }
+        if (opt.days > 0)
+        {
+            r.meanGdp /= opt.days;
+            r.meanUnemployment /= opt.days;
+        }
+        r.last = w.getStats();
+        for (auto &m : base.markets)
+        {
+            int mi = w.marketIndex[m.prod->id];
+            r.prices.push_back(mi >= 0 ? w.markets[mi].price : 0.0);
+        }
+        return r;
+    }
+
+    void writeTable(std::ostream &out, const world &base, const std::vector<result> &results) const
+    {
+        out << "point";
+        for (auto &a : opt.axes)
+            out << ',' << paramName(a.which);
+        out << ",gdp,gdp_per_capita,unemployment,mean_gdp,mean_unemployment,population,money_supply";
+        for (auto &m : base.markets)
+            out << ",price_" << m.prod->name;
+        out << "\n";
+
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            const result &r = results[i];
+            out << i;
+            for (double v : r.values)
+                out << ',' << v;
+            out << ',' << r.last.gdp << ',' << r.last.gdp / std::max(1, r.last.population)
+                << ',' << r.last.unemployment << ',' << r.meanGdp << ',' << r.meanUnemployment
+                << ',' << r.last.population << ',' << r.last.moneySupply;
+            for (double p : r.prices)
+                out << ',' << p;
+            out << "\n";
+        }
+    }
+
+    static int paramOf(const std::string &arg)
+    {
+        for (int p = 0; p < PARAMS; p++)
+            if (arg == std::string("--") + paramName((param)p))
+                return p;
+        return -1;
+    }
+
+    // LO:HI or LO:HI:N (a single value when N is 1)
+    static bool parseAxis(param p, const std::string &val, axis &a)
+    {
+        size_t c1 = val.find(':');
+        if (c1 == std::string::npos)
+            return false;
+        size_t c2 = val.find(':', c1 + 1);
+        a.which = p;
+        a.lo = std::stod(val.substr(0, c1));
+        a.hi = std::stod(val.substr(c1 + 1, c2 == std::string::npos ? std::string::npos : c2 - c1 - 1));
+        a.steps = c2 == std::string::npos ? 2 : std::stoi(val.substr(c2 + 1));
+        return a.steps >= 1;
+    }
+
+    options opt;
+};
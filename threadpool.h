@@ -0,0 +1,159 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+
+// Fixed-size worker pool used by world::pass_day to spread the agent phases
+// over cores. Work is handed out in chunks from a shared atomic cursor, so a
+// thread that finishes early simply takes the next chunk; the calling thread
+// works too. With one thread everything runs inline on the caller.
+class threadPool
+{
+public:
+    explicit threadPool(int threads = 1) { resize(threads); }
+    ~threadPool() { stop(); }
+
+    threadPool(const threadPool &) = delete;
+    threadPool &operator=(const threadPool &) = delete;
+
+    // Total threads including the caller; 0 means one per hardware core
+    void resize(int threads)
+    {
+        if (threads <= 0)
+            threads = (int)std::max(1u, std::thread::hardware_concurrency());
+        if (threads == threadCount)
+            return;
+        stop();
+        threadCount = threads;
+        stopping = false;
+        for (int i = 1; i < threadCount; i++)
+            workers.emplace_back([this, start = generation]
+                                 { workerLoop(start); });
+    }
+
+    int size() const { return threadCount; }
+
+    // ── PARALLEL FOR ──────────────────────────────────────────────────────
+    // Calls fn(begin, end) over [0, n) in chunks of `grain` indices.
+    // fn must only write state owned by the indices it is given, and must not
+    // call back into the pool.
+    template <class Fn>
+    void parallelFor(size_t n, size_t grain, Fn &&fn)
+    {
+        using Body = std::remove_reference_t<Fn>;
+        if (n == 0)
+            return;
+        grain = std::max<size_t>(1, grain);
+        if (threadCount <= 1 || n <= grain)
+        {
+            fn((size_t)0, n);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lk(mtx);
+            jobCtx = (void *)&fn;
+            jobCall = [](void *ctx, size_t b, size_t e)
+            { (*static_cast<Body *>(ctx))(b, e); };
+            jobN = n;
+            jobGrain = grain;
+            cursor.store(0);
+            busy = (int)workers.size();
+            generation++;
+        }
+        wake.notify_all();
+
+        runChunks();
+
+        std::unique_lock<std::mutex> lk(mtx);
+        done.wait(lk, [this]
+                  { return busy == 0; });
+    }
+
+    // ── DETERMINISTIC REDUCTION ───────────────────────────────────────────
+    // Sums blockFn(begin, end) over fixed blocks of `grain` indices. Block
+    // boundaries depend only on n and grain, and partials are combined in block
+    // order, so the result is bit-identical for any thread count.
+    template <class Fn>
+    double reduce(size_t n, size_t grain, double init, Fn &&blockFn)
+    {
+        grain = std::max<size_t>(1, grain);
+        size_t blocks = (n + grain - 1) / grain;
+        partials.assign(blocks, 0.0);
+        parallelFor(blocks, 1, [&](size_t b0, size_t b1)
+                    {
+            for (size_t b = b0; b < b1; b++)
+                partials[b] = blockFn(b * grain, std::min(n, (b + 1) * grain)); });
+        for (double p : partials)
+            init += p;
+        return init;
+    }
+
+private:
+    void runChunks()
+    {
+        for (;;)
+        {
+            size_t begin = cursor.fetch_add(jobGrain);
+            if (begin >= jobN)
+                return;
+            jobCall(jobCtx, begin, std::min(jobN, begin + jobGrain));
+        }
+    }
+
+    void workerLoop(size_t seen)
+    {
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lk(mtx);
+                wake.wait(lk, [&]
+                          { return stopping || generation != seen; });
+                if (stopping)
+                    return;
+                seen = generation;
+            }
+            runChunks();
+            {
+                std::lock_guard<std::mutex> lk(mtx);
+                if (--busy == 0)
+                    done.notify_one();
+            }
+        }
+    }
+
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lk(mtx);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto &t : workers)
+            t.join();
+        workers.clear();
+    }
+
+    int threadCount = 0;
+    std::vector<std::thread> workers;
+    std::mutex mtx;
+    std::condition_variable wake;
+    std::condition_variable done;
+    bool stopping = false;
+    size_t generation = 0;
+    int busy = 0;
+
+    // Current job (type-erased without allocating)
+    void *jobCtx = nullptr;
+    void (*jobCall)(void *, size_t, size_t) = nullptr;
+    size_t jobN = 0;
+    size_t jobGrain = 1;
+    std::atomic<size_t> cursor{0};
+
+    std::vector<double> partials; // reused by reduce()
+};
@@ -1,13 +1,22 @@
 #pragma once
 #include <vector>
 #include <string>
-#include <cstdlib>
+#include <algorithm>
+#include <cstdint>
 #include "style.h"
 #include "consumer.h"
 #include "laborer.h"
 #include "farmer.h"
 #include "firm.h"
 #include "market.h"
+#include "markettable.h"
+#include "orderbook.h"
+#include "equilibrium.h"
+#include "threadpool.h"
+#include "rng.h"
+#include "arena.h"
+#include "employment.h"
+#include "profiler.h"
 
 using namespace styledTerminal;
 using namespace Box;
@@ -33,24 +42,153 @@ public:
     };
 
     stats currentStats;
+    bool statsStale = false; // agents or firms added, removed, hired or fired since calculateStats
     int dayCount = 0;
 
-    std::vector<consumer> consumers;
-    std::vector<laborer> laborers;
-    std::vector<farmer> farmers;
+    // Slab storage: adding or removing an agent never moves the others (arena.h)
+    agentArena<consumer> consumers;
+    agentArena<laborer> laborers;
+    agentArena<farmer> farmers;
     std::vector<firm> firms;
     std::vector<market> markets;
 
-    consumer *selected_consumer = nullptr;
-    laborer *selected_laborer = nullptr;
-    farmer *selected_farmer = nullptr;
+    // Packed per-product demand lines for every agent (consumers, farmers, laborers)
+    demandStore demand;
+    // Packed per-crop supply lines, one row per farmer
+    supplyStore supply;
+
+    // Laborer id -> employer, and the unemployed pool firms hire from
+    employmentIndex employment;
+
+    // Packed per-market curves and prices for the batch clearing kernels
+    marketTable marketData;
+
+    // Indexed by product id (see productRegistry)
+    std::vector<int> marketIndex; // product id -> index into markets, -1 if none
+    std::vector<double> prices;   // product id -> current price, 0 if no market
+    // Product id -> units bought from other regions per day (negative = sold
+    // to them); set by the trade step between days, see regions.h
+    std::vector<double> imports;
+
+    // Clear by per-agent order books (see matchOrders) instead of letting
+    // agents consume by rule at the aggregate price; one book per market
+    bool orderMatching = false;
+    std::vector<orderBook> books;
+
+    // Clear all markets at once by the general-equilibrium solver on
+    // budget-constrained agent demand (see jointDemand) instead of one
+    // closed-form crossing of the summed lines per market
+    bool jointClearing = false;
+    equilibriumSolver solver;
+    std::vector<double> jointPrices; // product id -> trial price
+    std::vector<double> jointBlocks; // per AGENT_GRAIN block x market partial demand
+
+    // Wall time and item counts per pass_day phase (see profiler.h)
+    profile::phaseTimes phaseTimes;
+
+    // Every random draw is keyed by (seed, stream, day, agent); see rng.h
+    uint64_t seed = 42;
+
+    // Agent phases of pass_day run on this pool (1 thread = serial)
+    threadPool pool;
+    static constexpr size_t AGENT_GRAIN = 256; // agents per work chunk / reduction block
+
+    // Agent selections are arena handles: they survive adds, removals and
+    // compaction, and stop resolving once the agent is removed
+    agentArena<consumer>::handle selected_consumer;
+    agentArena<laborer>::handle selected_laborer;
+    agentArena<farmer>::handle selected_farmer;
     market *selected_market = nullptr;
     firm *selected_firm = nullptr;
 
-    world() {}
+    world()
+    {
+        catalogue(); // product ids must exist before any product is copied
+    }
+
+    // ── FORKING ───────────────────────────────────────────────────────────
+    // A copy is an independent branch of this world: agents, firms and markets
+    // are copied, the demand and supply store columns are shared copy-on-write
+    // (see cow.h) until either branch writes them. Each world keeps its own
+    // thread pool; a copy starts with the same thread count.
+    world(const world &o) : world()
+    {
+        pool.resize(o.threads());
+        *this = o;
+    }
+
+    world &operator=(const world &o)
+    {
+        if (this == &o)
+            return *this;
+        currentStats = o.currentStats;
+        statsStale = o.statsStale;
+        dayCount = o.dayCount;
+        consumers = o.consumers;
+        laborers = o.laborers;
+        farmers = o.farmers;
+        firms = o.firms;
+        markets = o.markets;
+        demand = o.demand;
+        supply = o.supply;
+        employment = o.employment;
+        marketIndex = o.marketIndex;
+        prices = o.prices;
+        imports = o.imports;
+        orderMatching = o.orderMatching;
+        jointClearing = o.jointClearing;
+        solver = o.solver;
+        phaseTimes = o.phaseTimes;
+        consumerSavings = o.consumerSavings;
+        farmerSavings = o.farmerSavings;
+        laborerSavings = o.laborerSavings;
+        seed = o.seed;
+
+        // Agents point at their world's stores; selections at its vectors.
+        // Arena copies keep their handle tables, so agent selections carry over.
+        for (auto &c : consumers)
+            c.store = &demand;
+        for (auto &l : laborers)
+            l.store = &demand;
+        for (auto &f : farmers)
+        {
+            f.store = &demand;
+            f.supplyLedger = &supply;
+        }
+        selected_consumer = o.selected_consumer;
+        selected_laborer = o.selected_laborer;
+        selected_farmer = o.selected_farmer;
+        selected_market = rebind(o.selected_market, o.markets, markets);
+        selected_firm = rebind(o.selected_firm, o.firms, firms);
+        return *this;
+    }
+
+    world fork() const { return world(*this); }
+
+    template <class T>
+    static T *rebind(const T *p, const std::vector<T> &from, std::vector<T> &to)
+    {
+        if (!p || from.empty() || p < from.data() || p >= from.data() + from.size())
+            return nullptr;
+        return &to[p - from.data()];
+    }
+
+    // 0 = one thread per hardware core
+    void setThreads(int n) { pool.resize(n); }
+    int threads() const { return pool.size(); }
 
+    // Today's draws for one agent (or one firm / market slot) at one call site
+    rng::generator random(rng::stream s, uint64_t key) const
+    {
+        return rng::generator(seed, s, (uint64_t)dayCount, key);
+    }
+
+    // The last day's stats, recomputed first if agents or jobs have changed
+    // since (CLI edits); otherwise no agent is walked
     stats getStats()
     {
+        if (statsStale)
+            calculateStats();
         currentStats.population = getPopulation();
         currentStats.firms = firms.size();
         return currentStats;
@@ -59,13 +197,8 @@ public:
     // ── INITIALIZATION ────────────────────────────────────────────────────
     void innitialize()
     {
-        srand(42); // reproducible but varied
-
         // ── MARKETS ───────────────────────────────────────────────────────
-        std::vector<product *> prods = {&rice, &cloth, &computer, &phone, &potato, &banana, &corn, &jute};
-        for (auto *p : prods)
-            markets.emplace_back(p);
-        selected_market = &markets[0];
+        openMarkets();
 
         // ── CONSUMERS (urban middle/working class) ─────────────────────────
         // ID block 11–19
@@ -105,7 +238,7 @@ public:
             f.weather = 0.70;
             f.addCrop(&rice, {0.25, 38.0}, 50.0, 2.0, 120.0);
             f.addCrop(&potato, {0.15, 22.0}, 80.0, 4.0, 200.0);
-            farmers.push_back(f);
+            farmers.add(f);
         }
         // Khalek — 3ac, rice only, lower tech
         {
@@ -115,7 +248,7 @@ public:
             f.tax = 0.05;
             f.weather = 0.70;
             f.addCrop(&rice, {0.28, 42.0}, 45.0, 2.5, 80.0);
-            farmers.push_back(f);
+            farmers.add(f);
         }
         // Sohan — 4ac, corn + jute, moderate tech
         {
@@ -126,7 +259,7 @@ public:
             f.weather = 0.65;
             f.addCrop(&corn, {0.20, 28.0}, 60.0, 3.0, 150.0);
             f.addCrop(&jute, {0.30, 35.0}, 40.0, 3.5, 90.0);
-            farmers.push_back(f);
+            farmers.add(f);
         }
         // Sadnan — 2ac, banana + potato, small scale
         {
@@ -137,7 +270,7 @@ public:
             f.weather = 0.75;
             f.addCrop(&banana, {0.12, 18.0}, 90.0, 5.0, 180.0);
             f.addCrop(&potato, {0.18, 24.0}, 70.0, 4.5, 140.0);
-            farmers.push_back(f);
+            farmers.add(f);
         }
         // Mahin — 8ac, large rice + corn operation, high tech
         {
@@ -148,7 +281,7 @@ public:
             f.weather = 0.60;
             f.addCrop(&rice, {0.22, 36.0}, 55.0, 1.8, 200.0);
             f.addCrop(&corn, {0.18, 26.0}, 65.0, 2.5, 180.0);
-            farmers.push_back(f);
+            farmers.add(f);
         }
         // Sohag — 1.5ac marginal farmer, potato only
         {
@@ -158,7 +291,7 @@ public:
             f.tax = 0.03;
             f.weather = 0.80;
             f.addCrop(&potato, {0.22, 28.0}, 55.0, 5.5, 80.0);
-            farmers.push_back(f);
+            farmers.add(f);
         }
 
         // ── FIRMS ─────────────────────────────────────────────────────────
@@ -166,74 +299,76 @@ public:
         {
             // Rahim's garment firm — cloth, labour-intensive α=0.6
             firm f(11, 600000, cobbDouglas(0.6, 0.4, 1.2));
-            f.products.push_back(cloth);
+            f.productIds.push_back(cloth.id);
             f.wage = 430;
             f.fixed_overhead = 3500;
-            f.workers.push_back(laborers[0]); // Kowshik
-            f.workers.push_back(laborers[1]); // Cauchy
-            f.capitals.emplace_back(800, 1.5);
+            f.workers.push_back(laborers[0].id); // Kowshik
+            f.workers.push_back(laborers[1].id); // Cauchy
+            f.addCapital(800, 1.5);
             f.calculateCosts();
             firms.push_back(f);
         }
         {
             // Rohan's garment firm — cloth, balanced α=0.5
             firm f(13, 350000, cobbDouglas(0.5, 0.5, 1.5));
-            f.products.push_back(cloth);
+            f.productIds.push_back(cloth.id);
             f.wage = 410;
             f.fixed_overhead = 2500;
-            f.workers.push_back(laborers[3]); // Shad
-            f.capitals.emplace_back(600, 1.2);
+            f.workers.push_back(laborers[3].id); // Shad
+            f.addCapital(600, 1.2);
             f.calculateCosts();
             firms.push_back(f);
         }
         {
             // Priom's electronics firm — computer, CES, high capital
             firm f(12, 1800000, ces(0.5));
-            f.products.push_back(computer);
+            f.productIds.push_back(computer.id);
             f.wage = 750;
             f.fixed_overhead = 9000;
-            f.workers.push_back(laborers[2]); // Mahin
-            f.capitals.emplace_back(2000, 2.0);
-            f.capitals.emplace_back(2000, 2.0);
+            f.workers.push_back(laborers[2].id); // Mahin
+            f.addCapital(2000, 2.0);
+            f.addCapital(2000, 2.0);
             f.calculateCosts();
             firms.push_back(f);
         }
         {
             // Atef's textile firm — cloth, more workers
             firm f(15, 950000, cobbDouglas(0.55, 0.45, 1.3));
-            f.products.push_back(cloth);
+            f.productIds.push_back(cloth.id);
             f.wage = 450;
             f.fixed_overhead = 4200;
-            f.workers.push_back(laborers[4]); // Mahir
-            f.workers.push_back(laborers[5]); // Labib
-            f.capitals.emplace_back(900, 1.6);
+            f.workers.push_back(laborers[4].id); // Mahir
+            f.workers.push_back(laborers[5].id); // Labib
+            f.addCapital(900, 1.6);
             f.calculateCosts();
             firms.push_back(f);
         }
         {
             // Somio's small food processing firm — rice/potato, CES
             firm f(19, 420000, cobbDouglas(0.65, 0.35, 1.1));
-            f.products.push_back(rice);
+            f.productIds.push_back(rice.id);
             f.wage = 380;
             f.fixed_overhead = 1800;
-            f.workers.push_back(laborers[6]); // Jubair
-            f.capitals.emplace_back(500, 1.0);
+            f.workers.push_back(laborers[6].id); // Jubair
+            f.addCapital(500, 1.0);
             f.calculateCosts();
             firms.push_back(f);
         }
         {
             // Nahid's phone assembly firm — phone, high-capital CES
             firm f(17, 1200000, ces(0.45));
-            f.products.push_back(phone);
+            f.productIds.push_back(phone.id);
             f.wage = 680;
             f.fixed_overhead = 5500;
-            f.workers.push_back(laborers[7]); // Nabil
-            f.capitals.emplace_back(1800, 1.8);
-            f.capitals.emplace_back(1800, 1.8);
+            f.workers.push_back(laborers[7].id); // Nabil
+            f.addCapital(1800, 1.8);
+            f.addCapital(1800, 1.8);
             f.calculateCosts();
             firms.push_back(f);
         }
 
+        rebuildEmployment();
+
         // ── AGENT CURVES ──────────────────────────────────────────────────
         initializeDemandCurves();
         initializeSupplyCurves();
@@ -242,13 +377,28 @@ public:
         updateAllMarkets();
 
         // ── DEFAULT SELECTIONS ────────────────────────────────────────────
-        selected_consumer = &consumers[0];
-        selected_farmer = &farmers[0];
-        selected_laborer = &laborers[0];
+        selected_consumer = consumers.first();
+        selected_farmer = farmers.first();
+        selected_laborer = laborers.first();
         selected_market = &markets[0];
         selected_firm = &firms[0];
     }
 
+    // One market (and demand column) per traded good
+    void openMarkets()
+    {
+        std::vector<product *> prods = {&rice, &cloth, &computer, &phone, &potato, &banana, &corn, &jute};
+        marketIndex.assign(catalogue().size(), -1);
+        prices.assign(catalogue().size(), 0.0);
+        for (auto *p : prods)
+        {
+            marketIndex[p->id] = (int)markets.size();
+            markets.emplace_back(p);
+            demand.addColumn(p);
+        }
+        selected_market = &markets[0];
+    }
+
     // ── ADD HELPERS ───────────────────────────────────────────────────────
     void addConsumerFull(int id, const std::string &name, int age,
                          double savings, double income)
@@ -256,7 +406,8 @@ public:
         consumer c(id, name, age);
         c.savings = savings;
         c.incomePerDay = income;
-        consumers.push_back(c);
+        consumers.add(c);
+        statsStale = true;
     }
 
     void addLaborerFull(int id, const std::string &name, int age,
@@ -266,31 +417,36 @@ public:
         laborer l(id, name, age, skill, minwage);
         l.savings = savings;
         l.incomePerDay = income;
-        laborers.push_back(l);
+        laborers.add(l);
+        employment.add(l);
+        statsStale = true;
     }
 
     void addConsumer(std::string name, int age)
     {
         int id = 100 + (int)consumers.size();
-        consumer c(id, name, age);
-        consumers.push_back(c);
+        consumers.emplace(id, name, age);
+        statsStale = true;
     }
 
     void addFarmer(std::string name, int age, double land, double techLevel)
     {
         int id = 120 + (int)farmers.size();
-        farmers.emplace_back(id, name, age, land, techLevel);
+        enrollSupply(farmers.emplace(id, name, age, land, techLevel));
+        statsStale = true;
     }
 
     void addlaborer(std::string name, int age, double skillLevel, double minWage)
     {
         int id = 140 + (int)laborers.size();
-        laborers.emplace_back(id, name, age, skillLevel, minWage);
+        employment.add(laborers.emplace(id, name, age, skillLevel, minWage));
+        statsStale = true;
     }
 
     void addFirm(int id, double cash, cobbDouglas cd)
     {
         firms.emplace_back(id, cash, cd);
+        statsStale = true;
     }
 
     int getPopulation() const
@@ -298,170 +454,598 @@ public:
         return (int)(consumers.size() + laborers.size() + farmers.size());
     }
 
-    consumer *GetSelectedConsumer() { return selected_consumer; }
-    laborer *GetSelectedLaborer() { return selected_laborer; }
-    farmer *GetSelectedFarmer() { return selected_farmer; }
+    consumer *GetSelectedConsumer() { return consumers.get(selected_consumer); }
+    laborer *GetSelectedLaborer() { return laborers.get(selected_laborer); }
+    farmer *GetSelectedFarmer() { return farmers.get(selected_farmer); }
+    const consumer *GetSelectedConsumer() const { return consumers.get(selected_consumer); }
+    const laborer *GetSelectedLaborer() const { return laborers.get(selected_laborer); }
+    const farmer *GetSelectedFarmer() const { return farmers.get(selected_farmer); }
     market *GetSelectedMarket() { return selected_market; }
+
+    market *marketFor(int productId)
+    {
+        if (productId < 0 || productId >= (int)marketIndex.size() || marketIndex[productId] < 0)
+            return nullptr;
+        return &markets[marketIndex[productId]];
+    }
     firm *GetSelectedFirm()
     {
-        if (!selected_consumer)
+        const consumer *c = GetSelectedConsumer();
+        if (!c)
             return nullptr;
         for (auto &f : firms)
-            if (f.ownerId == selected_consumer->id)
+            if (f.ownerId == c->id)
                 return &f;
         return nullptr;
     }
 
+    // Give an agent its row in the demand store (no-op if it already has one)
+    void enroll(consumer &ag)
+    {
+        if (ag.store == &demand && ag.row >= 0)
+            return;
+        ag.store = &demand;
+        ag.row = demand.addRow();
+    }
+
+    // Give a farmer its row in the supply store and publish its current curves
+    void enrollSupply(farmer &f)
+    {
+        if (f.supplyLedger != &supply || f.supplyRow < 0)
+        {
+            f.supplyLedger = &supply;
+            f.supplyRow = supply.addRow();
+        }
+        for (auto &crop : f.crops)
+            supply.addColumn(&crop);
+        f.publishSupply();
+    }
+
+    // Copy an agent out of another world (a region shard, see regions.h) into
+    // `into`, carrying its demand row over to this world's store
+    template <class Agent>
+    Agent &adopt(agentArena<Agent> &into, const Agent &a, const demandStore &from)
+    {
+        Agent &b = into.add(a);
+        b.store = nullptr;
+        b.row = -1;
+        enroll(b);
+        for (const needRef &n : b.needs)
+        {
+            product *need = catalogue().get(n.id);
+            int col = demand.addColumn(need);
+            int src = from.column(need);
+            if (col < 0 || src < 0 || a.row < 0)
+                continue;
+            demand.setLine(col, b.row, from.line(src, a.row));
+            demand.consumed(col, b.row) = from.consumed(src, a.row);
+            demand.substitution(col, b.row) = from.substitution(src, a.row);
+        }
+        return b;
+    }
+
+    // ── EMPLOYMENT ────────────────────────────────────────────────────────
+    // Re-derive the employment index from every firm's worker ids
+    void rebuildEmployment()
+    {
+        employment.clear();
+        for (auto &l : laborers)
+            employment.add(l);
+        for (size_t i = 0; i < firms.size(); i++)
+            for (int id : firms[i].workers)
+                employment.setEmployer(id, (int)i);
+    }
+
+    int firmIndex(const firm *f) const
+    {
+        if (!f || firms.empty() || f < &firms.front() || f > &firms.back())
+            return -1;
+        return (int)(f - &firms.front());
+    }
+
+    laborer *findLaborer(int id)
+    {
+        for (auto &l : laborers)
+            if (l.id == id)
+                return &l;
+        return nullptr;
+    }
+
+    // False if the laborer is unknown or already works somewhere
+    bool hire(firm &fi, int laborerId)
+    {
+        int idx = firmIndex(&fi);
+        if (idx < 0 || !employment.tracks(laborerId) || employment.employerOf(laborerId) >= 0)
+            return false;
+        fi.workers.push_back(laborerId);
+        employment.setEmployer(laborerId, idx);
+        fi.calculateCosts();
+        statsStale = true;
+        return true;
+    }
+
+    bool fire(firm &fi, int laborerId)
+    {
+        auto it = std::find(fi.workers.begin(), fi.workers.end(), laborerId);
+        if (it == fi.workers.end())
+            return false;
+        fi.workers.erase(it);
+        employment.setEmployer(laborerId, -1);
+        fi.calculateCosts();
+        statsStale = true;
+        return true;
+    }
+
+    // Drop a laborer from its employer and the index before it is removed
+    void retireLaborer(const laborer &l)
+    {
+        int idx = employment.employerOf(l.id);
+        if (idx >= 0 && idx < (int)firms.size())
+        {
+            auto &ws = firms[idx].workers;
+            ws.erase(std::remove(ws.begin(), ws.end(), l.id), ws.end());
+            firms[idx].calculateCosts();
+        }
+        employment.remove(l.id);
+    }
+
+    // ── AGENT LIFECYCLE ───────────────────────────────────────────────────
+    // Removing an agent releases its store rows and frees its slot for the
+    // next add; no other agent moves and every other pointer stays valid.
+    // A selection pointing at the removed agent is cleared.
+    // Agents are named by arena handle, so removal is O(1).
+    bool removeConsumer(agentArena<consumer>::handle h) { return markStale(removeAgent(consumers, h, selected_consumer)); }
+    bool removeFarmer(agentArena<farmer>::handle h) { return markStale(removeAgent(farmers, h, selected_farmer)); }
+    bool removeLaborer(agentArena<laborer>::handle h)
+    {
+        laborer *l = laborers.get(h);
+        if (!l)
+            return false;
+        retireLaborer(*l);
+        statsStale = true;
+        return removeAgent(laborers, h, selected_laborer);
+    }
+
+    // Pass-through that flags the stats when `changed`
+    bool markStale(bool changed)
+    {
+        statsStale |= changed;
+        return changed;
+    }
+
+    // Compact any arena that removals have left fragmented (every one with
+    // holes if `force`). Agents move; selections are handles and follow
+    // them. The blank demand cells removed agents left behind go
+    // in the same pass.
+    void compactAgents(bool force = false)
+    {
+        bool moved = compactArena(consumers, force);
+        moved |= compactArena(laborers, force);
+        moved |= compactArena(farmers, force);
+        if (moved)
+            demand.prune();
+    }
+
+    template <class Agent>
+    static bool removeAgent(agentArena<Agent> &agents, typename agentArena<Agent>::handle h,
+                            typename agentArena<Agent>::handle &selected)
+    {
+        Agent *a = agents.get(h);
+        if (!a)
+            return false;
+        a->die();
+        if (selected == h)
+            selected = {};
+        return agents.erase(h);
+    }
+
+    template <class Agent>
+    static bool compactArena(agentArena<Agent> &agents, bool force)
+    {
+        if (force ? agents.holes() == 0 : !agents.fragmented())
+            return false;
+        agents.compact();
+        return true;
+    }
+
     void setDemandCurve(consumer &ag, product *prod, double slope, double intercept)
     {
         if (!prod)
             return;
-        ag.needs.push_back(*prod);
-        ag.dd[prod] = {std::max(0.05, slope), std::max(1.0, intercept)};
-        ag.consumed[prod] = 0.0;
-    }
-
-    double baseCropCost(product *crop) const
-    {
-        if (!crop)
-            return 30.0;
-        if (crop->name == rice.name)
-            return 37.0;
-        if (crop->name == potato.name)
-            return 22.0;
-        if (crop->name == banana.name)
-            return 18.0;
-        if (crop->name == corn.name)
-            return 27.0;
-        if (crop->name == jute.name)
-            return 34.0;
-        return 30.0;
-    }
-
-    double baseCropSlope(product *crop) const
-    {
-        if (!crop)
-            return 0.20;
-        if (crop->name == rice.name)
-            return 0.22;
-        if (crop->name == potato.name)
-            return 0.16;
-        if (crop->name == banana.name)
-            return 0.14;
-        if (crop->name == corn.name)
-            return 0.19;
-        if (crop->name == jute.name)
-            return 0.28;
-        return 0.20;
+        enroll(ag);
+        int col = demand.addColumn(prod);
+        ag.needs.push_back({prod->id});
+        demand.setLine(col, ag.row, {std::max(0.05, slope), std::max(1.0, intercept)});
+        demand.consumed(col, ag.row) = 0.0;
+    }
+
+    // Crop supply calibration from the product table (see product.h)
+    double baseCropCost(const product *crop) const
+    {
+        return specOf(crop ? crop->id : -1).baseCost;
+    }
+
+    double baseCropSlope(const product *crop) const
+    {
+        return specOf(crop ? crop->id : -1).baseSlope;
     }
 
     // ── DEMAND CURVE INITIALIZATION ───────────────────────────────────────
+    // Rows are handed out first (consumers, farmers, laborers, in slot
+    // order) and every row gets a placeholder cell in each basket column,
+    // then every agent's curves are written on the pool: each agent writes
+    // only its own cells, so the result does not depend on the schedule.
+    // Placeholders of goods an agent does not buy are pruned afterwards.
     void initializeDemandCurves()
     {
-        // Collect all agent pointers
-        std::vector<consumer *> all;
-        for (auto &c : consumers)
-            all.push_back(&c);
-        for (auto &f : farmers)
-            all.push_back(&f);
-        for (auto &l : laborers)
-            all.push_back(&l);
+        enrollAll();
+        for (auto *p : {&rice, &cloth, &potato, &banana, &corn, &jute, &phone, &computer})
+            demand.reserveColumn(demand.addColumn(p));
+        if (threads() > 1)
+            demand.detach(); // no column may swap its buffer mid-pass
+
+        initializeDemandCurves(consumers);
+        initializeDemandCurves(farmers);
+        initializeDemandCurves(laborers);
+        demand.prune();
+    }
 
-        for (auto *ag : all)
+    // A demand row for every agent without one, in one resize of the store
+    void enrollAll()
+    {
+        int missing = 0;
+        auto count = [&](auto &agents)
         {
-            double inc = ag->incomePerDay;
-            double wealth = ag->savings + inc * 30;
-            double tasteShift = ((ag->id % 5) - 2) * 1.2;
-
-            ag->needs.clear();
-            ag->dd.clear();
-            ag->consumed.clear();
-            ag->substitutionRatios.clear();
+            for (auto &a : agents)
+                missing += a.store != &demand || a.row < 0;
+        };
+        count(consumers);
+        count(farmers);
+        count(laborers);
+        if (missing == 0)
+            return;
 
-            // Calibrated around a Bangladesh-like consumer basket.
-            // Curves are chosen so aggregated prices settle in a coherent range.
+        int next = demand.addRows(missing);
+        auto assign = [&](auto &agents)
+        {
+            for (auto &a : agents)
+                if (a.store != &demand || a.row < 0)
+                {
+                    a.store = &demand;
+                    a.row = next++;
+                }
+        };
+        assign(consumers);
+        assign(farmers);
+        assign(laborers);
+    }
 
-            // Staples / essentials
-            setDemandCurve(*ag, &rice, 2.2, 95.0 + inc * 0.050 + tasteShift);
-            setDemandCurve(*ag, &cloth, 2.0, 78.0 + inc * 0.060 + tasteShift);
-            setDemandCurve(*ag, &potato, 2.5,
-                           std::max(26.0, 44.0 + inc * 0.010 - wealth * 0.00008 + tasteShift));
-            setDemandCurve(*ag, &banana, 2.0, 37.0 + inc * 0.030 + tasteShift);
-            setDemandCurve(*ag, &corn, 2.2, 46.0 + inc * 0.020 + tasteShift);
+    template <class Agent>
+    void initializeDemandCurves(agentArena<Agent> &agents)
+    {
+        pool.parallelFor(agents.slots(), AGENT_GRAIN, [&](size_t begin, size_t end)
+                         {
+            for (size_t i = begin; i < end; i++)
+                if (agents.alive(i))
+                    initializeDemandCurve(agents[i]); });
+    }
 
-            // Jute goods are mostly used by lower/middle income households.
-            if (wealth < 90000.0)
-            {
-                setDemandCurve(*ag, &jute, 2.8, 50.0 + inc * 0.015 + tasteShift);
-            }
+    // One agent's starting curves; its row and its basket cells must exist
+    void initializeDemandCurve(consumer &ag)
+    {
+        double inc = ag.incomePerDay;
+        double wealth = ag.savings + inc * 30;
+        double tasteShift = ((ag.id % 5) - 2) * 1.2;
+
+        ag.needs.clear();
+        demand.clearRow(ag.row);
+
+        // Calibrated around a Bangladesh-like consumer basket.
+        // Curves are chosen so aggregated prices settle in a coherent range.
+
+        // Staples / essentials
+        setDemandCurve(ag, &rice, 2.2, 95.0 + inc * 0.050 + tasteShift);
+        setDemandCurve(ag, &cloth, 2.0, 78.0 + inc * 0.060 + tasteShift);
+        setDemandCurve(ag, &potato, 2.5,
+                       std::max(26.0, 44.0 + inc * 0.010 - wealth * 0.00008 + tasteShift));
+        setDemandCurve(ag, &banana, 2.0, 37.0 + inc * 0.030 + tasteShift);
+        setDemandCurve(ag, &corn, 2.2, 46.0 + inc * 0.020 + tasteShift);
+
+        // Jute goods are mostly used by lower/middle income households.
+        if (wealth < 90000.0)
+        {
+            setDemandCurve(ag, &jute, 2.8, 50.0 + inc * 0.015 + tasteShift);
+        }
 
-            // Durables
-            if (wealth > 22000.0)
-            {
-                setDemandCurve(*ag, &phone, 0.25,
-                               68.0 + inc * 0.010 + wealth * 0.00045 + tasteShift);
-            }
-            if (wealth > 55000.0)
-            {
-                setDemandCurve(*ag, &computer, 0.18,
-                               105.0 + inc * 0.020 + wealth * 0.00090 + tasteShift);
-            }
+        // Durables
+        if (wealth > 22000.0)
+        {
+            setDemandCurve(ag, &phone, 0.25,
+                           68.0 + inc * 0.010 + wealth * 0.00045 + tasteShift);
+        }
+        if (wealth > 55000.0)
+        {
+            setDemandCurve(ag, &computer, 0.18,
+                           105.0 + inc * 0.020 + wealth * 0.00090 + tasteShift);
         }
     }
 
     // ── SUPPLY CURVE INITIALIZATION (FARMERS) ─────────────────────────────
+    // Curves are computed on the pool (each farmer writes only its own ss),
+    // then published to the supply store in slot order
     void initializeSupplyCurves()
     {
+        pool.parallelFor(farmers.slots(), AGENT_GRAIN, [&](size_t begin, size_t end)
+                         {
+            for (size_t i = begin; i < end; i++)
+                if (farmers.alive(i))
+                    initializeSupplyCurve(farmers[i]); });
         for (auto &f : farmers)
+            enrollSupply(f);
+    }
+
+    void initializeSupplyCurve(farmer &f)
+    {
+        for (size_t i = 0; i < f.crops.size(); i++)
         {
-            for (auto &[crop, line] : f.ss)
-            {
-                if (!crop)
-                    continue;
+            product *crop = &f.crops[i];
+            supplyLine &line = f.ss[i];
+
+            double baseCost = baseCropCost(crop);
+            double baseSlope = baseCropSlope(crop);
+
+            double smallFarmPenalty = f.land < 3.0 ? (3.0 - f.land) * 2.5 : 0.0;
+            double techDiscount = f.techLevel * 8.0;
+            double weatherPenalty = std::max(0.0, 0.65 - f.weather) * 10.0;
+            double taxPenalty = f.tax * 30.0;
+
+            line.c = std::max(8.0, baseCost - techDiscount + smallFarmPenalty +
+                                       weatherPenalty + taxPenalty);
+            line.m = std::max(0.08, baseSlope +
+                                        (0.18 / std::max(1.0, f.land)) +
+                                        (0.06 * (1.0 - f.techLevel)));
+        }
+    }
 
-                double baseCost = baseCropCost(crop);
-                double baseSlope = baseCropSlope(crop);
+    // ── MARKET UPDATE ─────────────────────────────────────────────────────
+    // Aggregate every market's curves, then clear them all in one batch pass
+    void updateAllMarkets()
+    {
+        size_t n = markets.size();
+        marketData.resize(n);
+        for (size_t i = 0; i < n; i++)
+        {
+            market &m = markets[i];
+            m.calculateAggregateDemand(demand);
+            m.calculateAggregateSupply(supply, firms); // firms contribute supply
+            marketData.demandM[i] = m.aggregateDemand.m;
+            marketData.demandC[i] = m.aggregateDemand.c;
+            marketData.supplyM[i] = m.aggregateSupply.m;
+            marketData.supplyC[i] = m.aggregateSupply.c;
+            double imported = importsOf(m.prod->id);
+            if (imported != 0.0) // traded units shift local supply along the quantity axis
+                marketData.supplyC[i] -= m.aggregateSupply.m * imported;
+            marketData.price[i] = m.price;
+        }
 
-                double smallFarmPenalty = f.land < 3.0 ? (3.0 - f.land) * 2.5 : 0.0;
-                double techDiscount = f.techLevel * 8.0;
-                double weatherPenalty = std::max(0.0, 0.65 - f.weather) * 10.0;
-                double taxPenalty = f.tax * 30.0;
+        // Only take the equilibrium price when BOTH curves are non-trivial.
+        // If there's no supply curve, let Walrasian tâtonnement (adjustPrices) drive
+        // the price instead of resetting it to the demand x-intercept each tick.
+        if (jointClearing)
+            solver.solve(marketData, [this](const std::vector<double> &p, std::vector<double> &q)
+                         { jointDemand(p, q); });
+        else
+            marketData.solve();
 
-                line.c = std::max(8.0, baseCost - techDiscount + smallFarmPenalty +
-                                           weatherPenalty + taxPenalty);
-                line.m = std::max(0.08, baseSlope +
-                                            (0.18 / std::max(1.0, f.land)) +
-                                            (0.06 * (1.0 - f.techLevel)));
-            }
+        for (size_t i = 0; i < n; i++)
+        {
+            market &m = markets[i];
+            m.price = marketData.price[i];
+            m.excessDemand = marketData.excessDemand[i];
+            m.cleared = {marketData.eqPrice[i], marketData.eqQuantity[i]};
+            m.quantityTraded = m.cleared.quantity;
+            m.revenue = m.price * m.cleared.quantity;
+            // History is recorded once a day, after tâtonnement (adjustPrices)
         }
     }
 
-    // ── MARKET UPDATE ─────────────────────────────────────────────────────
-    void updateAllMarkets()
+    double importsOf(int productId) const
     {
-        for (auto &m : markets)
+        return productId >= 0 && productId < (int)imports.size() ? imports[productId] : 0.0;
+    }
+
+    // Walrasian tâtonnement for every market in one batch pass; markets the
+    // joint solver has cleared already sit at their equilibrium and keep it
+    void adjustPrices()
+    {
+        size_t n = markets.size();
+        marketData.resize(n);
+        for (size_t i = 0; i < n; i++)
         {
-            m.calculateAggregateDemand(consumers, farmers, laborers);
-            m.calculateAggregateSupply(farmers, firms); // firms contribute supply
+            marketData.price[i] = markets[i].price;
+            marketData.speed[i] = jointClearing && solver.solved(i) ? 0.0 : markets[i].priceAdjustmentSpeed;
+            marketData.excessDemand[i] = markets[i].excessDemand;
+        }
+        marketData.adjust();
+        for (size_t i = 0; i < n; i++)
+        {
+            markets[i].price = marketData.price[i];
+            markets[i].priceHistory.push_back(markets[i].price);
+        }
+    }
 
-            auto eq = m.findEquilibrium();
+    // ── JOINT DEMAND ──────────────────────────────────────────────────────
+    // Every market's demand with all prices set at once (slot-indexed), for
+    // the general-equilibrium solver. Each agent buys along its own lines,
+    // each dropping out above its reservation price, and when that basket
+    // costs more than its daily budget (a thirtieth of the wealth behind
+    // muPerTk: savings + 30 days of income) every quantity is scaled down by
+    // the same factor, so a dearer good cuts demand in the other markets.
+    // Sums are kept per AGENT_GRAIN block and added in block order, so the
+    // result does not depend on the thread count.
+    void jointDemand(const std::vector<double> &slotPrices, std::vector<double> &quantity)
+    {
+        size_t n = markets.size();
+        jointPrices.assign(marketIndex.size(), 0.0);
+        for (size_t i = 0; i < n; i++)
+            jointPrices[markets[i].prod->id] = slotPrices[i];
+
+        size_t cb = blocksOf(consumers), fb = blocksOf(farmers), lb = blocksOf(laborers);
+        jointBlocks.assign((cb + fb + lb) * n, 0.0);
+        addJointDemand(consumers, 0);
+        addJointDemand(farmers, cb);
+        addJointDemand(laborers, cb + fb);
+        for (size_t b = 0; b < cb + fb + lb; b++)
+            for (size_t i = 0; i < n; i++)
+                quantity[i] += jointBlocks[b * n + i];
+    }
 
-            // Only update price from equilibrium when BOTH curves are non-trivial.
-            // If there's no supply curve, let Walrasian tâtonnement (adjustPrice) drive
-            // the price instead of resetting it to the demand x-intercept each tick.
-            bool hasDemand = m.aggregateDemand.m > 0.0001;
-            bool hasSupply = m.aggregateSupply.m > 0.0001;
+    template <class Agent>
+    size_t blocksOf(const agentArena<Agent> &agents) const
+    {
+        return (agents.slots() + AGENT_GRAIN - 1) / AGENT_GRAIN;
+    }
 
-            if (hasDemand && hasSupply && eq.price > 0.1)
-                m.price = eq.price;
-            else if (m.price < 0.1)
-                m.price = 0.1;
+    template <class Agent>
+    void addJointDemand(agentArena<Agent> &agents, size_t firstBlock)
+    {
+        size_t n = markets.size();
+        pool.parallelFor(agents.slots(), AGENT_GRAIN, [&](size_t begin, size_t end)
+                         {
+            for (size_t i = begin; i < end; i++)
+            {
+                if (!agents.alive(i))
+                    continue;
+                consumer &a = agents[i];
+                double spend = 0.0;
+                for (needRef &need : a.needs)
+                    spend += jointPrice(need) * jointUnits(a, need);
+                double budget = std::max(0.0, a.savings / 30.0 + a.incomePerDay);
+                double scale = spend > budget ? budget / spend : 1.0;
+
+                double *sum = &jointBlocks[(firstBlock + i / AGENT_GRAIN) * n];
+                for (needRef &need : a.needs)
+                {
+                    double units = jointUnits(a, need);
+                    if (units > 0.0)
+                        sum[marketIndex[need.id]] += scale * units;
+                }
+            } });
+    }
 
-            // Record history
-            m.priceHistory.push_back(m.price);
-            if (m.priceHistory.size() > 30)
-                m.priceHistory.erase(m.priceHistory.begin());
+    double jointPrice(const needRef &need) const
+    {
+        return need.id < (int)jointPrices.size() ? jointPrices[need.id] : 0.0;
+    }
+
+    // Units one agent's line buys at the trial price (0 without a market)
+    double jointUnits(consumer &a, needRef &need) const
+    {
+        double p = jointPrice(need);
+        int at = p > 0.0 ? demand.locate(need.id, a.row, need.at) : -1;
+        if (at < 0)
+            return 0.0;
+        const demandCell &cell = demand.participants(need.id)[at];
+        if (cell.m <= 0.000001 || cell.c <= p)
+            return 0.0;
+        return (cell.c - p) / cell.m;
+    }
+
+    // ── ORDER MATCHING ────────────────────────────────────────────────────
+    // Every market's book is rebuilt from the store rows and firm lines and
+    // crossed (see orderbook.h); markets run side by side on the pool. Each
+    // buyer's fill lands in its demand-store row, sellers are paid here:
+    // farmers into savings, firms into cash, so money only changes hands.
+    // A market whose book does not cross keeps the curve clearing's result.
+    void matchOrders()
+    {
+        size_t n = markets.size();
+        books.resize(n);
+        if (threads() > 1)
+            demand.detach(); // fill columns are written concurrently
+        pool.parallelFor(n, 1, [&](size_t begin, size_t end)
+                         {
+            for (size_t i = begin; i < end; i++)
+                matchMarket(i); });
+
+        // A farmer may sell in several markets, so sellers are paid serially
+        for (auto &f : farmers)
+            for (auto &crop : f.crops)
+            {
+                int mi = crop.id < (int)marketIndex.size() ? marketIndex[crop.id] : -1;
+                if (mi < 0 || f.supplyRow < 0 || !books[mi].traded)
+                    continue;
+                const orderBook &book = books[mi];
+                if (f.supplyRow < (int)book.sold.size())
+                    f.savings += book.price * book.sold[f.supplyRow];
+            }
+        for (auto &book : books)
+            if (book.traded)
+                for (size_t j = 0; j < book.firmSold.size() && j < firms.size(); j++)
+                    firms[j].cash += book.price * book.firmSold[j];
+
+        for (auto &m : markets)
+            prices[m.prod->id] = m.price;
+    }
+
+    // After the evening re-clear: the day's traded price and volume stand
+    void publishTrades()
+    {
+        for (size_t i = 0; i < markets.size() && i < books.size(); i++)
+            if (books[i].traded)
+            {
+                market &m = markets[i];
+                m.cleared = {books[i].price, books[i].volume};
+                m.quantityTraded = books[i].volume;
+                m.revenue = books[i].price * books[i].volume;
+            }
+    }
+
+    // Build and cross market i's book; writes only that market, its book and
+    // its product's fill column
+    void matchMarket(size_t i)
+    {
+        market &m = markets[i];
+        orderBook &book = books[i];
+        int col = m.prod->id;
+        book.clear();
+
+        if (col < demand.columns())
+        {
+            const std::vector<demandCell> &bidders = demand.participants(col);
+            for (size_t k = 0; k < bidders.size(); k++)
+                book.bid({bidders[k].m, bidders[k].c}, (int)k);
+        }
+        if (col < supply.columns())
+        {
+            const double *sm = supply.slopeData(col), *sc = supply.interceptData(col);
+            for (int r = 0; r < supply.rows(); r++)
+                book.ask({sm[r], sc[r]}, r);
+        }
+        for (size_t j = 0; j < firms.size(); j++)
+        {
+            supplyLine line;
+            if (m.firmSupply(firms[j], line))
+                book.ask(line, -1 - (int)j);
         }
+
+        book.sold.assign(supply.rows(), 0.0);
+        book.firmSold.assign(firms.size(), 0.0);
+        if (col >= demand.columns())
+            return;
+        demand.clearFills(col);
+        if (!book.match(importsOf(col)))
+            return;
+
+        for (auto &o : book.bids)
+            demand.setFill(col, o.owner, book.bidFill(o));
+        for (auto &o : book.asks)
+            (o.owner >= 0 ? book.sold[o.owner] : book.firmSold[-1 - o.owner]) = book.askFill(o);
+
+        m.price = book.price;
+        m.cleared = {book.price, book.volume};
+        m.quantityTraded = book.volume;
+        m.revenue = book.price * book.volume;
     }
 
     // ── PASS DAY ──────────────────────────────────────────────────────────
@@ -471,84 +1055,217 @@ public:
         double gdpPerCapita = currentStats.gdp / std::max(1, getPopulation());
 
         // 1. Markets re-equilibrate FIRST so entities see current prices
-        updateAllMarkets();
-
-        // Build price map
-        std::map<std::string, double> prices;
-        for (auto &m : markets)
-            prices[m.prod->name] = m.price;
-
-        // 2. entities respond to prices
-        for (auto &c : consumers)
         {
-            for (auto &need : c.needs)
-            {
-                auto it = prices.find(need.name);
-                if (it != prices.end())
-                    c.updateDemandForPriceChange(c.findKey(need.name), it->second);
-            }
-            c.pass_day(gdpPerCapita, prices);
+            PROFILE_PHASE(phaseTimes, profile::MarketsBefore, markets.size());
+            updateAllMarkets();
+
+            // Price vector indexed by product id (0 = no market)
+            for (auto &m : markets)
+                prices[m.prod->id] = m.price;
         }
-        for (auto &f : farmers)
+
+        //    With order matching, cross every market's book at those curves:
+        //    each agent's fill is what it buys and consumes today
+        demand.setMatching(orderMatching);
+        if (orderMatching)
         {
-            for (auto &need : f.needs)
-            {
-                auto it = prices.find(need.name);
-                if (it != prices.end())
-                    f.updateDemandForPriceChange(f.findKey(need.name), it->second);
-            }
-            f.pass_day(gdpPerCapita, prices);
+            PROFILE_PHASE(phaseTimes, profile::Matching, markets.size());
+            matchOrders();
         }
-        for (auto &l : laborers)
+
+        // 2. entities respond to prices
+        //    Each agent reads the shared price vector and writes only its own
+        //    fields and its own demand-store row, so the phases run in parallel.
         {
-            for (auto &need : l.needs)
-            {
-                auto it = prices.find(need.name);
-                if (it != prices.end())
-                    l.updateDemandForPriceChange(l.findKey(need.name), it->second);
-            }
-            l.pass_day(gdpPerCapita, prices);
+            PROFILE_PHASE(phaseTimes, profile::Agents, getPopulation());
+            updateAgents(consumers, gdpPerCapita);
+            updateAgents(farmers, gdpPerCapita, [this](farmer &f)
+                         { f.drawWeather(random(rng::stream::Weather, f.id)); });
+            updateAgents(laborers, gdpPerCapita);
         }
 
         // 3. Re-clear markets with updated demand/supply
-        updateAllMarkets();
+        {
+            PROFILE_PHASE(phaseTimes, profile::MarketsAfter, markets.size());
+            updateAllMarkets();
+            if (orderMatching)
+                publishTrades(); // GDP counts what was actually traded
+        }
 
         // 4. Firms optimize input mix
-        for (auto &fi : firms)
-            fi.calculateCosts();
-
-        firmOptimize(); // auto-hire / fire based on market conditions
+        {
+            PROFILE_PHASE(phaseTimes, profile::FirmCosts, firms.size());
+            depreciateCapital();
+            for (auto &fi : firms)
+                fi.calculateCosts();
+        }
+        {
+            PROFILE_PHASE(phaseTimes, profile::FirmOptimize, firms.size());
+            firmOptimize(); // auto-hire / fire based on market conditions
+        }
 
         // 5. Macro stats
-        calculateStats();
+        {
+            PROFILE_PHASE(phaseTimes, profile::Stats, getPopulation());
+            calculateStats();
+        }
 
         // 6. Walrasian tâtonnement price adjustment
-        for (auto &m : markets)
-            m.adjustPrice();
+        {
+            PROFILE_PHASE(phaseTimes, profile::Tatonnement, markets.size());
+            adjustPrices();
+        }
 
         // 7. Stochastic income shocks (simulate wage drift, side income, bad days)
         //    Each agent has a small random ±5% daily income jitter to keep things moving
-        applyIncomeShocks();
-
         // 8. Periodic demand shocks every ~7 days (taste/season changes)
-        if (dayCount % 7 == 0)
-            applyDemandShock();
+        {
+            PROFILE_PHASE(phaseTimes, profile::Shocks, getPopulation());
+            applyIncomeShocks();
+            if (dayCount % 7 == 0)
+                applyDemandShock();
+        }
+
+        // 9. Close the gaps left by agents removed since the last compaction
+        compactAgents();
+    }
+
+    // ── QUIET DAY ─────────────────────────────────────────────────────────
+    // The cheap stand-in for pass_day once prices have converged (see
+    // fastforward.h): markets keep today's prices and cleared quantities,
+    // agents age and bank a day of income against yesterday's spending, and
+    // stats are recomputed. No curves move, nothing is hired or fired and no
+    // shocks are drawn.
+    void pass_quiet_day()
+    {
+        dayCount++;
+        auto bank = [&](auto &agents)
+        {
+            savingsTally &tally = openTally(agents);
+            pool.parallelFor(agents.slots(), AGENT_GRAIN, [&](size_t begin, size_t end)
+                             {
+                for (size_t i = begin; i < end; i++)
+                {
+                    if (!agents.alive(i))
+                        continue;
+                    auto &a = agents[i];
+                    a.ageInDays++;
+                    a.savings += a.incomePerDay - a.expenses;
+                    tally.blocks[i / AGENT_GRAIN] += a.savings;
+                } });
+            tally.valid = true;
+        };
+        bank(consumers);
+        bank(farmers);
+        bank(laborers);
+
+        calculateStats();
+        for (auto &m : markets)
+            m.priceHistory.push_back(m.price);
+    }
+
+    // before(agent) runs first for each agent, on the same thread
+    template <class Agent, class Before = void (*)(Agent &)>
+    void updateAgents(agentArena<Agent> &agents, double gdpPerCapita,
+                      Before before = [](Agent &) {})
+    {
+        // Rows are written concurrently below, so no column may still be
+        // shared with a forked branch (a first write would swap its buffer)
+        if (threads() > 1)
+        {
+            demand.detach();
+            supply.detach();
+        }
+        savingsTally &tally = openTally(agents);
+        pool.parallelFor(agents.slots(), AGENT_GRAIN, [&](size_t begin, size_t end)
+                         {
+            for (size_t i = begin; i < end; i++)
+            {
+                if (!agents.alive(i))
+                    continue;
+                Agent &a = agents[i];
+                before(a);
+                for (needRef &need : a.needs)
+                    if (prices[need.id] > 0.0)
+                        a.updateDemandForPriceChange(need, prices[need.id]);
+                a.pass_day(gdpPerCapita, prices);
+                tally.blocks[i / AGENT_GRAIN] += a.savings;
+            } });
+        tally.valid = true;
+    }
+
+    // ── SAVINGS TALLY ─────────────────────────────────────────────────────
+    // Savings per AGENT_GRAIN block of one arena, summed by the agent pass
+    // that just updated them while each agent is still in cache, so the
+    // money supply in calculateStats does not walk every agent again. Chunks
+    // start on block boundaries, so each block has one writer and sums its
+    // slots in order: the fold is bit-identical to the reduce below. A tally
+    // is only valid from that pass to the next calculateStats.
+    struct savingsTally
+    {
+        std::vector<double> blocks;
+        bool valid = false;
+    };
+    savingsTally consumerSavings, farmerSavings, laborerSavings;
+
+    savingsTally &tallyOf(const agentArena<consumer> &) { return consumerSavings; }
+    savingsTally &tallyOf(const agentArena<farmer> &) { return farmerSavings; }
+    savingsTally &tallyOf(const agentArena<laborer> &) { return laborerSavings; }
+
+    template <class Agent>
+    savingsTally &openTally(const agentArena<Agent> &agents)
+    {
+        savingsTally &t = tallyOf(agents);
+        t.blocks.assign((agents.slots() + AGENT_GRAIN - 1) / AGENT_GRAIN, 0.0);
+        t.valid = false;
+        return t;
+    }
+
+    // Sum of savings over one agent vector, in fixed blocks so the total does
+    // not depend on the thread count
+    template <class Agent>
+    double totalSavings(const agentArena<Agent> &agents)
+    {
+        const savingsTally &t = tallyOf(agents);
+        if (t.valid && t.blocks.size() == (agents.slots() + AGENT_GRAIN - 1) / AGENT_GRAIN)
+        {
+            double s = 0.0;
+            for (double b : t.blocks)
+                s += b;
+            return s;
+        }
+        return pool.reduce(agents.slots(), AGENT_GRAIN, 0.0, [&](size_t begin, size_t end)
+                           {
+            double s = 0.0;
+            for (size_t i = begin; i < end; i++)
+                if (agents.alive(i))
+                    s += agents[i].savings;
+            return s; });
     }
 
     // ── INCOME SHOCKS ─────────────────────────────────────────────────────
     void applyIncomeShocks()
     {
-        auto jitter = [](double base, double pct = 0.08) -> double
+        auto jitter = [](double base, rng::generator &gen, double pct = 0.08) -> double
         {
-            double delta = ((double)rand() / RAND_MAX - 0.5) * pct;
+            double delta = (gen.uniform() - 0.5) * pct;
             return std::max(50.0, base * (1.0 + delta));
         };
-        for (auto &c : consumers)
-            c.incomePerDay = jitter(c.incomePerDay);
-        for (auto &l : laborers)
-            l.incomePerDay = jitter(l.incomePerDay);
-        for (auto &f : farmers)
-            f.incomePerDay = jitter(f.incomePerDay);
+        auto shockAll = [&](auto &agents, rng::stream s)
+        {
+            pool.parallelFor(agents.slots(), AGENT_GRAIN, [&](size_t begin, size_t end)
+                             {
+                for (size_t i = begin; i < end; i++)
+                {
+                    if (!agents.alive(i))
+                        continue;
+                    rng::generator gen = random(s, agents[i].id);
+                    agents[i].incomePerDay = jitter(agents[i].incomePerDay, gen);
+                } });
+        };
+        shockAll(consumers, rng::stream::ConsumerIncome);
+        shockAll(laborers, rng::stream::LaborerIncome);
+        shockAll(farmers, rng::stream::FarmerIncome);
 
         // ── Firm wage dynamics ────────────────────────────────────────────
         double labourForce = (double)laborers.size();
@@ -561,73 +1278,71 @@ public:
         double wageTrend = empRate > 0.80 ? 1.012 : empRate > 0.55 ? 1.003
                                                                    : 0.994;
 
-        for (auto &fi : firms)
+        for (size_t i = 0; i < firms.size(); i++)
         {
-            fi.wage = std::max(250.0, jitter(fi.wage * wageTrend, 0.06));
+            firm &fi = firms[i];
+            rng::generator gen = random(rng::stream::FirmWage, i);
+            fi.wage = std::max(250.0, jitter(fi.wage * wageTrend, gen, 0.06));
             fi.calculateCosts();
         }
     }
 
     // ── FIRM AUTO-HIRE / FIRE ─────────────────────────────────────────────
     static constexpr double FIRM_OUTPUT_SCALE = 80.0;
+    static constexpr double CAPITAL_WEAR = 0.0; // efficiency units lost per vintage per year
 
-    void firmOptimize()
+    // Last day of each simulated year: every firm's vintages wear down by
+    // CAPITAL_WEAR. Off by default; production and costs use the machine
+    // count, so only capitalStock::units() follows the wear.
+    void depreciateCapital()
     {
+        if (CAPITAL_WEAR <= 0.0 || dayCount % capitalStock::VINTAGE_DAYS != 0)
+            return;
         for (auto &fi : firms)
+            fi.capitals.depreciate(CAPITAL_WEAR);
+    }
+
+    void firmOptimize()
+    {
+        for (size_t fiIdx = 0; fiIdx < firms.size(); fiIdx++)
         {
+            firm &fi = firms[fiIdx];
+            rng::generator gen = random(rng::stream::FirmCapital, fiIdx);
+
             // Find this firm's primary market price
             double mktPrice = 0.0;
-            for (auto &fp : fi.products)
-                for (auto &m : markets)
-                    if (m.prod->name == fp.name && m.price > mktPrice)
-                        mktPrice = m.price;
+            for (int pid : fi.productIds)
+            {
+                market *m = marketFor(pid);
+                if (m && m->price > mktPrice)
+                    mktPrice = m->price;
+            }
             if (mktPrice < 1.0)
                 continue;
 
             double mpL = fi.MPofLabor();
             double revPerWorker = mpL * FIRM_OUTPUT_SCALE * mktPrice;
-            bool shouldHire = (revPerWorker > fi.wage * 1.05) && ((int)fi.workers.size() < 8);
+            bool shouldHire = (revPerWorker > fi.wage * 1.05) && (fi.workers.size() < firm::MAX_AUTO_WORKERS);
             bool shouldFire = (revPerWorker < fi.wage * 0.80) && ((int)fi.workers.size() > 1);
 
             if (shouldHire)
             {
                 // Hire the highest-skilled unemployed laborer within wage budget
-                laborer *best = nullptr;
-                for (auto &l : laborers)
-                {
-                    if (l.minWage > fi.wage)
-                        continue;
-                    bool alreadyHired = false;
-                    for (auto &fi2 : firms)
-                        for (auto &w : fi2.workers)
-                            if (w.name == l.name)
-                            {
-                                alreadyHired = true;
-                                break;
-                            }
-                    if (alreadyHired)
-                        continue;
-                    if (!best || l.skillLevel > best->skillLevel)
-                        best = &l;
-                }
-                if (best)
-                {
-                    fi.workers.push_back(*best);
-                    fi.calculateCosts();
-                }
+                int best = employment.bestCandidate(fi.wage);
+                if (best >= 0)
+                    hire(fi, best);
             }
             else if (shouldFire)
             {
-                fi.workers.pop_back();
-                fi.calculateCosts();
+                fire(fi, fi.workers.back());
             }
 
             // Occasionally add capital if MPK/r is favourable
-            if ((rand() % 20 == 0) && fi.MPofCapital() * FIRM_OUTPUT_SCALE * mktPrice > fi.averageCost * 0.5)
+            if ((gen.below(20) == 0) && fi.MPofCapital() * FIRM_OUTPUT_SCALE * mktPrice > fi.averageCost * 0.5)
             {
-                double rental = fi.wage * 1.8 + ((double)rand() / RAND_MAX) * 200.0;
-                double eff = 1.0 + ((double)rand() / RAND_MAX) * 1.0;
-                fi.capitals.emplace_back(rental, eff);
+                double rental = fi.wage * 1.8 + gen.uniform() * 200.0;
+                double eff = 1.0 + gen.uniform() * 1.0;
+                fi.addCapital(rental, eff, dayCount);
                 fi.calculateCosts();
             }
         }
@@ -641,25 +1356,20 @@ public:
         // Pick a random market
         if (markets.empty())
             return;
-        int idx = rand() % (int)markets.size();
+        rng::generator gen = random(rng::stream::DemandShock, 0);
+        int idx = gen.below((int)markets.size());
         market &m = markets[idx];
 
         // Shift the aggregate demand intercept by ±5%
-        double shock = 1.0 + ((double)rand() / RAND_MAX - 0.5) * 0.10;
+        double shock = 1.0 + (gen.uniform() - 0.5) * 0.10;
 
         // Propagate to all entities who demand this product
-        auto shiftAgent = [&](consumer &ag)
-        {
-            product *key = ag.findKey(m.prod->name);
-            if (key)
-                ag.dd[key].c = std::max(1.0, ag.dd[key].c * shock);
-        };
-        for (auto &c : consumers)
-            shiftAgent(c);
-        for (auto &f : farmers)
-            shiftAgent(static_cast<consumer &>(f));
-        for (auto &l : laborers)
-            shiftAgent(static_cast<consumer &>(l));
+        // Every cell in the product's store column is one entity's demand line
+        int col = demand.column(m.prod);
+        if (col < 0)
+            return;
+        demand.updateLines(col, [shock](demandLine l)
+                           { return demandLine{l.m, std::max(1.0, l.c * shock)}; });
     }
 
     // ── MACRO STATS ───────────────────────────────────────────────────────
@@ -670,10 +1380,7 @@ public:
 
         double totalProduction = 0.0;
         for (auto &m : markets)
-        {
-            auto eq = m.findEquilibrium();
-            totalProduction += eq.price * eq.quantity;
-        }
+            totalProduction += m.cleared.price * m.cleared.quantity; // from updateAllMarkets
         currentStats.gdp = totalProduction;
 
         currentStats.employed = 0;
@@ -686,14 +1393,14 @@ public:
                                         : 0.0;
 
         currentStats.moneySupply = 0.0;
-        for (const auto &c : consumers)
-            currentStats.moneySupply += c.savings;
-        for (const auto &f : farmers)
-            currentStats.moneySupply += f.savings;
-        for (const auto &l : laborers)
-            currentStats.moneySupply += l.savings;
+        currentStats.moneySupply += totalSavings(consumers);
+        currentStats.moneySupply += totalSavings(farmers);
+        currentStats.moneySupply += totalSavings(laborers);
         for (const auto &fi : firms)
             currentStats.moneySupply += fi.cash;
+
+        consumerSavings.valid = farmerSavings.valid = laborerSavings.valid = false;
+        statsStale = false;
     }
 
     std::string getStyledGDP()
@@ -703,7 +1410,7 @@ public:
         double total = 0.0;
         for (auto &m : markets)
         {
-            auto eq = m.findEquilibrium();
+            const market::equilibrium &eq = m.cleared;
             double mv = eq.price * eq.quantity;
             if (mv > 0.01)
             {
@@ -727,26 +1434,24 @@ public:
 
     void updateDemandCurves()
     {
-        std::vector<consumer *> all;
-        for (auto &c : consumers)
-            all.push_back(&c);
-        for (auto &f : farmers)
-            all.push_back(&f);
-        for (auto &l : laborers)
-            all.push_back(&l);
-
-        for (auto *ag : all)
+        auto update = [&](auto &agents)
         {
-            ag->muPerTk = ag->getMUperTk();
-            for (auto &need : ag->needs)
+            for (consumer &ag : agents)
             {
-                product *key = ag->findKey(need.name);
-                if (key)
+                ag.currentMUperTk();
+                for (const needRef &n : ag.needs)
                 {
-                    double incomeEffect = ag->incomePerDay * 0.01 * need.eta;
-                    ag->dd[key].c = std::max(1.0, ag->dd[key].c + incomeEffect * 0.1);
+                    const product *need = catalogue().get(n.id);
+                    if (ag.demands(need))
+                    {
+                        double incomeEffect = ag.incomePerDay * 0.01 * need->eta;
+                        demand.setIntercept(n.id, ag.row, std::max(1.0, ag.demandOf(need).c + incomeEffect * 0.1));
+                    }
                 }
             }
-        }
+        };
+        update(consumers);
+        update(farmers);
+        update(laborers);
     }
 };
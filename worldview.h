@@ -0,0 +1,152 @@
+#pragma once
+#include <atomic>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "world.h"
+
+// A read-only copy of what the CLI shows: day stats, every market's price and
+// the selected entities' header fields. It holds no pointers into the world,
+// so it can be read on one thread while another thread runs pass_day.
+// capture() reuses the view's storage, so refilling a warmed-up view does
+// not allocate (names longer than the small-string buffer aside).
+struct worldView
+{
+    struct marketRow
+    {
+        std::string name;
+        double price = 0.0;
+        double prevPrice = 0.0; // the day before, if hasPrev
+        bool hasPrev = false;
+        double quantity = 0.0;
+    };
+
+    uint64_t epoch = 0; // publication count, 0 for a view never published
+    int day = 0;
+    world::stats stats;
+    std::vector<marketRow> markets;
+
+    // Selected entities (present == false: none selected)
+    struct
+    {
+        bool present = false;
+        std::string name;
+        double skillLevel = 0.0, minWage = 0.0;
+    } laborer;
+    struct
+    {
+        bool present = false;
+        std::string name, crops; // crop names, comma separated
+        double land = 0.0;
+    } farmer;
+    struct
+    {
+        bool present = false;
+        std::string name;
+        int ageInDays = 0;
+        double savings = 0.0;
+    } consumer;
+    struct
+    {
+        bool present = false;
+        std::string name;
+        double price = 0.0;
+    } market;
+
+    // Copy from a world that no other thread is stepping
+    void capture(world &w)
+    {
+        day = w.dayCount;
+        stats = w.getStats();
+
+        markets.resize(w.markets.size());
+        for (size_t i = 0; i < w.markets.size(); i++)
+        {
+            const ::market &m = w.markets[i];
+            marketRow &r = markets[i];
+            r.name = m.prod->name;
+            r.price = m.price;
+            r.quantity = m.quantityTraded;
+            r.hasPrev = m.priceHistory.size() > 1;
+            r.prevPrice = r.hasPrev ? m.priceHistory[m.priceHistory.size() - 2] : m.price;
+        }
+
+        const ::laborer *l = w.GetSelectedLaborer();
+        laborer.present = l != nullptr;
+        if (laborer.present)
+        {
+            laborer.name = l->name;
+            laborer.skillLevel = l->skillLevel;
+            laborer.minWage = l->minWage;
+        }
+
+        const ::farmer *f = w.GetSelectedFarmer();
+        farmer.present = f != nullptr;
+        if (farmer.present)
+        {
+            farmer.name = f->name;
+            farmer.land = f->land;
+            farmer.crops.clear();
+            for (size_t i = 0; i < f->crops.size(); i++)
+            {
+                if (i > 0)
+                    farmer.crops += ", ";
+                farmer.crops += f->crops[i].name;
+            }
+        }
+
+        const ::consumer *c = w.GetSelectedConsumer();
+        consumer.present = c != nullptr;
+        if (consumer.present)
+        {
+            consumer.name = c->name;
+            consumer.ageInDays = c->ageInDays;
+            consumer.savings = c->savings;
+        }
+
+        market.present = w.selected_market != nullptr;
+        if (market.present)
+        {
+            market.name = w.selected_market->prod->name;
+            market.price = w.selected_market->price;
+        }
+    }
+};
+
+// Single-writer, single-reader publication of worldViews without locks.
+//
+// Three views rotate: the writer fills back(), and publish() swaps it with
+// the spare slot in one atomic exchange, flagging the spare as fresh. The
+// reader's latest() swaps its own slot with the spare only when it is fresh.
+// Neither side ever waits, the writer never touches the slot being read,
+// and a reader always sees one whole day, never a mix of two.
+class viewBuffer
+{
+public:
+    // Writer side: fill this, then publish()
+    worldView &back() { return slots[writeSlot]; }
+
+    void publish()
+    {
+        slots[writeSlot].epoch = ++written;
+        writeSlot = spare.exchange(writeSlot | FRESH, std::memory_order_acq_rel) & INDEX;
+    }
+
+    // Reader side: the most recently published view (epoch 0 if none yet).
+    // The reference stays valid and unchanged until the next latest().
+    const worldView &latest()
+    {
+        if (spare.load(std::memory_order_acquire) & FRESH)
+            readSlot = spare.exchange(readSlot, std::memory_order_acq_rel) & INDEX;
+        return slots[readSlot];
+    }
+
+private:
+    static constexpr int INDEX = 3, FRESH = 4;
+
+    worldView slots[3];
+    int writeSlot = 0;         // writer thread only
+    int readSlot = 1;          // reader thread only
+    std::atomic<int> spare{2}; // slot index, | FRESH once published and not yet taken
+    uint64_t written = 0;      // writer thread only
+};